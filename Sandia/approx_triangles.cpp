@@ -0,0 +1,296 @@
+#include "approx_triangles.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "../common/parallel.hpp"
+
+namespace
+{
+    constexpr std::uint64_t FIRST_ROUND = 1 << 12;   // wedges before the first error check, doubled per round
+    constexpr std::uint64_t MAX_ROUND = 1 << 22;     // cap of the doubling
+    constexpr std::uint64_t BUILD_BLOCK = 4096;      // rows per scheduling block while sparsifying
+    constexpr std::uint32_t MIN_TRIALS = 3;          // Doulion pilot trials before the variance is used
+    constexpr double TRIAL_BUDGET = 8.0;             // projected trials per keep probability before raising it
+    constexpr double EXACT_PROBABILITY = 0.25;       // raised keep probabilities above this count exactly instead
+
+    std::uint64_t splitmix64(std::uint64_t &state)
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Seed of Doulion trial r: (seed, r) hashed, so runs with nearby base
+    // seeds share no trials
+    std::uint64_t trial_seed(std::uint64_t seed, std::uint64_t r)
+    {
+        std::uint64_t state = seed;
+        state = splitmix64(state) ^ r;
+        return splitmix64(state);
+    }
+
+    // Two-sided standard normal quantile: P(|Z| <= z) = confidence
+    double normal_quantile(double confidence)
+    {
+        if (!(confidence > 0.0 && confidence < 1.0))
+            throw std::invalid_argument("tc_approx: confidence must be in (0, 1)");
+        double lo = 0.0, hi = 40.0;
+        for (int it = 0; it < 100; it++)
+        {
+            double mid = 0.5 * (lo + hi);
+            (std::erf(mid / std::sqrt(2.0)) < confidence ? lo : hi) = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    // Regularized incomplete beta I_x(a, b), Lentz's continued fraction
+    double incomplete_beta(double a, double b, double x)
+    {
+        if (x <= 0.0)
+            return 0.0;
+        if (x >= 1.0)
+            return 1.0;
+        if (x > (a + 1.0) / (a + b + 2.0))
+            return 1.0 - incomplete_beta(b, a, 1.0 - x);
+        const double front =
+            std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x));
+        constexpr double tiny = 1e-300;
+        double f = 1.0, c = 1.0, d = 0.0;
+        for (int i = 0; i <= 400; i++)
+        {
+            const double m = i / 2;
+            double num = 1.0;
+            if (i > 0 && i % 2 == 0)
+                num = m * (b - m) * x / ((a + 2.0 * m - 1.0) * (a + 2.0 * m));
+            else if (i > 0)
+                num = -(a + m) * (a + b + m) * x / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+            d = 1.0 + num * d;
+            d = 1.0 / (std::abs(d) < tiny ? tiny : d);
+            c = 1.0 + num / c;
+            c = std::abs(c) < tiny ? tiny : c;
+            f *= c * d;
+            if (std::abs(1.0 - c * d) < 1e-12)
+                break;
+        }
+        return front * (f - 1.0) / a;
+    }
+
+    // Two-sided Student-t quantile with df degrees of freedom:
+    // P(|T| <= t) = 1 - I_{df / (df + t^2)}(df / 2, 1 / 2) = confidence
+    double student_quantile(double confidence, double df)
+    {
+        auto covered = [&](double t)
+        { return 1.0 - incomplete_beta(0.5 * df, 0.5, df / (df + t * t)); };
+        double lo = 0.0, hi = 1.0;
+        while (covered(hi) < confidence && hi < 1e12)
+            hi *= 2.0;
+        for (int it = 0; it < 100; it++)
+        {
+            double mid = 0.5 * (lo + hi);
+            (covered(mid) < confidence ? lo : hi) = mid;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    std::uint64_t row_length(const TcGraph &g, std::uint32_t v)
+    {
+        return g.row_ptr[v + 1] - g.row_ptr[v];
+    }
+
+    TcEstimate wedge_estimate(const TcGraph &g, const TcApproxOptions &options, double z, unsigned nthreads)
+    {
+        // Out-wedges per centre, as an inclusive prefix for sampling
+        std::vector<std::uint64_t> wedges(std::uint64_t(g.n) + 1, 0);
+        for (std::uint32_t v = 0; v < g.n; v++)
+        {
+            std::uint64_t d = row_length(g, v);
+            wedges[v + 1] = wedges[v] + d * (d - (d > 0)) / 2;
+        }
+        TcEstimate result;
+        result.population = wedges[g.n];
+        if (result.population == 0)
+            return result;
+
+        struct alignas(64) Partial
+        {
+            std::uint64_t closed = 0;
+        };
+        std::vector<Partial> partial(nthreads);
+        std::uint64_t closed = 0, samples = 0;
+        for (std::uint64_t round = 0; samples < options.max_samples; round++)
+        {
+            const std::uint64_t draw =
+                std::min({std::max(FIRST_ROUND, samples), MAX_ROUND, options.max_samples - samples});
+            parallel_for(nthreads, draw, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+                std::uint64_t state = options.seed ^ (round * 0x100000001b3ULL + t) * 0xd6e8feb86659fd93ULL;
+                std::uint64_t hits = 0;
+                for (std::uint64_t s = b; s < e; s++)
+                {
+                    std::uint64_t x = splitmix64(state) % result.population;
+                    auto v = static_cast<std::uint32_t>(std::upper_bound(wedges.begin(), wedges.end(), x) -
+                                                        wedges.begin() - 1);
+                    const std::uint32_t *out = g.col.data() + g.row_ptr[v];
+                    std::uint64_t d = row_length(g, v);
+                    std::uint64_t i = splitmix64(state) % d, j = splitmix64(state) % (d - 1);
+                    j += j >= i;
+                    std::uint32_t a = std::min(out[i], out[j]), c = std::max(out[i], out[j]);
+                    const std::uint32_t *row = g.col.data() + g.row_ptr[a];
+                    hits += std::binary_search(row, row + row_length(g, a), c);
+                }
+                partial[t].closed += hits; });
+            samples += draw;
+            closed = 0;
+            for (const auto &p : partial)
+                closed += p.closed;
+
+            // Wilson score interval of the closed fraction
+            const double k = static_cast<double>(samples), ph = static_cast<double>(closed) / k;
+            const double denom = 1.0 + z * z / k;
+            const double centre = (ph + z * z / (2.0 * k)) / denom;
+            const double half = z / denom * std::sqrt(ph * (1.0 - ph) / k + z * z / (4.0 * k * k));
+            const double W = static_cast<double>(result.population);
+            result.estimate = W * ph;
+            result.lower = W * std::max(0.0, centre - half);
+            result.upper = W * std::min(1.0, centre + half);
+            result.samples = samples;
+            result.rel_error = closed > 0 ? (result.upper - result.lower) / (2.0 * result.estimate)
+                                          : std::numeric_limits<double>::infinity();
+            if (result.rel_error <= options.rel_error)
+                break;
+        }
+        return result;
+    }
+
+    // Every DAG edge kept with probability p < 1, decided by a hash of the
+    // edge position and the trial seed
+    TcGraph sparsify(const TcGraph &g, double p, std::uint64_t seed, unsigned nthreads)
+    {
+        const auto threshold = static_cast<std::uint64_t>(std::ldexp(p, 64));
+        auto keep = [&](std::uint64_t k)
+        {
+            std::uint64_t state = seed ^ k;
+            return splitmix64(state) < threshold;
+        };
+
+        TcGraph s;
+        s.n = g.n;
+        s.row_ptr.assign(std::uint64_t(g.n) + 1, 0);
+        parallel_for_dynamic(nthreads, g.n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t v = b; v < e; v++)
+            {
+                std::uint64_t kept = 0;
+                for (std::uint64_t k = g.row_ptr[v]; k < g.row_ptr[v + 1]; k++)
+                    kept += keep(k);
+                s.row_ptr[v + 1] = kept;
+            } });
+        for (std::uint32_t v = 0; v < g.n; v++)
+            s.row_ptr[v + 1] += s.row_ptr[v];
+        s.col.resize(s.row_ptr[g.n]);
+        parallel_for_dynamic(nthreads, g.n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t v = b; v < e; v++)
+            {
+                std::uint64_t pos = s.row_ptr[v];
+                for (std::uint64_t k = g.row_ptr[v]; k < g.row_ptr[v + 1]; k++)
+                    if (keep(k))
+                        s.col[pos++] = g.col[k];
+            } });
+        return s;
+    }
+
+    // Trials of the mean run at keep probability p. From MIN_TRIALS on,
+    // the trials the target needs are projected from the sample variance.
+    // When they exceed TRIAL_BUDGET, p is raised so that the projection
+    // fits. The variance of one trial is T (1 / p^3 - 1) + S (1 / p - 1)
+    // for T triangles and S pairs sharing an edge. The raise assumes the
+    // second term, which shrinks slowest. Every trial sparsifies the whole
+    // graph in O(m), so this is much cheaper than many trials at a small
+    // p. Past EXACT_PROBABILITY, TRIAL_BUDGET trials cost more than one
+    // exact count, which is taken instead.
+    TcEstimate doulion_estimate(const TcGraph &g, const TcApproxOptions &options, double z, unsigned nthreads)
+    {
+        double p = options.keep_probability;
+        if (!(p > 0.0))
+            throw std::invalid_argument("tc_approx: keep_probability must be positive");
+        TcOptions count;
+        count.nthreads = nthreads;
+
+        TcEstimate result;
+        result.population = g.col.size();
+        const std::uint32_t max_trials = std::max(options.max_trials, MIN_TRIALS);
+        std::uint32_t trials = 0;
+        while (true)
+        {
+            if (p >= 1.0 || (p > EXACT_PROBABILITY && p > options.keep_probability))
+            {
+                result.estimate = result.lower = result.upper = static_cast<double>(tc_count(g, count));
+                result.rel_error = 0.0;
+                result.samples = trials + 1;
+                result.keep_probability = 1.0;
+                return result;
+            }
+
+            const double scale = 1.0 / (p * p * p);
+            double sum = 0.0, sum_sq = 0.0, raised = p;
+            for (std::uint32_t r = 0; trials < max_trials; r++)
+            {
+                TcGraph s = sparsify(g, p, trial_seed(options.seed, trials++), nthreads);
+                double x = scale * static_cast<double>(tc_count(s, count));
+                sum += x;
+                sum_sq += x * x;
+
+                const double k = r + 1.0, mean = sum / k;
+                // Never below the triangle term of the variance, so that equal
+                // counts of a few sampled triangles do not make a point interval
+                const double var = k > 1.0 ? std::max(mean * (scale - 1.0), (sum_sq - k * mean * mean) / (k - 1.0))
+                                           : 0.0;
+                const double half = k > 1.0 ? student_quantile(options.confidence, k - 1.0) * std::sqrt(var / k) : 0.0;
+                result.estimate = mean;
+                result.lower = std::max(0.0, mean - half);
+                result.upper = mean + half;
+                result.samples = trials;
+                result.keep_probability = p;
+                result.rel_error = mean > 0.0 ? half / mean : std::numeric_limits<double>::infinity();
+                if (k < MIN_TRIALS)
+                    continue;
+                if (result.rel_error <= options.rel_error)
+                    return result;
+
+                // Trials needed at p for the target, normal approximation; never
+                // fewer than already run without meeting it
+                const double needed =
+                    mean > 0.0 ? std::max(k, z * z * var / (options.rel_error * options.rel_error * mean * mean))
+                               : std::numeric_limits<double>::infinity();
+                if (needed > TRIAL_BUDGET)
+                {
+                    const double spread = (1.0 / p - 1.0) * TRIAL_BUDGET / needed;
+                    raised = std::max(1.5 * p, 1.0 / (spread + 1.0));
+                    break;
+                }
+            }
+            if (raised == p)
+                return result;
+            p = raised;
+        }
+    }
+}
+
+TcEstimate tc_approx(const TcGraph &graph, const TcApproxOptions &options)
+{
+    const double z = normal_quantile(options.confidence);
+    const unsigned nthreads = resolve_threads(options.nthreads);
+    return options.method == TcApproxMethod::Wedge ? wedge_estimate(graph, options, z, nthreads)
+                                                   : doulion_estimate(graph, options, z, nthreads);
+}
+
+const char *tc_approx_name(TcApproxMethod method)
+{
+    return method == TcApproxMethod::Wedge ? "wedge" : "doulion";
+}
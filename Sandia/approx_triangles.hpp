@@ -0,0 +1,64 @@
+#ifndef APPROX_TRIANGLES_HPP
+#define APPROX_TRIANGLES_HPP
+
+#include <cstdint>
+
+#include "triangles.hpp"
+
+//--------------------------------------------------------------------
+// Approximate triangle counts with a confidence interval.
+//
+// Both estimators work on the degree-ordered DAG of tc_count, where
+// every triangle is exactly one closed "out-wedge": a vertex with two of
+// its out-neighbours that are themselves adjacent.
+//  - Wedge: out-wedges are drawn uniformly (centre with probability
+//    proportional to C(d+, 2), then two distinct out-neighbours) and
+//    closed by a binary search in the lower neighbour's out-list.
+//    T = W+ * closed / samples; samples are drawn in rounds until the
+//    binomial interval is within the target relative error.
+//  - Doulion: every DAG edge is kept with probability p, the sparsified
+//    graph is counted exactly by tc_count and scaled by 1 / p^3.
+//    Independent trials (seeds hashed from the base seed and the trial
+//    index) are repeated until the Student-t interval of their mean is
+//    within the target. When a few pilot trials project more than a
+//    handful of trials, p is raised instead, up to an exact count.
+// Out-wedges are far fewer and more often closed than the wedges of the
+// undirected graph, so the same error needs fewer samples.
+//--------------------------------------------------------------------
+
+enum class TcApproxMethod
+{
+    Wedge,
+    Doulion
+};
+
+struct TcApproxOptions
+{
+    TcApproxMethod method = TcApproxMethod::Wedge;
+    double rel_error = 0.05;                     // target half-width of the interval / estimate
+    double confidence = 0.95;                    // two-sided; Wilson (wedge) or Student-t (Doulion)
+    double keep_probability = 0.1;               // Doulion edge sampling rate to start from
+    std::uint32_t max_trials = 64;               // Doulion
+    std::uint64_t max_samples = std::uint64_t(1) << 30; // Wedge
+    std::uint64_t seed = 1;
+    unsigned nthreads = 0;
+};
+
+struct TcEstimate
+{
+    double estimate = 0.0;
+    double lower = 0.0; // confidence interval
+    double upper = 0.0;
+    double rel_error = 0.0;      // achieved half-width / estimate
+    std::uint64_t samples = 0;   // wedges drawn, or Doulion trials
+    std::uint64_t population = 0; // out-wedges of the DAG, or its edges
+    double keep_probability = 0.0; // Doulion rate of the last trials, 1 after an exact count
+};
+
+// Stops at max_samples / max_trials even when the target is not met; the
+// interval then reports the error actually reached
+TcEstimate tc_approx(const TcGraph &graph, const TcApproxOptions &options = {});
+
+const char *tc_approx_name(TcApproxMethod method);
+
+#endif // APPROX_TRIANGLES_HPP
@@ -0,0 +1,323 @@
+#include "dynamic_triangles.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "../common/parallel.hpp"
+#include "../common/undirected_csr.hpp"
+
+namespace
+{
+    constexpr std::uint64_t BUILD_BLOCK = 4096; // vertices per scheduling block
+    constexpr std::uint64_t EDGE_BLOCK = 64;    // batch edges per scheduling block
+
+    // Calls f(w) for every w in both strictly ascending lists
+    template <typename F>
+    void for_each_common(const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb, F &&f)
+    {
+        std::size_t i = 0, j = 0;
+        while (i < na && j < nb)
+        {
+            if (a[i] < b[j])
+                i++;
+            else if (b[j] < a[i])
+                j++;
+            else
+            {
+                f(a[i]);
+                i++;
+                j++;
+            }
+        }
+    }
+}
+
+// Edges of one side of a batch, u < v, with their adjacency restricted
+// to the batch: rows only for the vertices they touch
+struct DynamicTriangles::Delta
+{
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::vector<std::uint32_t> vertex; // ascending
+    std::vector<std::uint64_t> ptr;
+    std::vector<std::uint32_t> col;
+
+    void index()
+    {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> both;
+        both.reserve(2 * edges.size());
+        for (auto [u, v] : edges)
+        {
+            both.emplace_back(u, v);
+            both.emplace_back(v, u);
+        }
+        std::sort(both.begin(), both.end());
+        vertex.clear();
+        ptr.assign(1, 0);
+        col.clear();
+        col.reserve(both.size());
+        for (std::size_t k = 0; k < both.size(); k++)
+        {
+            if (k == 0 || both[k].first != both[k - 1].first)
+            {
+                if (k > 0)
+                    ptr.push_back(col.size());
+                vertex.push_back(both[k].first);
+            }
+            col.push_back(both[k].second);
+        }
+        if (!both.empty())
+            ptr.push_back(col.size());
+    }
+
+    // Row of x, empty when x is not touched
+    std::pair<const std::uint32_t *, std::size_t> row(std::uint32_t x) const
+    {
+        auto it = std::lower_bound(vertex.begin(), vertex.end(), x);
+        if (it == vertex.end() || *it != x)
+            return {nullptr, 0};
+        std::size_t r = static_cast<std::size_t>(it - vertex.begin());
+        return {col.data() + ptr[r], ptr[r + 1] - ptr[r]};
+    }
+};
+
+DynamicTriangles::DynamicTriangles(const GraphCache &cache, bool per_vertex, unsigned nthreads)
+    : m_per_vertex(per_vertex), m_threads(resolve_threads(nthreads)), m_kernel(tc_kernel_resolve(TcKernel::Auto))
+{
+    {
+        const UndirectedCsr<std::uint32_t> g = undirected_csr<std::uint32_t>(cache, m_threads, "DynamicTriangles");
+        m_adj.resize(g.n);
+        parallel_for_dynamic(m_threads, g.n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t v = b; v < e; v++)
+                m_adj[v].assign(g.adj.begin() + static_cast<std::ptrdiff_t>(g.ptr[v]),
+                                g.adj.begin() + static_cast<std::ptrdiff_t>(g.ptr[v + 1])); });
+    }
+    const std::uint64_t n = m_adj.size();
+    std::vector<std::uint64_t> twice(m_threads, 0);
+    parallel_for_dynamic(m_threads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+        for (std::uint64_t v = b; v < e; v++)
+        {
+            auto &row = m_adj[v];
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end()), row.end());
+            row.shrink_to_fit();
+            twice[t] += row.size();
+        } });
+    for (std::uint64_t c : twice)
+        m_edges += c;
+    m_edges /= 2;
+
+    m_triangles = recount(m_per_vertex ? &m_vertex : nullptr);
+}
+
+bool DynamicTriangles::has_edge(std::uint32_t u, std::uint32_t v) const
+{
+    const auto &row = m_adj[u];
+    return std::binary_search(row.begin(), row.end(), v);
+}
+
+TcBatchResult DynamicTriangles::apply(const std::vector<TcUpdate> &batch)
+{
+    // Last update per edge, keyed on (min, max)
+    std::vector<std::pair<std::uint64_t, bool>> last;
+    last.reserve(batch.size());
+    for (const TcUpdate &up : batch)
+    {
+        if (up.u >= n() || up.v >= n())
+            throw std::out_of_range("DynamicTriangles::apply: vertex id out of range");
+        if (up.u == up.v)
+            continue;
+        std::uint64_t a = std::min(up.u, up.v), b = std::max(up.u, up.v);
+        last.emplace_back(a << 32 | b, up.insert);
+    }
+    std::stable_sort(last.begin(), last.end(), [](const auto &x, const auto &y)
+                     { return x.first < y.first; });
+
+    Delta erased, inserted;
+    for (std::size_t k = 0; k < last.size(); k++)
+    {
+        if (k + 1 < last.size() && last[k + 1].first == last[k].first)
+            continue;
+        auto u = static_cast<std::uint32_t>(last[k].first >> 32);
+        auto v = static_cast<std::uint32_t>(last[k].first);
+        bool present = has_edge(u, v);
+        if (present && !last[k].second)
+            erased.edges.emplace_back(u, v);
+        else if (!present && last[k].second)
+            inserted.edges.emplace_back(u, v);
+    }
+
+    const std::uint64_t before = m_triangles;
+    TcBatchResult result;
+    result.erased = erased.edges.size();
+    result.inserted = inserted.edges.size();
+
+    // Deletions: drop R, then count against what is left
+    if (!erased.edges.empty())
+    {
+        erased.index();
+        parallel_for_dynamic(m_threads, erased.vertex.size(), EDGE_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t r = b; r < e; r++)
+            {
+                auto &row = m_adj[erased.vertex[r]];
+                auto drop = erased.row(erased.vertex[r]);
+                auto end = std::remove_if(row.begin(), row.end(), [&](std::uint32_t x)
+                                          { return std::binary_search(drop.first, drop.first + drop.second, x); });
+                row.erase(end, row.end());
+            } });
+        m_edges -= erased.edges.size();
+        count_delta(erased, -1);
+    }
+
+    // Insertions: count against the graph without D, then add D
+    if (!inserted.edges.empty())
+    {
+        inserted.index();
+        count_delta(inserted, +1);
+        parallel_for_dynamic(m_threads, inserted.vertex.size(), EDGE_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            std::vector<std::uint32_t> merged;
+            for (std::uint64_t r = b; r < e; r++)
+            {
+                auto &row = m_adj[inserted.vertex[r]];
+                auto add = inserted.row(inserted.vertex[r]);
+                merged.clear();
+                std::merge(row.begin(), row.end(), add.first, add.first + add.second, std::back_inserter(merged));
+                row.assign(merged.begin(), merged.end());
+            } });
+        m_edges += inserted.edges.size();
+    }
+
+    result.delta = static_cast<std::int64_t>(m_triangles) - static_cast<std::int64_t>(before);
+    return result;
+}
+
+void DynamicTriangles::count_delta(const Delta &delta, std::int64_t sign)
+{
+    // In sixths of a triangle: met once (6), twice (3) or three times (2)
+    std::vector<std::uint64_t> sixths(m_threads, 0);
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> touched(m_per_vertex ? m_threads : 0);
+
+    parallel_for_dynamic(m_threads, delta.edges.size(), EDGE_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+        std::uint64_t local = 0;
+        for (std::uint64_t k = b; k < e; k++)
+        {
+            // Plain locals: the visitors below capture them, which C++17 does
+            // not allow for structured bindings
+            const std::uint32_t u = delta.edges[k].first, v = delta.edges[k].second;
+            const auto &au = m_adj[u];
+            const auto &av = m_adj[v];
+            auto ru = delta.row(u);
+            auto rv = delta.row(v);
+            if (!m_per_vertex)
+            {
+                local += 6 * tc_intersect(au.data(), au.size(), av.data(), av.size(), m_kernel) +
+                         3 * tc_intersect(au.data(), au.size(), rv.first, rv.second, m_kernel) +
+                         3 * tc_intersect(ru.first, ru.second, av.data(), av.size(), m_kernel) +
+                         2 * tc_intersect(ru.first, ru.second, rv.first, rv.second, m_kernel);
+                continue;
+            }
+            auto &out = touched[t];
+            auto visit = [&](std::uint32_t units)
+            {
+                return [&, units](std::uint32_t w)
+                {
+                    local += units;
+                    out.emplace_back(u, units);
+                    out.emplace_back(v, units);
+                    out.emplace_back(w, units);
+                };
+            };
+            for_each_common(au.data(), au.size(), av.data(), av.size(), visit(6));
+            for_each_common(au.data(), au.size(), rv.first, rv.second, visit(3));
+            for_each_common(ru.first, ru.second, av.data(), av.size(), visit(3));
+            for_each_common(ru.first, ru.second, rv.first, rv.second, visit(2));
+        }
+        sixths[t] += local; });
+
+    std::uint64_t total = 0;
+    for (std::uint64_t s : sixths)
+        total += s;
+    m_triangles = static_cast<std::uint64_t>(static_cast<std::int64_t>(m_triangles) + sign * static_cast<std::int64_t>(total / 6));
+
+    if (!m_per_vertex)
+        return;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> all;
+    for (auto &part : touched)
+        all.insert(all.end(), part.begin(), part.end());
+    std::sort(all.begin(), all.end());
+    for (std::size_t k = 0; k < all.size();)
+    {
+        std::uint32_t x = all[k].first;
+        std::uint64_t units = 0;
+        for (; k < all.size() && all[k].first == x; k++)
+            units += all[k].second;
+        m_vertex[x] = static_cast<std::uint64_t>(static_cast<std::int64_t>(m_vertex[x]) + sign * static_cast<std::int64_t>(units / 6));
+    }
+}
+
+void DynamicTriangles::vertex_counts(std::vector<std::uint64_t> &out) const
+{
+    // Row u: sum over v in N(u) of |N(u) ∩ N(v)|, every triangle twice
+    out.assign(m_adj.size(), 0);
+    parallel_for_dynamic(m_threads, m_adj.size(), BUILD_BLOCK / 16, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t u = b; u < e; u++)
+        {
+            const auto &au = m_adj[u];
+            std::uint64_t twice = 0;
+            for (std::uint32_t v : au)
+                twice += tc_intersect(au.data(), au.size(), m_adj[v].data(), m_adj[v].size(), m_kernel);
+            out[u] = twice / 2;
+        } });
+}
+
+std::uint64_t DynamicTriangles::recount(std::vector<std::uint64_t> *vertex) const
+{
+    if (vertex)
+    {
+        vertex_counts(*vertex);
+        std::uint64_t sum = 0;
+        for (std::uint64_t c : *vertex)
+            sum += c;
+        return sum / 3;
+    }
+    GraphCache cache;
+    if (snapshot(&cache) != 0)
+        throw std::runtime_error("DynamicTriangles::recount: out of memory");
+    TcGraph graph = tc_graph_from_cache(cache, m_threads);
+    graph_cache_close(&cache);
+    TcOptions options;
+    options.nthreads = m_threads;
+    return tc_count(graph, options);
+}
+
+int DynamicTriangles::snapshot(GraphCache *cache) const
+{
+    const std::uint64_t n = m_adj.size();
+    if (graph_cache_alloc(n, 2 * m_edges, GRAPH_CACHE_SORTED, cache) != 0)
+        return -1;
+    auto *row_ptr = const_cast<std::uint64_t *>(cache->row_ptr);
+    auto *col_idx = const_cast<std::uint64_t *>(cache->col_idx);
+    row_ptr[0] = 0;
+    std::uint64_t max_index = 0;
+    for (std::uint64_t v = 0; v < n; v++)
+    {
+        row_ptr[v + 1] = row_ptr[v] + m_adj[v].size();
+        if (!m_adj[v].empty())
+            max_index = std::max<std::uint64_t>({max_index, v, m_adj[v].back()});
+    }
+    parallel_for_dynamic(m_threads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t v = b; v < e; v++)
+            std::copy(m_adj[v].begin(), m_adj[v].end(), col_idx + row_ptr[v]); });
+    cache->header.max_index = max_index;
+    *static_cast<GraphCacheHeader *>(cache->base) = cache->header;
+    return 0;
+}
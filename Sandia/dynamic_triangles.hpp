@@ -0,0 +1,84 @@
+#ifndef DYNAMIC_TRIANGLES_HPP
+#define DYNAMIC_TRIANGLES_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/graph_cache.h"
+#include "triangles.hpp"
+
+//--------------------------------------------------------------------
+// Triangle count maintained under batches of edge insertions and
+// deletions.
+//
+// A batch is reduced to the edges whose presence actually changes: R
+// (present, deleted) and D (absent, inserted). Deletions go first:
+// with A the graph without R, the triangles lost are
+//
+//   sum over (u,v) in R of |A(u) ∩ A(v)| + |A(u) ∩ R(v)| / 2
+//                        + |R(u) ∩ A(v)| / 2 + |R(u) ∩ R(v)| / 3
+//
+// (a triangle with k edges in R is met once from each of them); the
+// insertions are counted the same way against the graph before D is
+// added. This is the masked product of the delta with the adjacency,
+// so a batch costs the intersections of its own edges only. Batch
+// edges are processed in parallel; with per-vertex counts every thread
+// collects its (vertex, delta) pairs, which are merged afterwards.
+//--------------------------------------------------------------------
+
+struct TcUpdate
+{
+    std::uint32_t u;
+    std::uint32_t v;
+    bool insert; // false: delete
+};
+
+struct TcBatchResult
+{
+    std::uint64_t inserted = 0; // edges that were absent and are now present
+    std::uint64_t erased = 0;   // edges that were present and are now absent
+    std::int64_t delta = 0;     // change of the triangle count
+};
+
+class DynamicTriangles
+{
+public:
+    // Undirected graph of the cache: pattern of A + A', no self loops
+    DynamicTriangles(const GraphCache &cache, bool per_vertex, unsigned nthreads = 0);
+
+    // Updates apply in order, so only the last one per edge counts; self
+    // loops are ignored. Throws std::out_of_range for ids >= n().
+    TcBatchResult apply(const std::vector<TcUpdate> &batch);
+
+    std::uint64_t triangles() const { return m_triangles; }
+    // Triangles through every vertex; empty unless per_vertex
+    const std::vector<std::uint64_t> &vertex_triangles() const { return m_vertex; }
+
+    std::uint32_t n() const { return static_cast<std::uint32_t>(m_adj.size()); }
+    std::uint64_t edges() const { return m_edges; }
+    bool has_edge(std::uint32_t u, std::uint32_t v) const;
+    const std::vector<std::uint32_t> &neighbors(std::uint32_t v) const { return m_adj[v]; }
+
+    // Current graph as an in-memory cache image, both directions stored
+    int snapshot(GraphCache *cache) const;
+
+    // Counts from scratch, for validation: the global count, and the
+    // per-vertex ones into *vertex when it is not null
+    std::uint64_t recount(std::vector<std::uint64_t> *vertex = nullptr) const;
+
+private:
+    struct Delta;
+
+    void count_delta(const Delta &delta, std::int64_t sign);
+    void vertex_counts(std::vector<std::uint64_t> &out) const;
+
+    std::vector<std::vector<std::uint32_t>> m_adj; // ascending
+    std::uint64_t m_edges = 0;
+    std::uint64_t m_triangles = 0;
+    std::vector<std::uint64_t> m_vertex;
+    bool m_per_vertex;
+    unsigned m_threads;
+    TcKernel m_kernel;
+};
+
+#endif // DYNAMIC_TRIANGLES_HPP
@@ -1,69 +1,93 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <GraphBLAS.h>
 #include <LAGraph.h>
 #include <sys/resource.h>
 #include <stdio.h>
 #include <time.h>
+
+#include "sandia_SuiteSparse.h"
+#include "sandia_tune.h"
+#include "../common/graph_trace.h"
+#include "../common/mem_accounting.h"
+
 //--------------------------------------------------------------------
-// Функция чтения MatrixMarket файла и создания GrB_Matrix
+// Построение GrB_Matrix (UINT32, симметризованной) из загруженного кэша
 //--------------------------------------------------------------------
-GrB_Matrix read_matrix_market(const char *filename)
+GrB_Matrix build_sandia_matrix(const GraphCache *cache)
 {
-    FILE *f = fopen(filename, "r");
-    if (!f)
+    GrB_Index nvals = cache->header.nnz;
+    GrB_Index max_el = nvals;
+    if (cache->header.max_index + 1 > max_el)
+        max_el = cache->header.max_index + 1;
+
+    GrB_Matrix A;
+    GrB_Matrix_new(&A, GrB_UINT32, max_el, max_el);
+
+    // Файл читается один раз (graph_cache_load). Строим A из кэша одним
+    // GxB_Matrix_build_Scalar: столбцы берутся прямо из mmap, копируются
+    // только номера строк (8 байт на ребро). Матрица iso (все значения 1),
+    // поэтому повторы сливаются без dup.
+    GrB_Index *I = malloc((nvals > 0 ? nvals : 1) * sizeof(GrB_Index));
+    if (I == NULL)
     {
-        perror("open file");
+        fprintf(stderr, "build_sandia_matrix: out of memory\n");
         exit(1);
     }
+    for (GrB_Index i = 0; i < cache->header.n; i++)
+        for (GrB_Index k = cache->row_ptr[i]; k < cache->row_ptr[i + 1]; k++)
+            I[k] = i;
 
-    char line[5096];
-    do
-    {
-        if (!fgets(line, sizeof(line), f))
-            exit(1);
-    } while (line[0] == '%');
-
-    GrB_Index nrows, ncols, nvals;
-    GrB_Index max_el;
-    sscanf(line, "%llu %llu %llu", &nrows, &ncols, &nvals);
-    max_el = nvals;
-    for (GrB_Index k = 0; k < nvals; k++)
+    GrB_Scalar one;
+    GrB_Scalar_new(&one, GrB_UINT32);
+    GrB_Scalar_setElement_UINT32(one, 1);
+    GrB_Info info;
+    TRACE_CALL("GxB_Matrix_build_Scalar", info = GxB_Matrix_build_Scalar(A, I, cache->col_idx, one, nvals));
+    if (info != GrB_SUCCESS)
     {
-        unsigned long long i, j;
-        fscanf(f, "%zu %zu", &i, &j);
-        if (i - 1 > max_el)
-            max_el = i - 1;
-        if (j - 1 > max_el)
-            max_el = j - 1;
+        fprintf(stderr, "build_sandia_matrix: GxB_Matrix_build_Scalar failed\n");
+        exit(1);
     }
+    GrB_Scalar_free(&one);
+    free(I);
 
-    rewind(f);
-    do
+    // Симметризация целиком: A = A + A'
+    TRACE_CALL("GrB_eWiseAdd (A + A')", info = GrB_Matrix_eWiseAdd_BinaryOp(A, NULL, NULL, GrB_MAX_UINT32, A, A, GrB_DESC_T1));
+    if (info != GrB_SUCCESS)
     {
-        if (!fgets(line, sizeof(line), f))
-            exit(1);
-    } while (line[0] == '%');
-    sscanf(line, "%llu %llu %llu", &nrows, &ncols, &nvals);
-
-    GrB_Matrix A;
-    GrB_Matrix_new(&A, GrB_UINT32, max_el, max_el);
+        fprintf(stderr, "build_sandia_matrix: symmetrization failed\n");
+        exit(1);
+    }
+    TRACE_CALL("GrB_Matrix_wait", GrB_Matrix_wait(A, GrB_MATERIALIZE));
+    return A;
+}
 
-    unsigned long long cnt = 0;
-    for (GrB_Index k = 0; k < nvals; k++)
+//--------------------------------------------------------------------
+// Функция чтения MatrixMarket файла и создания GrB_Matrix
+//--------------------------------------------------------------------
+GrB_Matrix read_matrix_market(const char *filename)
+{
+    double t0 = LAGraph_WallClockTime();
+    GraphCache cache;
+    if (graph_cache_load(filename, &cache) != 0)
     {
-        unsigned long long i, j;
-        fscanf(f, "%llu %llu", &i, &j);
-        i--; 
-        j--;
-
-        GrB_Matrix_setElement_BOOL(A, true, i, j);
-        GrB_Matrix_setElement_BOOL(A, true, j, i);
-        cnt += 2;
+        perror("open file");
+        exit(1);
     }
+    double t1 = LAGraph_WallClockTime();
+
+    GrB_Matrix A = build_sandia_matrix(&cache);
+    GrB_Index nvals = cache.header.nnz;
+    GrB_Index max_el = nvals;
+    if (cache.header.max_index + 1 > max_el)
+        max_el = cache.header.max_index + 1;
+    GrB_Index cnt = 2 * nvals;
 
-    fclose(f);
+    graph_cache_close(&cache);
+    double t2 = LAGraph_WallClockTime();
+    printf("Загрузка: %.6f s, построение матрицы: %.6f s\n", t1 - t0, t2 - t1);
     printf("  Ребер:  %llu\n", cnt);
     printf("  Ребер:  %llu\n", nvals);
     printf("  Ребер:  %llu\n", max_el);
@@ -83,22 +107,186 @@ GrB_Matrix read_matrix_market(const char *filename)
     return A;
 }
 
+//--------------------------------------------------------------------
+// Граф для подсчёта треугольников: забирает *A, удаляет петли и
+// заранее считает свойства, нужные LAGr_TriangleCount
+//--------------------------------------------------------------------
+int sandia_prepare_graph(LAGraph_Graph *G, GrB_Matrix *A, char *msg)
+{
+    int status;
+    TRACE_CALL("LAGraph_New", status = LAGraph_New(G, A, LAGraph_ADJACENCY_UNDIRECTED, msg));
+    if (status != GrB_SUCCESS)
+        return status;
+
+    TRACE_CALL("LAGraph_DeleteSelfEdges", LAGraph_DeleteSelfEdges(*G, msg));
+
+    TRACE_CALL("LAGraph_Cached_NSelfEdges", LAGraph_Cached_NSelfEdges(*G, msg));
+    TRACE_CALL("LAGraph_Cached_IsSymmetricStructure", LAGraph_Cached_IsSymmetricStructure(*G, msg));
+    TRACE_CALL("LAGraph_Cached_OutDegree", LAGraph_Cached_OutDegree(*G, msg));
+    return GrB_SUCCESS;
+}
+
+int sandia_triangle_count(uint64_t *ntri, LAGraph_Graph G, char *msg)
+{
+    LAGr_TriangleCount_Method method = LAGr_TriangleCount_Sandia_LL;
+    LAGr_TriangleCount_Presort presort = LAGr_TriangleCount_AutoSort;
+    int status;
+    TRACE_CALL("LAGr_TriangleCount", status = LAGr_TriangleCount(ntri, G, &method, &presort, msg));
+    return status;
+}
+
+//--------------------------------------------------------------------
+// Треугольники по вершинам: C<A> = A*A (plus_pair), сумма строки i
+// равна удвоенному числу треугольников через i. A симметрична, поэтому
+// A' = A и явная транспозиция (GrB_DESC_ST1) не нужна: маска только
+// структурная. Строки считаются независимо внутри GraphBLAS, общих
+// счётчиков нет.
+//--------------------------------------------------------------------
+int sandia_vertex_triangles(GrB_Vector *t, LAGraph_Graph G, char *msg)
+{
+    *t = NULL;
+    if (G->is_symmetric_structure != LAGraph_TRUE || G->nself_edges != 0)
+    {
+        snprintf(msg, LAGRAPH_MSG_LEN, "sandia_vertex_triangles: needs a symmetric graph without self edges");
+        return GrB_INVALID_VALUE;
+    }
+    GrB_Index n;
+    GrB_Matrix_nrows(&n, G->A);
+
+    GrB_Matrix C = NULL;
+    GrB_Info info = GrB_Matrix_new(&C, GrB_UINT64, n, n);
+    if (info == GrB_SUCCESS)
+        TRACE_CALL("GrB_mxm (C<A> = A*A)", info = GrB_mxm(C, G->A, NULL, GxB_PLUS_PAIR_UINT64, G->A, G->A, GrB_DESC_S));
+    if (info == GrB_SUCCESS)
+        info = GrB_Vector_new(t, GrB_UINT64, n);
+    if (info == GrB_SUCCESS)
+        TRACE_CALL("GrB_Matrix_reduce (rows)", info = GrB_Matrix_reduce_Monoid(*t, NULL, NULL, GrB_PLUS_MONOID_UINT64, C, NULL));
+    GrB_Matrix_free(&C);
+    if (info != GrB_SUCCESS)
+    {
+        GrB_Vector_free(t);
+        snprintf(msg, LAGRAPH_MSG_LEN, "sandia_vertex_triangles: GraphBLAS error %d", (int)info);
+    }
+    return info;
+}
+
+// Dense копия разреженного вектора (отсутствующие элементы = 0)
+static int64_t *dense_int64(GrB_Vector v, GrB_Index n, bool is_uint64)
+{
+    int64_t *dense = calloc(n > 0 ? n : 1, sizeof(int64_t));
+    GrB_Index nz = 0;
+    GrB_Vector_nvals(&nz, v);
+    GrB_Index *I = malloc((nz > 0 ? nz : 1) * sizeof(GrB_Index));
+    int64_t *X = malloc((nz > 0 ? nz : 1) * sizeof(int64_t));
+    GrB_Info info = GrB_SUCCESS;
+    if (dense && I && X)
+        info = is_uint64 ? GrB_Vector_extractTuples_UINT64(I, (uint64_t *)X, &nz, v)
+                         : GrB_Vector_extractTuples_INT64(I, X, &nz, v);
+    if (!dense || !I || !X || info != GrB_SUCCESS)
+    {
+        free(dense);
+        dense = NULL;
+    }
+    else
+        for (GrB_Index k = 0; k < nz; k++)
+            dense[I[k]] = X[k];
+    free(I);
+    free(X);
+    return dense;
+}
+
+int sandia_write_vertex_triangles(const char *path, GrB_Vector t, LAGraph_Graph G, uint64_t *ntri, char *msg)
+{
+    GrB_Index n;
+    GrB_Vector_size(&n, t);
+    int64_t *twice = dense_int64(t, n, true);
+    int64_t *degree = dense_int64(G->out_degree, n, false);
+    FILE *out = fopen(path, "wb");
+    if (!twice || !degree || !out)
+    {
+        snprintf(msg, LAGRAPH_MSG_LEN, "sandia_write_vertex_triangles: %s",
+                 out ? "out of memory" : "cannot open the output file");
+        free(twice);
+        free(degree);
+        if (out)
+            fclose(out);
+        return out ? GrB_OUT_OF_MEMORY : GrB_INVALID_VALUE;
+    }
+
+    // t хранит удвоенные счётчики: делим на месте и пишем их целиком,
+    // коэффициенты кластеризации считаются и пишутся блоками
+    uint64_t *counts = (uint64_t *)twice;
+    uint64_t sum = 0;
+    for (GrB_Index v = 0; v < n; v++)
+    {
+        counts[v] = (uint64_t)twice[v] / 2;
+        sum += counts[v];
+    }
+    *ntri = sum / 3;
+    SandiaVertexFileHeader header = {SANDIA_VERTEX_MAGIC, SANDIA_VERTEX_VERSION, 0, n, *ntri};
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    ok = ok && fwrite(counts, sizeof(uint64_t), n, out) == n;
+
+    enum { BLOCK = 1 << 16 };
+    double *lcc = malloc(BLOCK * sizeof(double));
+    ok = ok && lcc != NULL;
+    for (GrB_Index b = 0; ok && b < n; b += BLOCK)
+    {
+        GrB_Index len = n - b < BLOCK ? n - b : BLOCK;
+        for (GrB_Index k = 0; k < len; k++)
+        {
+            double d = (double)degree[b + k];
+            lcc[k] = d < 2.0 ? 0.0 : 2.0 * (double)counts[b + k] / (d * (d - 1.0));
+        }
+        ok = fwrite(lcc, sizeof(double), len, out) == len;
+    }
+    free(lcc);
+    ok = (fclose(out) == 0) && ok;
+    free(twice);
+    free(degree);
+    if (!ok)
+    {
+        snprintf(msg, LAGRAPH_MSG_LEN, "sandia_write_vertex_triangles: write error");
+        return GrB_INVALID_VALUE;
+    }
+    return GrB_SUCCESS;
+}
+
 //--------------------------------------------------------------------
 // Основная функция
 //--------------------------------------------------------------------
+#ifndef GRAPH_BENCH_DRIVER
 int main(int argc, char **argv)
 {
-    if (argc < 2)
+    bool tune = false;
+    const char *vertex_path = NULL;
+    bool usage = argc < 2;
+    for (int i = 2; i < argc && !usage; i++)
+    {
+        if (strcmp(argv[i], "--tune") == 0)
+            tune = true;
+        else if (strcmp(argv[i], "--vertex") == 0 && i + 1 < argc)
+            vertex_path = argv[++i];
+        else
+            usage = true;
+    }
+    if (usage)
     {
-        fprintf(stderr, "Usage: %s input.mtx\n", argv[0]);
+        fprintf(stderr, "Usage: %s input.mtx [--tune] [--vertex counts.bin]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
     const char *filename = argv[1];
 
-    LAGraph_Init(NULL);
+    // GraphBLAS allocates through the counting allocators, so the memory
+    // lines below include the library matrices
+    LAGr_Init(GrB_NONBLOCKING, graph_mem_malloc, graph_mem_calloc, graph_mem_realloc, graph_mem_free, NULL);
 
+    GraphMemPhase mem;
+    graph_mem_phase_begin(&mem);
     GrB_Matrix A = read_matrix_market(filename);
+    graph_mem_phase_end(&mem);
+    graph_mem_print(stdout, "Память (загрузка и построение)", &mem);
     if (!A)
     {
         fprintf(stderr, "Error reading MatrixMarket file.\n");
@@ -120,17 +308,15 @@ int main(int argc, char **argv)
 
     LAGraph_Graph G = NULL;
     char msg[LAGRAPH_MSG_LEN];
-    if (LAGraph_New(&G, &A, LAGraph_ADJACENCY_UNDIRECTED, msg) != GrB_SUCCESS)
+    graph_mem_phase_begin(&mem);
+    if (sandia_prepare_graph(&G, &A, msg) != GrB_SUCCESS)
     {
         fprintf(stderr, "LAGraph_New failed: %s\n", msg);
         LAGraph_Finalize(msg);
         return EXIT_FAILURE;
     }
-
-    if (G->is_symmetric_structure)
-        printf("✔ Граф симметричен.\n");
-    else
-        printf("✖ Граф несимметричен.\n");
+    graph_mem_phase_end(&mem);
+    graph_mem_print(stdout, "Память (LAGraph_Graph)", &mem);
 
     GrB_Matrix matr = G->A; 
     GrB_Matrix_nrows(&nrows, matr);
@@ -142,34 +328,36 @@ int main(int argc, char **argv)
     printf("  Вершин (столбцов): %llu\n", (unsigned long long)ncols);
     printf("Количество рёбер (ненулевых элементов): %llu\n", (unsigned long long)nvals);
 
-    printf("************************.\n");
-
-    LAGraph_DeleteSelfEdges(G, msg);
-
-    LAGraph_Cached_NSelfEdges(G, msg);
-    LAGraph_Cached_IsSymmetricStructure(G, msg);
-    LAGraph_Cached_OutDegree(G, msg);
-
-    GrB_Matrix_nrows(&nrows, matr);
-    GrB_Matrix_ncols(&ncols, matr);
-    GrB_Matrix_nvals(&nvals, matr);
-
-    printf("Размер матрицы смежности:\n");
-    printf("  Вершин (строк):  %llu\n", (unsigned long long)nrows);
-    printf("  Вершин (столбцов): %llu\n", (unsigned long long)ncols);
-    printf("Количество рёбер (ненулевых элементов): %llu\n", (unsigned long long)nvals);
-
     if (G->is_symmetric_structure)
         printf("✔ Граф симметричен.\n");
     else
         printf("✖ Граф несимметричен.\n");
+    printf("************************.\n");
+
+    // Режим настройки: метод и сортировка выбираются по подграфу
+    SandiaTcChoice choice = {LAGr_TriangleCount_Sandia_LL, LAGr_TriangleCount_AutoSort, 0.0, false};
+    if (tune)
+    {
+        double tune_start = LAGraph_WallClockTime();
+        if (sandia_tc_tune(&choice, G, filename, msg) != GrB_SUCCESS)
+        {
+            fprintf(stderr, "Tuning failed: %s\n", msg);
+            LAGraph_Delete(&G, msg);
+            LAGraph_Finalize(msg);
+            return EXIT_FAILURE;
+        }
+        printf("Выбран метод: %s, %s (%s, %.3f s), прогноз %.6f s\n", sandia_tc_method_name(choice.method),
+               sandia_tc_presort_name(choice.presort), choice.from_cache ? "из кэша" : "настройка",
+               LAGraph_WallClockTime() - tune_start, choice.predicted);
+        printf("************************.\n");
+    }
+
     uint64_t ntri = 0;
-    LAGr_TriangleCount_Method method = LAGr_TriangleCount_Sandia_LL;
-    LAGr_TriangleCount_Presort presort = LAGr_TriangleCount_AutoSort;
+    graph_mem_phase_begin(&mem);
     clock_t c1 = clock();
     double start_time = LAGraph_WallClockTime();
 
-    if (LAGr_TriangleCount(&ntri, G, &method, &presort, msg) != GrB_SUCCESS)
+    if (sandia_triangle_count_choice(&ntri, G, &choice, msg) != GrB_SUCCESS)
     {
         fprintf(stderr, "TriangleCount failed: %s\n", msg);
         LAGraph_Delete(&G, msg);
@@ -178,11 +366,44 @@ int main(int argc, char **argv)
     }
     clock_t c2 = clock();
     double end_time = LAGraph_WallClockTime();
+    graph_mem_phase_end(&mem);
     printf("CPU time: %.6f s\n", (double)(c2 - c1) / CLOCKS_PER_SEC);
     printf("Время выполнения: %.6f секунд\n", end_time - start_time);
+    if (tune)
+        printf("Прогноз: %.6f s, факт: %.6f s\n", choice.predicted, end_time - start_time);
 
-    printf("Triangle count (Sandia_LL): %llu\n", ntri);
+    graph_mem_print(stdout, "Память (подсчёт треугольников)", &mem);
+    printf("Triangle count (%s): %llu\n", sandia_tc_method_name(choice.method), ntri);
+
+    // Треугольники и коэффициенты кластеризации по вершинам
+    if (vertex_path)
+    {
+        GrB_Vector t = NULL;
+        uint64_t vertex_ntri = 0;
+        graph_mem_phase_begin(&mem);
+        double t0 = LAGraph_WallClockTime();
+        int status = sandia_vertex_triangles(&t, G, msg);
+        double t1 = LAGraph_WallClockTime();
+        if (status == GrB_SUCCESS)
+            status = sandia_write_vertex_triangles(vertex_path, t, G, &vertex_ntri, msg);
+        double t2 = LAGraph_WallClockTime();
+        graph_mem_phase_end(&mem);
+        GrB_Vector_free(&t);
+        if (status != GrB_SUCCESS)
+        {
+            fprintf(stderr, "Per-vertex count failed: %s\n", msg);
+            LAGraph_Delete(&G, msg);
+            LAGraph_Finalize(msg);
+            return EXIT_FAILURE;
+        }
+        printf("По вершинам: %.6f s, запись %s: %.6f s\n", t1 - t0, vertex_path, t2 - t1);
+        graph_mem_print(stdout, "Память (по вершинам)", &mem);
+        if (vertex_ntri != ntri)
+            fprintf(stderr, "Warning: per-vertex counts sum to %llu triangles, global count %llu\n",
+                    (unsigned long long)vertex_ntri, (unsigned long long)ntri);
+    }
     LAGraph_Delete(&G, msg);
     LAGraph_Finalize(msg);
     return EXIT_SUCCESS;
 }
+#endif
@@ -0,0 +1,57 @@
+#ifndef SANDIA_SUITESPARSE_H
+#define SANDIA_SUITESPARSE_H
+
+#include <stdint.h>
+#include <GraphBLAS.h>
+#include <LAGraph.h>
+
+#include "../common/graph_cache.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Symmetric UINT32 pattern matrix of the cached graph (exits on failure) */
+    GrB_Matrix build_sandia_matrix(const GraphCache *cache);
+
+    /* graph_cache_load + build_sandia_matrix, printing sizes and times */
+    GrB_Matrix read_matrix_market(const char *filename);
+
+    /* LAGraph_New on *A (which it takes over), self-edge removal and the
+     * cached properties LAGr_TriangleCount needs */
+    int sandia_prepare_graph(LAGraph_Graph *G, GrB_Matrix *A, char *msg);
+
+    /* LAGr_TriangleCount with Sandia_LL and AutoSort */
+    int sandia_triangle_count(uint64_t *ntri, LAGraph_Graph G, char *msg);
+
+    /* Per-vertex file written by sandia_write_vertex_triangles: this header,
+     * then uint64_t count[n] (triangles through every vertex), then
+     * double lcc[n] (local clustering coefficient 2 t / (d (d - 1)), 0 for
+     * degree < 2), native byte order */
+#define SANDIA_VERTEX_MAGIC 0x58545654u /* "TVTX" */
+#define SANDIA_VERTEX_VERSION 1u
+
+    typedef struct
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t reserved;
+        uint64_t n;
+        uint64_t triangles;
+    } SandiaVertexFileHeader;
+
+    /* *t = row sums of C<A> = A*A (A is symmetric) with the plus_pair
+     * semiring, i.e. twice the triangles through every vertex (vertices
+     * without any are absent). G must come from sandia_prepare_graph. */
+    int sandia_vertex_triangles(GrB_Vector *t, LAGraph_Graph G, char *msg);
+
+    /* Streams counts and clustering coefficients of t (from
+     * sandia_vertex_triangles) to path; *ntri gets the global count */
+    int sandia_write_vertex_triangles(const char *path, GrB_Vector t, LAGraph_Graph G, uint64_t *ntri, char *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SANDIA_SUITESPARSE_H */
@@ -1,13 +1,16 @@
 #include <spla.hpp>
 #include <spla/algorithm.hpp>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cassert>
 #include <chrono>
 #include <filesystem>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+
+#include "sandia_spla.hpp"
+#include "../common/spla_build.hpp"
+#include "../common/graph_trace.h"
 using namespace spla;
 
 static spla::ref_ptr<spla::Matrix> a;
@@ -18,70 +21,57 @@ static int edges_count = 0;
 // static int n = 0;
 int max_node_id = 0;
 
-struct Edge
+void build_graph_sandia(const GraphCache &cache)
 {
-    int u;
-    int v;
-    int w;
-};
+    el_cnt = 0;
+    max_node_id = cache.header.nnz > 0 ? static_cast<int>(cache.header.max_index + 1) : 0;
+    a = spla::Matrix::make(max_node_id, max_node_id, spla::INT);
+    std::cout << "mx_el: " << max_node_id << "\n";
+    // Entries go in transposed, as (v, u), with value 1
+    auto coo = coo_from_cache<int>(cache, cache.header.n, max_node_id, cache.header.nnz, true, false, 1);
+    build_matrix(a, coo);
+    el_cnt += static_cast<int>(coo.rows.size());
+    std::cout << "loaded elements: " << el_cnt << "\n";
+    TRACE_CALL("spla::Matrix::set_format", a->set_format(spla::FormatMatrix::AccCsr));
+}
 
 void load_graph_mm(const std::string &path)
 {
-    std::ifstream fin(path);
-    if (!fin.is_open())
+    GraphCache cache;
+    if (graph_cache_load(path.c_str(), &cache) != 0)
     {
         throw std::runtime_error("Cannot open file: " + path);
     }
+    build_graph_sandia(cache);
+    graph_cache_close(&cache);
+}
 
-    std::vector<Edge> edges;
-    std::string line;
-    int rows, cols, nnz;
-    int cf = 0;
-
-    while (std::getline(fin, line))
-    {
-        if (line.empty() || line[0] == '%')
-            continue;
-        cf += 1;
-        std::istringstream iss(line);
-        Edge e{};
-        Edge e1{};
-        if (!(iss >> e.u >> e.v))
-            continue;
-        if (cf == 1)
-        {
-            continue;
-        };
-        max_node_id = std::max(max_node_id, std::max((e.u), (e.v)));
-        e.u--, e.v--;
-        e.w = 1;
-        edges.push_back(e);
-    }
-
-    fin.close();
-    a = spla::Matrix::make(max_node_id, max_node_id, spla::INT);
-    std::cout << "mx_el: " << max_node_id << "\n";
-    for (const auto &e : edges)
-    {
-        a->set_uint(e.v, e.u, e.w); 
-        el_cnt += 1;
-    }
-    std::cout << "loaded elements: " << el_cnt << "\n";
-    a->set_format(spla::FormatMatrix::AccCsr);
+std::int32_t triangle_count()
+{
+    b = spla::Matrix::make(max_node_id, max_node_id, spla::INT);
+    b->set_format(spla::FormatMatrix::AccCsr);
+    std::int32_t ntrins = 0;
+    spla::Status res;
+    TRACE_CALL("spla::tc", res = tc(ntrins, a, b));
+    if (res != spla::Status::Ok)
+        throw std::runtime_error("tc failed: " + std::to_string(static_cast<int>(res)));
+    return ntrins;
 }
 using clock_ = std::chrono::steady_clock;
 
-int main()
+#ifndef GRAPH_BENCH_DRIVER
+int main(int argc, char **argv)
 {
     try
     {
-        std::filesystem::path graph_path = "../datasets/graph500-scale19-ef16_adj.mmio";
+        std::filesystem::path graph_path = argc > 1 ? argv[1] : "../datasets/graph500-scale19-ef16_adj.mmio";
         load_graph_mm(graph_path);
-        b = spla::Matrix::make(max_node_id, max_node_id, spla::INT);
-        b->set_format(spla::FormatMatrix::AccCsr);
-        int32_t ntrins;
-        auto res = tc(ntrins, a, b);
-        std::cout << "res: " << static_cast<int>(res) << "\n";
+        auto start = clock_::now();
+        std::int32_t ntrins = triangle_count();
+        auto end = clock_::now();
+        std::cout << "triangles: " << ntrins << "\n";
+        std::cout << "Algorithm execution time: "
+                  << std::chrono::duration<double>(end - start).count() << " seconds\n";
     }
     catch (const std::exception &e)
     {
@@ -91,3 +81,4 @@ int main()
 
     return 0;
 }
+#endif
@@ -0,0 +1,17 @@
+#ifndef SANDIA_SPLA_HPP
+#define SANDIA_SPLA_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "../common/graph_cache.h"
+
+// Triangle counting with spla::tc. Like prim_spla, the matrices live in
+// this module's globals; build_graph_sandia replaces the previous graph.
+
+void build_graph_sandia(const GraphCache &cache);
+void load_graph_mm(const std::string &path);
+
+std::int32_t triangle_count();
+
+#endif // SANDIA_SPLA_HPP
@@ -0,0 +1,350 @@
+#define _GNU_SOURCE
+
+#include "sandia_tune.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../common/graph_trace.h"
+
+#define TUNE_REPS 3
+#define TUNE_GIVE_UP 10.0 /* stop repeating a combination this much slower than the best */
+#define TUNE_SEED 0x9e3779b97f4a7c15ull
+
+typedef struct
+{
+    LAGr_TriangleCount_Method method;
+    LAGr_TriangleCount_Presort presort;
+} Combination;
+
+/* Burkhardt and Cohen ignore the presort */
+static const Combination COMBINATIONS[] = {
+    {LAGr_TriangleCount_Burkhardt, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Cohen, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Sandia_LL, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Sandia_LL, LAGr_TriangleCount_Ascending},
+    {LAGr_TriangleCount_Sandia_LL, LAGr_TriangleCount_Descending},
+    {LAGr_TriangleCount_Sandia_UU, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Sandia_UU, LAGr_TriangleCount_Ascending},
+    {LAGr_TriangleCount_Sandia_UU, LAGr_TriangleCount_Descending},
+    {LAGr_TriangleCount_Sandia_LUT, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Sandia_LUT, LAGr_TriangleCount_Ascending},
+    {LAGr_TriangleCount_Sandia_LUT, LAGr_TriangleCount_Descending},
+    {LAGr_TriangleCount_Sandia_ULT, LAGr_TriangleCount_NoSort},
+    {LAGr_TriangleCount_Sandia_ULT, LAGr_TriangleCount_Ascending},
+    {LAGr_TriangleCount_Sandia_ULT, LAGr_TriangleCount_Descending},
+};
+#define NCOMBINATIONS (sizeof(COMBINATIONS) / sizeof(COMBINATIONS[0]))
+
+typedef struct
+{
+    GrB_Index n;
+    GrB_Index nvals;
+    double mean;
+    double max;
+    double cv;     /* standard deviation / mean */
+    double wedges; /* sum over vertices of d(d-1)/2 */
+} DegreeStats;
+
+typedef struct
+{
+    unsigned long long src_size;
+    long long src_mtime;
+    unsigned long long n;
+    unsigned long long nvals;
+    int threads_outer;
+    int threads_inner;
+} Fingerprint;
+
+const char *sandia_tc_method_name(LAGr_TriangleCount_Method method)
+{
+    switch (method)
+    {
+    case LAGr_TriangleCount_AutoMethod:
+        return "Auto";
+    case LAGr_TriangleCount_Burkhardt:
+        return "Burkhardt";
+    case LAGr_TriangleCount_Cohen:
+        return "Cohen";
+    case LAGr_TriangleCount_Sandia_LL:
+        return "Sandia_LL";
+    case LAGr_TriangleCount_Sandia_UU:
+        return "Sandia_UU";
+    case LAGr_TriangleCount_Sandia_LUT:
+        return "Sandia_LUT";
+    case LAGr_TriangleCount_Sandia_ULT:
+        return "Sandia_ULT";
+    }
+    return "?";
+}
+
+const char *sandia_tc_presort_name(LAGr_TriangleCount_Presort presort)
+{
+    switch (presort)
+    {
+    case LAGr_TriangleCount_AutoSort:
+        return "AutoSort";
+    case LAGr_TriangleCount_NoSort:
+        return "NoSort";
+    case LAGr_TriangleCount_Ascending:
+        return "Ascending";
+    case LAGr_TriangleCount_Descending:
+        return "Descending";
+    }
+    return "?";
+}
+
+int sandia_triangle_count_choice(uint64_t *ntri, LAGraph_Graph G, const SandiaTcChoice *choice, char *msg)
+{
+    LAGr_TriangleCount_Method method = choice->method;
+    LAGr_TriangleCount_Presort presort = choice->presort;
+    int status;
+    TRACE_CALL("LAGr_TriangleCount", status = LAGr_TriangleCount(ntri, G, &method, &presort, msg));
+    return status;
+}
+
+static uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static int degree_stats(DegreeStats *stats, LAGraph_Graph G)
+{
+    memset(stats, 0, sizeof(*stats));
+    GrB_Matrix_nrows(&stats->n, G->A);
+    GrB_Matrix_nvals(&stats->nvals, G->A);
+    GrB_Index nz = 0;
+    GrB_Vector_nvals(&nz, G->out_degree);
+    int64_t *degree = malloc((nz > 0 ? nz : 1) * sizeof(int64_t));
+    if (degree == NULL)
+        return GrB_OUT_OF_MEMORY;
+    GrB_Info info = GrB_Vector_extractTuples_INT64(NULL, degree, &nz, G->out_degree);
+    if (info != GrB_SUCCESS)
+    {
+        free(degree);
+        return info;
+    }
+
+    double sum = 0.0, sumsq = 0.0;
+    for (GrB_Index k = 0; k < nz; k++)
+    {
+        double d = (double)degree[k];
+        sum += d;
+        sumsq += d * d;
+        stats->wedges += d * (d - 1.0) / 2.0;
+        if (d > stats->max)
+            stats->max = d;
+    }
+    free(degree);
+    if (stats->n > 0)
+    {
+        stats->mean = sum / (double)stats->n;
+        double var = sumsq / (double)stats->n - stats->mean * stats->mean;
+        stats->cv = stats->mean > 0.0 ? sqrt(var > 0.0 ? var : 0.0) / stats->mean : 0.0;
+    }
+    return GrB_SUCCESS;
+}
+
+/* Subgraph induced by every vertex kept with probability p; the sample
+ * depends on the vertex ids only */
+static int induced_sample(LAGraph_Graph *S, LAGraph_Graph G, double p, char *msg)
+{
+    GrB_Index n;
+    GrB_Matrix_nrows(&n, G->A);
+    GrB_Index *keep = malloc((n > 0 ? n : 1) * sizeof(GrB_Index));
+    if (keep == NULL)
+        return GrB_OUT_OF_MEMORY;
+    GrB_Index s = 0;
+    const uint64_t threshold = p >= 1.0 ? UINT64_MAX : (uint64_t)(p * 18446744073709551616.0);
+    for (GrB_Index v = 0; v < n; v++)
+        if (splitmix64(v ^ TUNE_SEED) <= threshold)
+            keep[s++] = v;
+
+    GrB_Matrix A = NULL;
+    int status = GrB_Matrix_new(&A, GrB_BOOL, s, s);
+    if (status == GrB_SUCCESS)
+        status = GrB_Matrix_extract(A, NULL, NULL, G->A, keep, s, keep, s, NULL);
+    free(keep);
+    if (status == GrB_SUCCESS)
+        status = LAGraph_New(S, &A, LAGraph_ADJACENCY_UNDIRECTED, msg);
+    if (status == GrB_SUCCESS)
+        status = LAGraph_Cached_NSelfEdges(*S, msg);
+    if (status == GrB_SUCCESS)
+        status = LAGraph_Cached_IsSymmetricStructure(*S, msg);
+    if (status == GrB_SUCCESS)
+        status = LAGraph_Cached_OutDegree(*S, msg);
+    GrB_Matrix_free(&A);
+    return status;
+}
+
+static bool fingerprint(Fingerprint *fp, LAGraph_Graph G, const char *dataset, char *msg)
+{
+    struct stat st;
+    if (dataset == NULL || stat(dataset, &st) != 0)
+        return false;
+    memset(fp, 0, sizeof(*fp));
+    fp->src_size = (unsigned long long)st.st_size;
+    fp->src_mtime = (long long)st.st_mtime;
+    GrB_Index n, nvals;
+    GrB_Matrix_nrows(&n, G->A);
+    GrB_Matrix_nvals(&nvals, G->A);
+    fp->n = n;
+    fp->nvals = nvals;
+    LAGraph_GetNumThreads(&fp->threads_outer, &fp->threads_inner, msg);
+    return true;
+}
+
+static char *decision_path(const char *dataset)
+{
+    size_t len = strlen(dataset);
+    char *path = malloc(len + sizeof(SANDIA_TUNE_SUFFIX));
+    if (path)
+    {
+        memcpy(path, dataset, len);
+        memcpy(path + len, SANDIA_TUNE_SUFFIX, sizeof(SANDIA_TUNE_SUFFIX));
+    }
+    return path;
+}
+
+static bool read_decision(SandiaTcChoice *choice, const char *path, const Fingerprint *fp)
+{
+    FILE *in = fopen(path, "r");
+    if (in == NULL)
+        return false;
+    Fingerprint stored;
+    int method, presort;
+    double predicted;
+    int fields = fscanf(in, "%llu %lld %llu %llu %d %d %d %d %lf", &stored.src_size, &stored.src_mtime,
+                        &stored.n, &stored.nvals, &stored.threads_outer, &stored.threads_inner,
+                        &method, &presort, &predicted);
+    fclose(in);
+    if (fields != 9 || stored.src_size != fp->src_size || stored.src_mtime != fp->src_mtime ||
+        stored.n != fp->n || stored.nvals != fp->nvals || stored.threads_outer != fp->threads_outer ||
+        stored.threads_inner != fp->threads_inner)
+        return false;
+    choice->method = (LAGr_TriangleCount_Method)method;
+    choice->presort = (LAGr_TriangleCount_Presort)presort;
+    choice->predicted = predicted;
+    choice->from_cache = true;
+    return true;
+}
+
+static void write_decision(const char *path, const Fingerprint *fp, const SandiaTcChoice *choice)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "sandia_tc_tune: cannot write %s\n", path);
+        return;
+    }
+    fprintf(out, "%llu %lld %llu %llu %d %d %d %d %.9g\n", fp->src_size, fp->src_mtime, fp->n, fp->nvals,
+            fp->threads_outer, fp->threads_inner, (int)choice->method, (int)choice->presort, choice->predicted);
+    fclose(out);
+}
+
+int sandia_tc_tune(SandiaTcChoice *choice, LAGraph_Graph G, const char *dataset, char *msg)
+{
+    choice->method = LAGr_TriangleCount_Sandia_LL;
+    choice->presort = LAGr_TriangleCount_AutoSort;
+    choice->predicted = 0.0;
+    choice->from_cache = false;
+
+    Fingerprint fp;
+    bool have_fp = fingerprint(&fp, G, dataset, msg);
+    char *path = have_fp ? decision_path(dataset) : NULL;
+    if (path && read_decision(choice, path, &fp))
+    {
+        free(path);
+        return GrB_SUCCESS;
+    }
+
+    DegreeStats full;
+    int status = degree_stats(&full, G);
+    if (status != GrB_SUCCESS)
+    {
+        free(path);
+        return status;
+    }
+    printf("Степени: n %llu, nnz %llu, mean %.2f, max %.0f, cv %.2f, wedges %.3g\n",
+           (unsigned long long)full.n, (unsigned long long)full.nvals, full.mean, full.max, full.cv, full.wedges);
+
+    double p = full.nvals > SANDIA_TUNE_SAMPLE_ENTRIES ? sqrt((double)SANDIA_TUNE_SAMPLE_ENTRIES / (double)full.nvals) : 1.0;
+    LAGraph_Graph S = NULL;
+    status = induced_sample(&S, G, p, msg);
+    DegreeStats sample;
+    if (status == GrB_SUCCESS)
+        status = degree_stats(&sample, S);
+    if (status != GrB_SUCCESS)
+    {
+        LAGraph_Delete(&S, msg);
+        free(path);
+        return status;
+    }
+    printf("Подграф: n %llu, nnz %llu (p = %.3f), wedges %.3g\n", (unsigned long long)sample.n,
+           (unsigned long long)sample.nvals, p, sample.wedges);
+
+    double best = INFINITY;
+    uint64_t reference = 0;
+    bool have_reference = false;
+    for (size_t c = 0; c < NCOMBINATIONS; c++)
+    {
+        double t = INFINITY;
+        uint64_t ntri = 0;
+        for (int rep = 0; rep < TUNE_REPS; rep++)
+        {
+            LAGr_TriangleCount_Method method = COMBINATIONS[c].method;
+            LAGr_TriangleCount_Presort presort = COMBINATIONS[c].presort;
+            double t0 = LAGraph_WallClockTime();
+            status = LAGr_TriangleCount(&ntri, S, &method, &presort, msg);
+            double dt = LAGraph_WallClockTime() - t0;
+            if (status < 0)
+                break;
+            if (dt < t)
+                t = dt;
+            if (t > TUNE_GIVE_UP * best)
+                break;
+        }
+        if (status < 0)
+        {
+            printf("  %-10s %-10s  failed (%d): %s\n", sandia_tc_method_name(COMBINATIONS[c].method),
+                   sandia_tc_presort_name(COMBINATIONS[c].presort), status, msg);
+            continue;
+        }
+        printf("  %-10s %-10s  %10.3f ms  (%llu triangles)\n", sandia_tc_method_name(COMBINATIONS[c].method),
+               sandia_tc_presort_name(COMBINATIONS[c].presort), t * 1e3, (unsigned long long)ntri);
+        if (have_reference && ntri != reference)
+            fprintf(stderr, "sandia_tc_tune: %s/%s counted %llu triangles, expected %llu\n",
+                    sandia_tc_method_name(COMBINATIONS[c].method), sandia_tc_presort_name(COMBINATIONS[c].presort),
+                    (unsigned long long)ntri, (unsigned long long)reference);
+        if (!have_reference)
+            reference = ntri;
+        have_reference = true;
+        if (t < best)
+        {
+            best = t;
+            choice->method = COMBINATIONS[c].method;
+            choice->presort = COMBINATIONS[c].presort;
+        }
+    }
+    LAGraph_Delete(&S, msg);
+
+    if (isinf(best))
+    {
+        free(path);
+        return status;
+    }
+    // Masked products do work proportional to the wedges they close
+    double scale = sample.wedges > 0.0 ? full.wedges / sample.wedges
+                                       : (double)full.nvals / (double)(sample.nvals > 0 ? sample.nvals : 1);
+    choice->predicted = best * scale;
+    if (path)
+        write_decision(path, &fp, choice);
+    free(path);
+    return GrB_SUCCESS;
+}
@@ -0,0 +1,51 @@
+#ifndef SANDIA_TUNE_H
+#define SANDIA_TUNE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <GraphBLAS.h>
+#include <LAGraph.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Method/presort selection for LAGr_TriangleCount.
+     *
+     * The degree statistics of G (mean, max, coefficient of variation and
+     * the wedge count sum d(d-1)/2) are read from its cached out-degree.
+     * Every method and presort combination is then timed on the subgraph
+     * induced by a random vertex sample sized to hold about
+     * SANDIA_TUNE_SAMPLE_ENTRIES entries; the fastest one wins, and its
+     * time is extrapolated to the whole graph by the ratio of wedges.
+     *
+     * With a dataset path, the decision is stored in <dataset>.tctune with
+     * the dataset fingerprint (source size and mtime, matrix size and
+     * entries, GraphBLAS threads) and reused while the fingerprint holds. */
+
+#define SANDIA_TUNE_SAMPLE_ENTRIES (1u << 18)
+#define SANDIA_TUNE_SUFFIX ".tctune"
+
+    typedef struct
+    {
+        LAGr_TriangleCount_Method method;
+        LAGr_TriangleCount_Presort presort;
+        double predicted;   /* seconds on the whole graph */
+        bool from_cache;    /* read from the decision file, nothing timed */
+    } SandiaTcChoice;
+
+    /* G must come from sandia_prepare_graph; dataset may be NULL */
+    int sandia_tc_tune(SandiaTcChoice *choice, LAGraph_Graph G, const char *dataset, char *msg);
+
+    /* LAGr_TriangleCount with the chosen method and presort */
+    int sandia_triangle_count_choice(uint64_t *ntri, LAGraph_Graph G, const SandiaTcChoice *choice, char *msg);
+
+    const char *sandia_tc_method_name(LAGr_TriangleCount_Method method);
+    const char *sandia_tc_presort_name(LAGr_TriangleCount_Presort presort);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SANDIA_TUNE_H */
@@ -0,0 +1,513 @@
+#include "triangles.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "../common/bitset.hpp"
+#include "../common/parallel.hpp"
+#include "../common/undirected_csr.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TC_X86_KERNELS 1
+#endif
+
+namespace
+{
+    constexpr std::uint64_t BUILD_BLOCK = 4096;  // rows per scheduling block while building
+    constexpr unsigned CHUNKS_PER_THREAD = 64;   // count phase: edge-balanced chunks per thread
+    constexpr std::size_t GALLOP_RATIO = 32;     // binary search when one list is this much longer
+    constexpr std::uint64_t DAG_BLOCK_ENTRIES = std::uint64_t(1) << 24; // undirected entries per compressed DAG block
+
+    //----------------------------------------------------------------
+    // Sorted-list intersections |a ∩ b|, both lists strictly ascending
+    //----------------------------------------------------------------
+
+    template <typename Index>
+    std::uint64_t merge_scalar(const Index *a, std::size_t na, const Index *b, std::size_t nb)
+    {
+        std::uint64_t count = 0;
+        std::size_t i = 0, j = 0;
+        while (i < na && j < nb)
+        {
+            Index x = a[i], y = b[j];
+            count += x == y;
+            i += x <= y;
+            j += y <= x;
+        }
+        return count;
+    }
+
+    // Every element of the short list searched in what is left of the long one
+    template <typename Index>
+    std::uint64_t gallop(const Index *s, std::size_t ns, const Index *l, std::size_t nl)
+    {
+        std::uint64_t count = 0;
+        const Index *end = l + nl;
+        for (std::size_t i = 0; i < ns && l < end; i++)
+        {
+            l = std::lower_bound(l, end, s[i]);
+            if (l < end && *l == s[i])
+            {
+                count++;
+                l++;
+            }
+        }
+        return count;
+    }
+
+#ifdef TC_X86_KERNELS
+    // Block merge: all 8 x 8 pairs of the current blocks are compared by
+    // rotating b, then the block with the smaller last element advances.
+    // A match is only ever counted in the one block pair holding it.
+    __attribute__((target("avx2"))) std::uint64_t merge_avx2(const std::uint32_t *a, std::size_t na,
+                                                             const std::uint32_t *b, std::size_t nb)
+    {
+        std::uint64_t count = 0;
+        std::size_t i = 0, j = 0;
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        while (i + 8 <= na && j + 8 <= nb)
+        {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+            __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            for (int r = 1; r < 8; r++)
+            {
+                vb = _mm256_permutevar8x32_epi32(vb, rotate);
+                eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+            }
+            count += static_cast<unsigned>(__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(eq))));
+            std::uint32_t amax = a[i + 7], bmax = b[j + 7];
+            i += amax <= bmax ? 8 : 0;
+            j += bmax <= amax ? 8 : 0;
+        }
+        return count + merge_scalar(a + i, na - i, b + j, nb - j);
+    }
+
+    __attribute__((target("avx512f"))) std::uint64_t merge_avx512(const std::uint32_t *a, std::size_t na,
+                                                                  const std::uint32_t *b, std::size_t nb)
+    {
+        std::uint64_t count = 0;
+        std::size_t i = 0, j = 0;
+        const __m512i rotate = _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0);
+        while (i + 16 <= na && j + 16 <= nb)
+        {
+            __m512i va = _mm512_loadu_si512(a + i);
+            __m512i vb = _mm512_loadu_si512(b + j);
+            __mmask16 eq = _mm512_cmpeq_epi32_mask(va, vb);
+            // The zero-masked form: GCC's unmasked permute and alignr pass
+            // _mm512_undefined_epi32, which trips -Wmaybe-uninitialized
+            for (int r = 1; r < 16; r++)
+            {
+                vb = _mm512_maskz_permutexvar_epi32(0xFFFF, rotate, vb);
+                eq |= _mm512_cmpeq_epi32_mask(va, vb);
+            }
+            count += static_cast<unsigned>(__builtin_popcount(eq));
+            std::uint32_t amax = a[i + 15], bmax = b[j + 15];
+            i += amax <= bmax ? 16 : 0;
+            j += bmax <= amax ? 16 : 0;
+        }
+        // Finish 8-wide before going scalar
+        return count + merge_avx2(a + i, na - i, b + j, nb - j);
+    }
+#endif
+
+    template <typename Index>
+    using MergeFn = std::uint64_t (*)(const Index *, std::size_t, const Index *, std::size_t);
+
+    // The block merges compare 32-bit lanes; 64-bit ids merge scalar
+    template <typename Index>
+    MergeFn<Index> merge_for(TcKernel kernel)
+    {
+#ifdef TC_X86_KERNELS
+        if constexpr (std::is_same_v<Index, std::uint32_t>)
+        {
+            if (kernel == TcKernel::Avx512)
+                return merge_avx512;
+            if (kernel == TcKernel::Avx2)
+                return merge_avx2;
+        }
+#endif
+        (void)kernel;
+        return merge_scalar<Index>;
+    }
+
+    template <typename Index>
+    inline std::uint64_t intersect(MergeFn<Index> merge, const Index *a, std::size_t na, const Index *b,
+                                   std::size_t nb)
+    {
+        if (na > nb)
+        {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (na == 0)
+            return 0;
+        if (nb >= GALLOP_RATIO * na)
+            return gallop(a, na, b, nb);
+        return merge(a, na, b, nb);
+    }
+
+    // Sorts and deduplicates every row of a CSR in place; returns the
+    // unique length of each row
+    template <typename Index>
+    std::vector<std::uint64_t> sort_rows(const std::vector<std::uint64_t> &ptr, std::vector<Index> &col,
+                                         std::uint64_t n, unsigned nthreads, bool unique)
+    {
+        std::vector<std::uint64_t> len(n);
+        parallel_for_dynamic(nthreads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t r = b; r < e; r++)
+            {
+                auto first = col.begin() + static_cast<std::ptrdiff_t>(ptr[r]);
+                auto last = col.begin() + static_cast<std::ptrdiff_t>(ptr[r + 1]);
+                std::sort(first, last);
+                len[r] = static_cast<std::uint64_t>((unique ? std::unique(first, last) : last) - first);
+            } });
+        return len;
+    }
+}
+
+template <typename Index>
+BasicTcGraph<Index> tc_graph_from_cache(const GraphCache &cache, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    // Undirected adjacency: both directions of every non-loop entry
+    UndirectedCsr<Index> undirected = undirected_csr<Index>(cache, nthreads, "tc_graph_from_cache");
+    const Index n = undirected.n;
+    std::vector<std::uint64_t> &ptr = undirected.ptr;
+    std::vector<Index> &adj = undirected.adj;
+    std::vector<std::uint64_t> degree = sort_rows(ptr, adj, n, nthreads, true);
+
+    // Counting sort by degree: ranks ascend by (degree, id)
+    BasicTcGraph<Index> g;
+    g.n = n;
+    g.order.resize(n);
+    {
+        std::uint64_t max_degree = 0;
+        for (Index v = 0; v < n; v++)
+            max_degree = std::max(max_degree, degree[v]);
+        std::vector<std::uint64_t> bucket(max_degree + 2, 0);
+        for (Index v = 0; v < n; v++)
+            bucket[degree[v] + 1]++;
+        for (std::uint64_t d = 0; d <= max_degree; d++)
+            bucket[d + 1] += bucket[d];
+        for (Index v = 0; v < n; v++)
+            g.order[bucket[degree[v]]++] = v;
+    }
+    std::vector<Index> rank(n);
+    parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t r = b; r < e; r++)
+            rank[g.order[r]] = static_cast<Index>(r); });
+
+    // Keep the edges towards higher rank, in rank numbering
+    g.row_ptr.assign(std::uint64_t(n) + 1, 0);
+    parallel_for_dynamic(nthreads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t r = b; r < e; r++)
+        {
+            Index v = g.order[r];
+            std::uint64_t out = 0;
+            for (std::uint64_t k = ptr[v]; k < ptr[v] + degree[v]; k++)
+                out += rank[adj[k]] > r;
+            g.row_ptr[r + 1] = out;
+        } });
+    for (Index r = 0; r < n; r++)
+        g.row_ptr[r + 1] += g.row_ptr[r];
+
+    g.col.resize(g.row_ptr[n]);
+    parallel_for_dynamic(nthreads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t r = b; r < e; r++)
+        {
+            Index v = g.order[r];
+            std::uint64_t pos = g.row_ptr[r];
+            for (std::uint64_t k = ptr[v]; k < ptr[v] + degree[v]; k++)
+                if (rank[adj[k]] > r)
+                    g.col[pos++] = rank[adj[k]];
+        } });
+    sort_rows(g.row_ptr, g.col, n, nthreads, false);
+    return g;
+}
+
+template <typename Index>
+std::uint64_t tc_count(const BasicTcGraph<Index> &g, const TcOptions &options)
+{
+    const unsigned nthreads = resolve_threads(options.nthreads);
+    const TcKernel kernel = tc_kernel_resolve(options.kernel);
+    if (!tc_kernel_supported(kernel))
+        throw std::runtime_error(std::string("tc_count: the CPU does not support the ") + tc_kernel_name(kernel) +
+                                 " kernel");
+    const MergeFn<Index> merge = merge_for<Index>(kernel);
+    const std::uint64_t m = g.col.size();
+    if (g.n == 0 || m == 0)
+        return 0;
+
+    // Row ranges holding about m / nchunks DAG edges each
+    const std::uint64_t nchunks = std::min<std::uint64_t>(g.n, std::uint64_t(nthreads) * CHUNKS_PER_THREAD);
+    std::vector<Index> cut{0};
+    for (std::uint64_t c = 1; c < nchunks; c++)
+    {
+        auto r = static_cast<Index>(
+            std::lower_bound(g.row_ptr.begin(), g.row_ptr.end(), m * c / nchunks) - g.row_ptr.begin());
+        if (r > cut.back() && r < g.n)
+            cut.push_back(r);
+    }
+    cut.push_back(g.n);
+
+    struct alignas(64) Partial
+    {
+        std::uint64_t count = 0;
+    };
+    std::vector<Partial> partial(nthreads);
+    std::vector<DenseBitset> marks;
+    marks.reserve(nthreads);
+    for (unsigned t = 0; t < nthreads; t++)
+        marks.emplace_back(0);
+
+    parallel_for_dynamic(nthreads, cut.size() - 1, 1, [&](std::uint64_t cb, std::uint64_t ce, unsigned t)
+                         {
+        std::uint64_t count = 0;
+        for (std::uint64_t c = cb; c < ce; c++)
+            for (Index u = cut[c]; u < cut[c + 1]; u++)
+            {
+                const Index *nu = g.col.data() + g.row_ptr[u];
+                const std::size_t du = g.row_ptr[u + 1] - g.row_ptr[u];
+                if (du >= options.bitmap_degree)
+                {
+                    DenseBitset &mark = marks[t];
+                    if (mark.size() < g.n)
+                        mark = DenseBitset(g.n);
+                    for (std::size_t k = 0; k < du; k++)
+                        mark.set(nu[k]);
+                    for (std::size_t k = 0; k < du; k++)
+                        for (std::uint64_t x = g.row_ptr[nu[k]]; x < g.row_ptr[nu[k] + 1]; x++)
+                            count += mark.test(g.col[x]);
+                    for (std::size_t k = 0; k < du; k++)
+                        mark.reset(nu[k]);
+                    continue;
+                }
+                for (std::size_t k = 0; k < du; k++)
+                {
+                    const Index v = nu[k];
+                    // Only the part of N+(u) above v can be in N+(v)
+                    count += intersect(merge, nu + k + 1, du - k - 1, g.col.data() + g.row_ptr[v],
+                                       g.row_ptr[v + 1] - g.row_ptr[v]);
+                }
+            }
+        partial[t].count += count; });
+
+    std::uint64_t total = 0;
+    for (const auto &p : partial)
+        total += p.count;
+    return total;
+}
+
+template BasicTcGraph<std::uint32_t> tc_graph_from_cache<std::uint32_t>(const GraphCache &, unsigned);
+template BasicTcGraph<std::uint64_t> tc_graph_from_cache<std::uint64_t>(const GraphCache &, unsigned);
+template std::uint64_t tc_count(const BasicTcGraph<std::uint32_t> &, const TcOptions &);
+template std::uint64_t tc_count(const BasicTcGraph<std::uint64_t> &, const TcOptions &);
+
+CompressedGraph tc_compressed_dag(const CompressedGraph &graph, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    const std::uint32_t n = graph.n();
+
+    // Ranks by ascending (degree, id)
+    std::uint32_t max_degree = 0;
+    for (std::uint32_t v = 0; v < n; v++)
+        max_degree = std::max(max_degree, graph.degree(v));
+    std::vector<std::uint64_t> bucket(std::uint64_t(max_degree) + 2, 0);
+    for (std::uint32_t v = 0; v < n; v++)
+        bucket[graph.degree(v) + 1]++;
+    for (std::uint64_t d = 0; d <= max_degree; d++)
+        bucket[d + 1] += bucket[d];
+    std::vector<std::uint32_t> order(n), rank(n);
+    for (std::uint32_t v = 0; v < n; v++)
+        order[bucket[graph.degree(v)]++] = v;
+    for (std::uint32_t r = 0; r < n; r++)
+        rank[order[r]] = r;
+
+    // Out-lists of a block of ranks: decoded, filtered and renumbered twice
+    // (count, then fill) so only the block is ever uncompressed
+    CompressedGraph dag(WeightCoding::None);
+    std::vector<std::vector<std::uint32_t>> buffers(nthreads, std::vector<std::uint32_t>(max_degree + 3));
+    std::vector<std::uint64_t> ptr;
+    std::vector<std::uint32_t> col;
+    for (std::uint32_t first = 0; first < n;)
+    {
+        std::uint32_t last = first;
+        std::uint64_t staged = 0;
+        while (last < n && (last == first || staged + graph.degree(order[last]) <= DAG_BLOCK_ENTRIES))
+            staged += graph.degree(order[last++]);
+        const std::uint32_t count = last - first;
+
+        ptr.assign(std::uint64_t(count) + 1, 0);
+        parallel_for_dynamic(nthreads, count, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                             {
+            std::uint32_t *nbrs = buffers[t].data();
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const std::uint32_t r = first + static_cast<std::uint32_t>(k), v = order[r];
+                graph.neighbors(v, nbrs);
+                std::uint64_t out = 0;
+                for (std::uint32_t x = 0; x < graph.degree(v); x++)
+                    out += rank[nbrs[x]] > r;
+                ptr[k + 1] = out;
+            } });
+        for (std::uint32_t k = 0; k < count; k++)
+            ptr[k + 1] += ptr[k];
+        col.resize(ptr[count]);
+        parallel_for_dynamic(nthreads, count, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                             {
+            std::uint32_t *nbrs = buffers[t].data();
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const std::uint32_t r = first + static_cast<std::uint32_t>(k), v = order[r];
+                graph.neighbors(v, nbrs);
+                std::uint64_t pos = ptr[k];
+                for (std::uint32_t x = 0; x < graph.degree(v); x++)
+                    if (rank[nbrs[x]] > r)
+                        col[pos++] = rank[nbrs[x]];
+                std::sort(col.begin() + ptr[k], col.begin() + pos);
+            } });
+        dag.append_rows(count, ptr.data(), col.data(), nullptr, nthreads);
+        first = last;
+    }
+    return dag;
+}
+
+std::uint64_t tc_count_compressed(const CompressedGraph &g, const TcOptions &options)
+{
+    const unsigned nthreads = resolve_threads(options.nthreads);
+    const TcKernel kernel = tc_kernel_resolve(options.kernel);
+    if (!tc_kernel_supported(kernel))
+        throw std::runtime_error(std::string("tc_count_compressed: the CPU does not support the ") +
+                                 tc_kernel_name(kernel) + " kernel");
+    const MergeFn<std::uint32_t> merge = merge_for<std::uint32_t>(kernel);
+    const std::uint32_t n = g.n();
+    const std::uint64_t m = g.entries();
+    if (n == 0 || m == 0)
+        return 0;
+
+    // Row ranges holding about m / nchunks DAG edges each
+    const std::uint64_t nchunks = std::min<std::uint64_t>(n, std::uint64_t(nthreads) * CHUNKS_PER_THREAD);
+    std::vector<std::uint32_t> cut{0};
+    std::uint32_t max_degree = 0;
+    for (std::uint64_t u = 0, seen = 0; u < n; u++)
+    {
+        if (seen >= m * cut.size() / nchunks && u > cut.back())
+            cut.push_back(static_cast<std::uint32_t>(u));
+        seen += g.degree(static_cast<std::uint32_t>(u));
+        max_degree = std::max(max_degree, g.degree(static_cast<std::uint32_t>(u)));
+    }
+    cut.push_back(n);
+
+    struct alignas(64) Partial
+    {
+        std::uint64_t count = 0;
+    };
+    std::vector<Partial> partial(nthreads);
+    std::vector<DenseBitset> marks;
+    marks.reserve(nthreads);
+    for (unsigned t = 0; t < nthreads; t++)
+        marks.emplace_back(0);
+
+    parallel_for_dynamic(nthreads, cut.size() - 1, 1, [&](std::uint64_t cb, std::uint64_t ce, unsigned t)
+                         {
+        std::vector<std::uint32_t> nu(max_degree + 3), nv(max_degree + 3);
+        std::uint64_t count = 0;
+        for (std::uint64_t c = cb; c < ce; c++)
+            for (std::uint32_t u = cut[c]; u < cut[c + 1]; u++)
+            {
+                const std::size_t du = g.degree(u);
+                if (du < 2)
+                    continue;
+                g.neighbors(u, nu.data());
+                if (du >= options.bitmap_degree)
+                {
+                    DenseBitset &mark = marks[t];
+                    if (mark.size() < n)
+                        mark = DenseBitset(n);
+                    for (std::size_t k = 0; k < du; k++)
+                        mark.set(nu[k]);
+                    for (std::size_t k = 0; k < du; k++)
+                    {
+                        g.neighbors(nu[k], nv.data());
+                        for (std::uint32_t x = 0; x < g.degree(nu[k]); x++)
+                            count += mark.test(nv[x]);
+                    }
+                    for (std::size_t k = 0; k < du; k++)
+                        mark.reset(nu[k]);
+                    continue;
+                }
+                for (std::size_t k = 0; k + 1 < du; k++)
+                {
+                    const std::uint32_t v = nu[k];
+                    g.neighbors(v, nv.data());
+                    count += intersect(merge, nu.data() + k + 1, du - k - 1, nv.data(), g.degree(v));
+                }
+            }
+        partial[t].count += count; });
+
+    std::uint64_t total = 0;
+    for (const auto &p : partial)
+        total += p.count;
+    return total;
+}
+
+std::uint64_t tc_intersect(const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb,
+                           TcKernel kernel)
+{
+    kernel = tc_kernel_resolve(kernel);
+    return intersect(merge_for<std::uint32_t>(tc_kernel_supported(kernel) ? kernel : TcKernel::Scalar), a, na, b, nb);
+}
+
+TcKernel tc_kernel_resolve(TcKernel kernel)
+{
+    if (kernel != TcKernel::Auto)
+        return kernel;
+    if (tc_kernel_supported(TcKernel::Avx512))
+        return TcKernel::Avx512;
+    if (tc_kernel_supported(TcKernel::Avx2))
+        return TcKernel::Avx2;
+    return TcKernel::Scalar;
+}
+
+bool tc_kernel_supported(TcKernel kernel)
+{
+    switch (kernel)
+    {
+    case TcKernel::Auto:
+    case TcKernel::Scalar:
+        return true;
+#ifdef TC_X86_KERNELS
+    case TcKernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case TcKernel::Avx512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *tc_kernel_name(TcKernel kernel)
+{
+    switch (kernel)
+    {
+    case TcKernel::Auto:
+        return "auto";
+    case TcKernel::Scalar:
+        return "scalar";
+    case TcKernel::Avx2:
+        return "avx2";
+    case TcKernel::Avx512:
+        return "avx512";
+    }
+    return "?";
+}
@@ -0,0 +1,82 @@
+#ifndef TRIANGLES_HPP
+#define TRIANGLES_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/compressed_graph.hpp"
+#include "../common/graph_cache.h"
+
+//--------------------------------------------------------------------
+// Native parallel triangle counter.
+//
+// The graph is symmetrized (pattern of A + A', self loops dropped, as
+// build_sandia_matrix and LAGraph do), vertices are relabelled by
+// ascending (degree, id) and every edge is kept only from its lower to
+// its higher rank. In that DAG each triangle is found exactly once, as
+// the intersection of the out-lists of the two ends of its lowest edge,
+// and no out-list is longer than sqrt(2m).
+//
+// Out-lists are intersected with AVX-512 / AVX2 block merges chosen at
+// run time (scalar merge elsewhere, binary search for very unequal
+// lengths). Rows with a long out-list mark it in a per-thread bitmap
+// instead, so each neighbour list is scanned once against it. Rows are
+// handed out dynamically in chunks holding about the same number of
+// DAG edges, which keeps the threads busy on skewed graph500 degrees.
+//--------------------------------------------------------------------
+
+// Degree-ordered DAG, vertices numbered by rank. Index is uint32_t
+// (TcGraph) or uint64_t; the block merges only exist for 32-bit ids,
+// 64-bit graphs intersect with the scalar merge and the bitmap.
+template <typename Index>
+struct BasicTcGraph
+{
+    Index n = 0;
+    std::vector<std::uint64_t> row_ptr; // n + 1
+    std::vector<Index> col;             // ascending inside every row
+    std::vector<Index> order;           // original id of every rank
+};
+
+using TcGraph = BasicTcGraph<std::uint32_t>;
+
+enum class TcKernel
+{
+    Auto, // widest kernel the CPU supports
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+struct TcOptions
+{
+    TcKernel kernel = TcKernel::Auto;
+    std::uint32_t bitmap_degree = 32;  // out-lists at least this long use the bitmap
+    unsigned nthreads = 0;             // 0: $GRAPH_THREADS or the number of cores
+};
+
+// Whole graph of the cache, vertices [0, max(n, max_index + 1)); throws
+// std::runtime_error if they do not fit Index
+template <typename Index = std::uint32_t>
+BasicTcGraph<Index> tc_graph_from_cache(const GraphCache &cache, unsigned nthreads = 0);
+
+template <typename Index>
+std::uint64_t tc_count(const BasicTcGraph<Index> &graph, const TcOptions &options = {});
+
+// Degree-ordered DAG of an undirected compressed graph (as built from a
+// cache), itself compressed and unweighted; built in blocks of ranks so
+// the uncompressed DAG is never held whole
+CompressedGraph tc_compressed_dag(const CompressedGraph &graph, unsigned nthreads = 0);
+
+// tc_count over a compressed DAG, decoding the out-lists as it goes
+std::uint64_t tc_count_compressed(const CompressedGraph &dag, const TcOptions &options = {});
+
+// |a ∩ b| of two strictly ascending lists with the kernel of tc_count
+std::uint64_t tc_intersect(const std::uint32_t *a, std::size_t na, const std::uint32_t *b, std::size_t nb,
+                           TcKernel kernel = TcKernel::Auto);
+
+// Auto resolved to a concrete kernel; false if the CPU lacks it
+TcKernel tc_kernel_resolve(TcKernel kernel);
+bool tc_kernel_supported(TcKernel kernel);
+const char *tc_kernel_name(TcKernel kernel);
+
+#endif // TRIANGLES_HPP
@@ -0,0 +1,96 @@
+#include "graph_bench.hpp"
+
+#include <functional>
+
+#include "../Sandia/triangles.hpp"
+#include "../common/graph_types.hpp"
+#include "../prim/boruvka.hpp"
+#include "../prim/component_mst.hpp"
+#include "../prim/pregel_boruvka.hpp"
+
+namespace
+{
+    // Both runs stage the graph in the narrowest id and weight types that
+    // hold it exactly (common/graph_types.hpp); the scan is part of build
+    class NativeBoruvka : public BenchRun
+    {
+    public:
+        enum class Mode
+        {
+            Edges,      // boruvka_mst
+            Components, // label the components first and run component_mst
+            Pregel,     // vertex program on the BSP engine
+        };
+
+        explicit NativeBoruvka(Mode mode)
+            : m_mode(mode)
+        {
+        }
+
+        void build(const GraphCache &cache, std::uint64_t cap) override
+        {
+            std::uint64_t n = cache.header.n;
+            if (cap > 0 && cap < n)
+                n = cap;
+            const GraphTypes types = graph_types_scan(cache).narrowest;
+            m_compute = graph_types_dispatch(types, [&](auto index, auto weight) -> std::function<double()>
+                                             {
+                using Index = decltype(index);
+                using Weight = decltype(weight);
+                auto edges = std::make_shared<BasicMstEdges<Index, Weight>>(
+                    mst_edges_from_cache<Index, Weight>(cache, n));
+                if (m_mode == Mode::Components)
+                    return [edges] { return component_mst(*edges).forest.weight; };
+                if (m_mode == Mode::Pregel)
+                    return [edges] { return pregel_boruvka_mst(*edges).forest.weight; };
+                return [edges] { return boruvka_mst(*edges).weight; }; });
+        }
+
+        double compute() override
+        {
+            return m_compute();
+        }
+
+    private:
+        Mode m_mode;
+        std::function<double()> m_compute;
+    };
+
+    class NativeTriangles : public BenchRun
+    {
+    public:
+        // Like the library backends, always the whole graph
+        void build(const GraphCache &cache, std::uint64_t) override
+        {
+            if (graph_index_type(cache) == IndexType::U64)
+            {
+                auto graph = std::make_shared<BasicTcGraph<std::uint64_t>>(tc_graph_from_cache<std::uint64_t>(cache));
+                m_compute = [graph] { return static_cast<double>(tc_count(*graph)); };
+                return;
+            }
+            auto graph = std::make_shared<TcGraph>(tc_graph_from_cache(cache));
+            m_compute = [graph] { return static_cast<double>(tc_count(*graph)); };
+        }
+
+        double compute() override
+        {
+            return m_compute();
+        }
+
+    private:
+        std::function<double()> m_compute;
+    };
+}
+
+std::unique_ptr<BenchRun> make_native_run(const std::string &algorithm)
+{
+    if (algorithm == "boruvka" || algorithm == "mst")
+        return std::make_unique<NativeBoruvka>(NativeBoruvka::Mode::Edges);
+    if (algorithm == "msf")
+        return std::make_unique<NativeBoruvka>(NativeBoruvka::Mode::Components);
+    if (algorithm == "pregel")
+        return std::make_unique<NativeBoruvka>(NativeBoruvka::Mode::Pregel);
+    if (algorithm == "tc")
+        return std::make_unique<NativeTriangles>();
+    return nullptr;
+}
@@ -0,0 +1,49 @@
+#include "graph_bench.hpp"
+
+#include "../prim/prim_spla.hpp"
+#include "../Sandia/sandia_spla.hpp"
+
+namespace
+{
+    class SplaPrim : public BenchRun
+    {
+    public:
+        void build(const GraphCache &cache, std::uint64_t cap) override
+        {
+            if (cache.header.flags & GRAPH_CACHE_DIMACS)
+                build_graph_dimacs(cache, static_cast<int>(cap > 0 ? cap : cache.header.nnz));
+            else
+                build_graph_mm(cache, static_cast<int>(cap > 0 && cap < cache.header.n ? cap : cache.header.n));
+        }
+
+        double compute() override
+        {
+            compute_internal();
+            return mst_weight();
+        }
+    };
+
+    class SplaTriangles : public BenchRun
+    {
+    public:
+        // spla::tc always runs on the whole graph
+        void build(const GraphCache &cache, std::uint64_t) override
+        {
+            build_graph_sandia(cache);
+        }
+
+        double compute() override
+        {
+            return triangle_count();
+        }
+    };
+}
+
+std::unique_ptr<BenchRun> make_spla_run(const std::string &algorithm)
+{
+    if (algorithm == "prim" || algorithm == "mst")
+        return std::make_unique<SplaPrim>();
+    if (algorithm == "tc")
+        return std::make_unique<SplaTriangles>();
+    return nullptr;
+}
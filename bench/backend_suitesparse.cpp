@@ -0,0 +1,97 @@
+#include "graph_bench.hpp"
+
+#include <stdexcept>
+
+#include "../common/mem_accounting.h"
+#include "../prim/prim_SuiteSparse.h"
+#include "../Sandia/sandia_SuiteSparse.h"
+
+namespace
+{
+    void check(int info, const char *what)
+    {
+        if (info != GrB_SUCCESS)
+            throw std::runtime_error(std::string(what) + " failed (" + std::to_string(info) + ")");
+    }
+
+    // LAGr_Init also initializes GraphBLAS, with the counting allocators
+    // so that --mem sees its memory; one instance per process
+    class SuiteSparseRun : public BenchRun
+    {
+    public:
+        SuiteSparseRun()
+        {
+            check(LAGr_Init(GrB_NONBLOCKING, graph_mem_malloc, graph_mem_calloc, graph_mem_realloc,
+                            graph_mem_free, m_msg),
+                  "LAGr_Init");
+        }
+        ~SuiteSparseRun() override { LAGraph_Finalize(m_msg); }
+
+    protected:
+        char m_msg[LAGRAPH_MSG_LEN] = {};
+    };
+
+    class SuiteSparsePrim : public SuiteSparseRun
+    {
+    public:
+        ~SuiteSparsePrim() override { release(); }
+
+        void build(const GraphCache &cache, std::uint64_t cap) override
+        {
+            release();
+            if (cache.header.flags & GRAPH_CACHE_DIMACS)
+                check(build_dimacs_lim(&cache, cap > 0 ? cap : cache.header.nnz, GrB_MIN_FP64, &m_graph, &m_parents),
+                      "build_dimacs_lim");
+            else
+                check(build_matrix_mm_lim(&cache, cap, GrB_MIN_FP64, &m_graph, &m_parents), "build_matrix_mm_lim");
+        }
+
+        double compute() override
+        {
+            return mst_prim(m_graph, m_parents);
+        }
+
+    private:
+        void release()
+        {
+            GrB_Matrix_free(&m_graph);
+            GrB_Vector_free(&m_parents);
+        }
+
+        GrB_Matrix m_graph = nullptr;
+        GrB_Vector m_parents = nullptr;
+    };
+
+    class SuiteSparseTriangles : public SuiteSparseRun
+    {
+    public:
+        ~SuiteSparseTriangles() override { LAGraph_Delete(&m_graph, m_msg); }
+
+        // LAGr_TriangleCount always runs on the whole graph
+        void build(const GraphCache &cache, std::uint64_t) override
+        {
+            LAGraph_Delete(&m_graph, m_msg);
+            GrB_Matrix A = build_sandia_matrix(&cache);
+            check(sandia_prepare_graph(&m_graph, &A, m_msg), "sandia_prepare_graph");
+        }
+
+        double compute() override
+        {
+            std::uint64_t ntri = 0;
+            check(sandia_triangle_count(&ntri, m_graph, m_msg), "sandia_triangle_count");
+            return static_cast<double>(ntri);
+        }
+
+    private:
+        LAGraph_Graph m_graph = nullptr;
+    };
+}
+
+std::unique_ptr<BenchRun> make_suitesparse_run(const std::string &algorithm)
+{
+    if (algorithm == "prim" || algorithm == "mst")
+        return std::make_unique<SuiteSparsePrim>();
+    if (algorithm == "tc")
+        return std::make_unique<SuiteSparseTriangles>();
+    return nullptr;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+#include "../prim/boruvka.hpp"
+#include "../prim/pregel_boruvka.hpp"
+
+// Vertex-centric Borůvka on the shared-memory BSP engine next to the
+// edge-parallel boruvka_mst, on the same edge list. Prints every
+// superstep of the Pregel run with its time, active vertices and
+// message volume (sent, handed over after sender-side combining,
+// delivered after receiver-side combining), the totals per phase, and
+// checks the forest weight and size against boruvka_mst.
+//
+// Usage: boruvka_pregel <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0] [threads=0] [batch=1024] [quiet=0]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0] [threads=0] [batch=1024] [quiet=0]\n";
+        return 1;
+    }
+    const std::uint64_t max_vertices = argc > 2 ? std::stoull(argv[2]) : 0;
+    PregelOptions options;
+    options.nthreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+    options.batch = argc > 4 ? std::stoull(argv[4]) : 1024;
+    const bool quiet = argc > 5 && std::stoi(argv[5]) != 0;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    std::uint64_t n = graph_cache_vertices(&cache);
+    if (max_vertices > 0 && max_vertices < n)
+        n = max_vertices;
+    const MstEdges edges = mst_edges_from_cache(cache, n);
+    graph_cache_close(&cache);
+    std::cout << "vertices=" << edges.n << " edges=" << edges.u.size() << "\n";
+
+    auto start = clock_::now();
+    const PregelMst pregel = pregel_boruvka_mst(edges, options);
+    const double pregel_ms = ms_since(start);
+    start = clock_::now();
+    const MstResult native = boruvka_mst(edges, options.nthreads);
+    const double native_ms = ms_since(start);
+
+    struct Total
+    {
+        const char *phase;
+        std::uint64_t supersteps = 0;
+        double ms = 0.0;
+        std::uint64_t sent = 0, transferred = 0, delivered = 0;
+    };
+    std::vector<Total> totals;
+    Total all{"total"};
+    if (!quiet)
+        std::cout << "superstep phase        ms       active         sent  transferred    delivered\n";
+    for (std::size_t s = 0; s < pregel.supersteps.size(); s++)
+    {
+        const PregelSuperstep &step = pregel.supersteps[s];
+        if (!quiet)
+        {
+            std::ostringstream row;
+            row << std::setw(9) << s << " " << std::left << std::setw(9) << step.phase << std::right << std::setw(9)
+                << std::fixed << std::setprecision(2) << step.ms << std::setw(13) << step.active << std::setw(13)
+                << step.sent << std::setw(13) << step.transferred << std::setw(13) << step.delivered << "\n";
+            std::cout << row.str();
+        }
+        auto it = std::find_if(totals.begin(), totals.end(), [&](const Total &t)
+                               { return std::string(t.phase) == step.phase; });
+        if (it == totals.end())
+            it = totals.insert(totals.end(), Total{step.phase});
+        for (Total *t : {&*it, &all})
+        {
+            t->supersteps++;
+            t->ms += step.ms;
+            t->sent += step.sent;
+            t->transferred += step.transferred;
+            t->delivered += step.delivered;
+        }
+    }
+    totals.push_back(all);
+    for (const Total &t : totals)
+        std::cout << std::left << std::setw(9) << t.phase << std::right << " supersteps=" << t.supersteps
+                  << " ms=" << t.ms << " sent=" << t.sent << " transferred=" << t.transferred
+                  << " delivered=" << t.delivered << "\n";
+
+    const bool ok = std::abs(pregel.forest.weight - native.weight) <= 1e-9 * std::max(1.0, native.weight) &&
+                    pregel.forest.tree_edges == native.tree_edges;
+    std::cout << "pregel " << pregel_ms << " ms (" << pregel.forest.rounds << " rounds, " << pregel.supersteps.size()
+              << " supersteps), weight " << pregel.forest.weight << ", tree edges " << pregel.forest.tree_edges
+              << "; boruvka " << native_ms << " ms (" << native.rounds << " rounds), weight " << native.weight
+              << ", tree edges " << native.tree_edges << (ok ? "" : "  MISMATCH") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/bitset.hpp"
+#include "../common/graph_cache.h"
+#include "../common/indexed_heap.hpp"
+#include "../prim/boruvka.hpp"
+
+// Thread scaling of the native Borůvka engine against a sequential Prim
+// over the same edges (the heap-based frontier of prim_spla, without the
+// SPLA calls). Both must report the same forest weight.
+//
+// Usage: boruvka_scaling <graph.mtx|graph.gr> [max_vertices] [max_threads] [reps]
+
+using clock_ = std::chrono::steady_clock;
+
+static double prim_forest_weight(const MstEdges &edges)
+{
+    const std::uint32_t n = edges.n;
+    std::vector<std::uint64_t> offset(n + 1, 0);
+    for (std::size_t e = 0; e < edges.u.size(); e++)
+    {
+        offset[edges.u[e] + 1]++;
+        offset[edges.v[e] + 1]++;
+    }
+    for (std::uint32_t i = 0; i < n; i++)
+        offset[i + 1] += offset[i];
+    std::vector<std::uint32_t> adj(offset[n]);
+    std::vector<double> adj_w(offset[n]);
+    std::vector<std::uint64_t> fill(offset.begin(), offset.end() - 1);
+    for (std::size_t e = 0; e < edges.u.size(); e++)
+    {
+        adj[fill[edges.u[e]]] = edges.v[e];
+        adj_w[fill[edges.u[e]]++] = edges.w[e];
+        adj[fill[edges.v[e]]] = edges.u[e];
+        adj_w[fill[edges.v[e]]++] = edges.w[e];
+    }
+
+    double weight = 0.0;
+    IndexedDaryHeap<double> heap(n);
+    DenseBitset visited(n);
+    for (std::uint32_t root = 0; root < n; root++)
+    {
+        if (visited.test(root))
+            continue;
+        heap.push_or_decrease(root, 0.0);
+        while (!heap.empty())
+        {
+            auto [w, v] = heap.pop();
+            visited.set(v);
+            weight += w;
+            for (std::uint64_t k = offset[v]; k < offset[v + 1]; k++)
+                if (!visited.test(adj[k]))
+                    heap.push_or_decrease(adj[k], adj_w[k]);
+        }
+    }
+    return weight;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.mtx|graph.gr> [max_vertices] [max_threads] [reps]\n";
+        return 1;
+    }
+
+    GraphCache cache;
+    if (graph_cache_load(argv[1], &cache) != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    std::uint64_t cap = argc > 2 ? std::stoull(argv[2]) : 0;
+    unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+    int reps = argc > 4 ? std::stoi(argv[4]) : 3;
+
+    auto n = static_cast<std::uint32_t>(cap > 0 ? std::min<std::uint64_t>(cap, cache.header.n) : cache.header.n);
+    MstEdges edges = mst_edges_from_cache(cache, n);
+    graph_cache_close(&cache);
+    std::cout << "vertices=" << n << " edges=" << edges.u.size() << "\n";
+
+    auto start = clock_::now();
+    double prim_weight = prim_forest_weight(edges);
+    double prim_ms = std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    std::cout << "prim (sequential)  " << prim_ms << " ms, weight " << prim_weight << "\n";
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned t : thread_counts)
+    {
+        std::vector<double> times;
+        MstResult result;
+        for (int r = 0; r < reps; r++)
+        {
+            start = clock_::now();
+            result = boruvka_mst(edges, t);
+            times.push_back(std::chrono::duration<double, std::milli>(clock_::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        double ms = times[times.size() / 2];
+        std::cout << "boruvka threads=" << t << " " << ms << " ms (x" << prim_ms / ms << " vs prim), weight "
+                  << result.weight << ", rounds " << result.rounds << ", tree edges " << result.tree_edges
+                  << (std::abs(result.weight - prim_weight) <= 1e-9 * std::max(1.0, prim_weight) ? "" : "  WEIGHT MISMATCH") << "\n";
+    }
+
+    return 0;
+}
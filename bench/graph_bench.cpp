@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "graph_bench.hpp"
+#include "../common/mem_accounting.h"
+#include "../common/perf_counters.h"
+#include "../common/reorder.hpp"
+#include "../common/rmat.hpp"
+
+// Unified benchmark driver: one dataset, one algorithm on one backend,
+// `warmup` untimed repetitions followed by `reps` timed ones. Every
+// repetition loads the graph cache, builds the backend graph and runs
+// the algorithm; the three phases are timed separately and summarised
+// as min / median / p95 in nanoseconds. With --perf on, each phase is
+// also wrapped in a hardware counter group and the median counts are
+// reported next to the timings. With --mem on, each phase also reports
+// its peak counted heap bytes and resident high-water mark (maximum over
+// all repetitions, warmup included: the first load may parse the text),
+// plus the bytes it left allocated and its allocation count.
+//
+// A dataset of the form rmat:<scale>[:<edge_factor>[:<seed>]] is
+// generated in memory by the load phase instead of being read from disk.
+// With --order other than original, the reorder phase computes the
+// vertex order of the loaded graph and permutes its CSR before build;
+// the scalar results do not depend on the vertex ids.
+//
+// The default algorithm mst is the minimum spanning tree of each backend
+// (Borůvka on native, Prim on the GraphBLAS ones), so --backend alone
+// always names a valid pair.
+//
+// Usage: graph_bench --dataset <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [--algorithm mst|prim|tc|boruvka|msf|pregel]
+//                    [--backend native|spla|suitesparse|gbtl] [--cap N] [--order original|degree|rcm|community]
+//                    [--warmup N] [--reps N] [--format json|csv] [--output file]
+//                    [--perf on|off] [--mem on|off]
+
+using clock_ = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options
+    {
+        std::string dataset;
+        std::string algorithm = "mst";
+        std::string backend = "native";
+        std::uint64_t cap = 0;
+        VertexOrder order = VertexOrder::Original;
+        int warmup = 1;
+        int reps = 5;
+        std::string format = "json";
+        std::string output;
+        bool perf = false;
+        bool mem = false;
+    };
+
+    struct Probes
+    {
+        PerfCounters perf;
+        bool mem = false;
+    };
+
+    // Samples of one phase over the timed repetitions
+    struct Phase
+    {
+        std::vector<std::uint64_t> ns;
+        std::vector<std::uint64_t> counters[PERF_NCOUNTERS];
+        bool has_mem = false;
+        std::int64_t peak_live = 0;
+        std::int64_t peak_rss_kb = 0;
+        std::int64_t retained = 0; // last repetition
+        std::uint64_t allocs = 0;  // last repetition
+    };
+
+    struct Summary
+    {
+        std::uint64_t min = 0;
+        std::uint64_t median = 0;
+        std::uint64_t p95 = 0;
+        // Median over the repetitions, when the counter was read in all of them
+        std::uint64_t counters[PERF_NCOUNTERS] = {};
+        bool has_counter[PERF_NCOUNTERS] = {};
+        bool has_mem = false;
+        std::int64_t peak_live = 0;
+        std::int64_t peak_rss_kb = 0;
+        std::int64_t retained = 0;
+        std::uint64_t allocs = 0;
+    };
+
+    const char *const PHASES[] = {"load", "reorder", "build", "compute"};
+    constexpr int NPHASES = 4;
+
+    void usage(const char *prog)
+    {
+        std::cerr << "Usage: " << prog
+                  << " --dataset <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [--algorithm mst|prim|tc|boruvka|msf|pregel]"
+                     " [--backend native|spla|suitesparse|gbtl] [--cap N] [--order original|degree|rcm|community]"
+                     " [--warmup N] [--reps N]"
+                     " [--format json|csv] [--output file] [--perf on|off] [--mem on|off]\n";
+    }
+
+    Options parse_options(int argc, char **argv)
+    {
+        Options opt;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+                throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--dataset")
+                opt.dataset = value;
+            else if (arg == "--algorithm")
+                opt.algorithm = value;
+            else if (arg == "--backend")
+                opt.backend = value;
+            else if (arg == "--cap")
+                opt.cap = std::stoull(value);
+            else if (arg == "--order")
+            {
+                if (!vertex_order_parse(value, opt.order))
+                    throw std::invalid_argument("--order must be original, degree, rcm or community");
+            }
+            else if (arg == "--warmup")
+                opt.warmup = std::stoi(value);
+            else if (arg == "--reps")
+                opt.reps = std::stoi(value);
+            else if (arg == "--format")
+                opt.format = value;
+            else if (arg == "--output")
+                opt.output = value;
+            else if (arg == "--perf")
+                opt.perf = (value == "on" || value == "1");
+            else if (arg == "--mem")
+                opt.mem = (value == "on" || value == "1");
+            else
+                throw std::invalid_argument("unknown option " + arg);
+        }
+        if (opt.dataset.empty())
+            throw std::invalid_argument("--dataset is required");
+        if (opt.reps < 1 || opt.warmup < 0)
+            throw std::invalid_argument("--reps must be positive and --warmup non-negative");
+        // The cap keeps leading vertices, which would be a different
+        // subgraph after renumbering
+        if (opt.cap > 0 && opt.order != VertexOrder::Original)
+            throw std::invalid_argument("--cap cannot be combined with --order");
+        if (opt.format != "json" && opt.format != "csv")
+            throw std::invalid_argument("--format must be json or csv");
+        return opt;
+    }
+
+    std::unique_ptr<BenchRun> make_run(const Options &opt)
+    {
+        std::unique_ptr<BenchRun> run;
+        if (opt.backend == "native")
+            run = make_native_run(opt.algorithm);
+#ifdef GRAPH_BENCH_WITH_SPLA
+        else if (opt.backend == "spla")
+            run = make_spla_run(opt.algorithm);
+#endif
+#ifdef GRAPH_BENCH_WITH_SUITESPARSE
+        else if (opt.backend == "suitesparse")
+            run = make_suitesparse_run(opt.algorithm);
+#endif
+        else if (opt.backend == "gbtl")
+            throw std::invalid_argument("the gbtl backend needs the gbtl submodule, which is not part of this tree");
+        else
+            throw std::invalid_argument("backend " + opt.backend + " is unknown or was not built");
+
+        if (!run)
+            throw std::invalid_argument("backend " + opt.backend + " has no " + opt.algorithm + " implementation");
+        return run;
+    }
+
+    // Nearest-rank percentile of sorted samples
+    std::uint64_t percentile(const std::vector<std::uint64_t> &sorted, double p)
+    {
+        std::size_t r = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::max<std::size_t>(r, 1) - 1];
+    }
+
+    Summary summarize(Phase phase)
+    {
+        Summary s;
+        std::sort(phase.ns.begin(), phase.ns.end());
+        s.min = phase.ns.front();
+        s.median = percentile(phase.ns, 0.5);
+        s.p95 = percentile(phase.ns, 0.95);
+        for (int c = 0; c < PERF_NCOUNTERS; c++)
+        {
+            auto &values = phase.counters[c];
+            if (values.empty() || values.size() != phase.ns.size())
+                continue;
+            std::sort(values.begin(), values.end());
+            s.counters[c] = percentile(values, 0.5);
+            s.has_counter[c] = true;
+        }
+        s.has_mem = phase.has_mem;
+        s.peak_live = phase.peak_live;
+        s.peak_rss_kb = phase.peak_rss_kb;
+        s.retained = phase.retained;
+        s.allocs = phase.allocs;
+        return s;
+    }
+
+    std::uint64_t elapsed_ns(clock_::time_point start)
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock_::now() - start).count());
+    }
+
+    // Runs f as one phase: probes around the timed region, so their
+    // syscalls are not part of the timing. Warmup repetitions only feed
+    // the memory peaks.
+    template <typename F>
+    void measure(Probes &probes, Phase &phase, bool timed, F &&f)
+    {
+        GraphMemPhase mem;
+        if (probes.mem)
+            graph_mem_phase_begin(&mem);
+        perf_counters_start(&probes.perf);
+        auto start = clock_::now();
+        f();
+        std::uint64_t ns = elapsed_ns(start);
+        PerfSample sample;
+        perf_counters_stop(&probes.perf, &sample);
+
+        if (probes.mem)
+        {
+            graph_mem_phase_end(&mem);
+            phase.has_mem = true;
+            phase.peak_live = std::max(phase.peak_live, mem.live_peak);
+            phase.peak_rss_kb = std::max(phase.peak_rss_kb, mem.rss_hwm_kb);
+            phase.retained = mem.live_end - mem.live_start;
+            phase.allocs = mem.allocs;
+        }
+        if (!timed)
+            return;
+        phase.ns.push_back(ns);
+        for (int c = 0; c < PERF_NCOUNTERS; c++)
+            if (sample.valid[c])
+                phase.counters[c].push_back(sample.value[c]);
+    }
+
+    std::string json_string(const std::string &s)
+    {
+        std::string out = "\"";
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    void write_json(std::ostream &os, const Options &opt, const GraphCacheHeader &graph, double result,
+                    const Summary (&phases)[NPHASES])
+    {
+        os << "{\n"
+           << "  \"dataset\": " << json_string(opt.dataset) << ",\n"
+           << "  \"algorithm\": " << json_string(opt.algorithm) << ",\n"
+           << "  \"backend\": " << json_string(opt.backend) << ",\n"
+           << "  \"cap\": " << opt.cap << ",\n"
+           << "  \"order\": \"" << vertex_order_name(opt.order) << "\",\n"
+           << "  \"vertices\": " << graph.n << ",\n"
+           << "  \"entries\": " << graph.nnz << ",\n"
+           << "  \"warmup\": " << opt.warmup << ",\n"
+           << "  \"reps\": " << opt.reps << ",\n"
+           << "  \"result\": " << result << ",\n"
+           << "  \"phases\": {\n";
+        for (int p = 0; p < NPHASES; p++)
+        {
+            os << "    \"" << PHASES[p] << "\": {\"min_ns\": " << phases[p].min
+               << ", \"median_ns\": " << phases[p].median
+               << ", \"p95_ns\": " << phases[p].p95;
+            for (int c = 0; c < PERF_NCOUNTERS; c++)
+                if (phases[p].has_counter[c])
+                    os << ", \"" << perf_counter_name(c) << "\": " << phases[p].counters[c];
+            if (phases[p].has_mem)
+                os << ", \"peak_live_bytes\": " << phases[p].peak_live
+                   << ", \"peak_rss_kb\": " << phases[p].peak_rss_kb
+                   << ", \"retained_bytes\": " << phases[p].retained
+                   << ", \"allocs\": " << phases[p].allocs;
+            os << "}" << (p + 1 < NPHASES ? ",\n" : "\n");
+        }
+        os << "  }\n}\n";
+    }
+
+    void write_csv(std::ostream &os, const Options &opt, const GraphCacheHeader &graph, double result,
+                   const Summary (&phases)[NPHASES])
+    {
+        os << "dataset,algorithm,backend,cap,order,vertices,entries,warmup,reps,result,phase,min_ns,median_ns,p95_ns";
+        for (int c = 0; c < PERF_NCOUNTERS; c++)
+            os << "," << perf_counter_name(c);
+        os << ",peak_live_bytes,peak_rss_kb,retained_bytes,allocs\n";
+        for (int p = 0; p < NPHASES; p++)
+        {
+            os << opt.dataset << "," << opt.algorithm << "," << opt.backend << "," << opt.cap << ","
+               << vertex_order_name(opt.order) << ","
+               << graph.n << "," << graph.nnz << "," << opt.warmup << "," << opt.reps << ","
+               << result << "," << PHASES[p] << "," << phases[p].min << ","
+               << phases[p].median << "," << phases[p].p95;
+            // Empty when the counter was unavailable
+            for (int c = 0; c < PERF_NCOUNTERS; c++)
+            {
+                os << ",";
+                if (phases[p].has_counter[c])
+                    os << phases[p].counters[c];
+            }
+            if (phases[p].has_mem)
+                os << "," << phases[p].peak_live << "," << phases[p].peak_rss_kb << ","
+                   << phases[p].retained << "," << phases[p].allocs << "\n";
+            else
+                os << ",,,,\n";
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::unique_ptr<BenchRun> run;
+    Probes probes;
+    PerfCounters &perf = probes.perf;
+    perf_counters_open(&perf);
+    try
+    {
+        opt = parse_options(argc, argv);
+        // Counters are opened before the backend starts any threads, so
+        // the library thread pools inherit them
+        if (!opt.perf)
+            perf_counters_close(&perf);
+        else if (!perf.available)
+            std::cerr << "Warning: hardware counters unavailable, timing only (" << perf.reason << ")\n";
+        probes.mem = opt.mem;
+        if (opt.mem && !graph_mem_all_allocations())
+            std::cerr << "Warning: malloc is not hooked (GRAPH_MEM_HOOKS), live bytes cover GraphBLAS only\n";
+        run = make_run(opt);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    Phase samples[NPHASES];
+    GraphCacheHeader graph{};
+    double result = 0.0;
+    try
+    {
+        // Backends log to std::cout; keep stdout for the report
+        std::streambuf *report = std::cout.rdbuf(std::cerr.rdbuf());
+        struct RestoreCout
+        {
+            std::streambuf *buf;
+            ~RestoreCout() { std::cout.rdbuf(buf); }
+        } restore{report};
+
+        RmatParams rmat;
+        const bool generated = rmat_parse_spec(opt.dataset, rmat);
+
+        // The first load of a new dataset parses the text file and writes
+        // the cache; use --warmup to keep that out of the statistics
+        for (int rep = 0; rep < opt.warmup + opt.reps; rep++)
+        {
+            const bool timed = rep >= opt.warmup;
+
+            GraphCache cache;
+            int status = 0;
+            measure(probes, samples[0], timed, [&]
+                    { status = generated ? rmat_generate(rmat, &cache)
+                                         : graph_cache_load(opt.dataset.c_str(), &cache); });
+            if (status != 0)
+                throw std::runtime_error("cannot open file " + opt.dataset);
+            graph = cache.header;
+
+            measure(probes, samples[1], timed, [&]
+                    {
+                if (opt.order == VertexOrder::Original)
+                    return;
+                GraphCache permuted;
+                status = reorder_apply(cache, reorder_compute(cache, opt.order), &permuted);
+                graph_cache_close(&cache);
+                cache = permuted; });
+            if (status != 0)
+                throw std::runtime_error("cannot reorder " + opt.dataset);
+
+            measure(probes, samples[2], timed, [&]
+                    { run->build(cache, opt.cap); });
+            graph_cache_close(&cache);
+
+            double value = 0.0;
+            measure(probes, samples[3], timed, [&]
+                    { value = run->compute(); });
+
+            if (rep > 0 && value != result)
+                std::cerr << "Warning: repetition " << rep << " returned " << value
+                          << ", previous " << result << "\n";
+            result = value;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    Summary phases[NPHASES];
+    for (int p = 0; p < NPHASES; p++)
+        phases[p] = summarize(samples[p]);
+    perf_counters_close(&perf);
+
+    std::ofstream file;
+    if (!opt.output.empty())
+    {
+        file.open(opt.output);
+        if (!file)
+        {
+            std::cerr << "Error: cannot write " << opt.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream &os = opt.output.empty() ? std::cout : file;
+    os.precision(17);
+    if (opt.format == "json")
+        write_json(os, opt, graph, result, phases);
+    else
+        write_csv(os, opt, graph, result, phases);
+    return 0;
+}
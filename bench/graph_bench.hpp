@@ -0,0 +1,39 @@
+#ifndef GRAPH_BENCH_HPP
+#define GRAPH_BENCH_HPP
+
+#include <memory>
+#include <string>
+
+#include "../common/graph_cache.h"
+
+//--------------------------------------------------------------------
+// Backend adapters of the graph_bench driver.
+//
+// One BenchRun is created per invocation and reused for every
+// repetition: build() turns a freshly loaded cache into the backend's
+// own graph (replacing the previous one), compute() runs the algorithm
+// on it and returns its scalar result (forest weight or triangle count)
+// so that repetitions and backends can be cross-checked.
+//--------------------------------------------------------------------
+
+class BenchRun
+{
+public:
+    virtual ~BenchRun() = default;
+
+    // cap limits the graph as the stand-alone drivers do: leading vertices
+    // for MatrixMarket input, leading arcs for DIMACS; 0 keeps everything
+    virtual void build(const GraphCache &cache, std::uint64_t cap) = 0;
+    virtual double compute() = 0;
+};
+
+// Each returns nullptr when the backend does not implement the algorithm
+std::unique_ptr<BenchRun> make_native_run(const std::string &algorithm);
+#ifdef GRAPH_BENCH_WITH_SPLA
+std::unique_ptr<BenchRun> make_spla_run(const std::string &algorithm);
+#endif
+#ifdef GRAPH_BENCH_WITH_SUITESPARSE
+std::unique_ptr<BenchRun> make_suitesparse_run(const std::string &algorithm);
+#endif
+
+#endif // GRAPH_BENCH_HPP
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Sandia/triangles.hpp"
+#include "../common/compressed_graph.hpp"
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+#include "../prim/boruvka.hpp"
+#include "../prim/compressed_prim.hpp"
+
+// Size and speed of the compressed adjacency store. Reports the bytes
+// per entry against the CSR cache (8-byte columns, 8-byte weights) and
+// the 24-byte staging entries of the loaders, the decode throughput of
+// the scalar and SIMD decoders, and runs Prim and the triangle count
+// straight from the compressed form next to Borůvka and tc_count on the
+// uncompressed graph.
+//
+// Usage: graph_compress <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [weight_bits=0] [threads=0]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [weight_bits=0] [threads=0]\n";
+        return 1;
+    }
+    CompressedGraphOptions options;
+    options.weight_bits = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 0;
+    options.nthreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+
+    auto start = clock_::now();
+    CompressedGraph g(cache, options);
+    double build_ms = ms_since(start);
+    const double entries = static_cast<double>(g.entries());
+    const double csr_bytes = 8.0 * (cache.header.n + 1) + (cache.weights ? 16.0 : 8.0) * cache.header.nnz;
+    std::cout << "vertices=" << g.n() << " entries=" << g.entries() << " (both directions), weights "
+              << CompressedGraph::coding_name(g.coding()) << ", build " << build_ms << " ms\n"
+              << "compressed " << g.bytes() / 1048576.0 << " MB, " << g.bytes() / entries
+              << " bytes/entry; cache " << csr_bytes / 1048576.0 << " MB, "
+              << csr_bytes / static_cast<double>(cache.header.nnz) << " bytes/entry; staging 24 bytes/entry\n";
+
+    // Decode throughput over all rows
+    std::vector<std::uint32_t> buffer;
+    for (bool simd : {false, true})
+    {
+        if (simd && !CompressedGraph::simd_supported())
+            continue;
+        std::uint64_t checksum = 0;
+        start = clock_::now();
+        for (std::uint32_t v = 0; v < g.n(); v++)
+        {
+            buffer.resize(g.degree(v) + 3);
+            g.neighbors(v, buffer.data(), simd);
+            for (std::uint32_t k = 0; k < g.degree(v); k++)
+                checksum += buffer[k];
+        }
+        double ms = ms_since(start);
+        std::cout << (simd ? "decode simd   " : "decode scalar ") << ms << " ms, " << entries / ms / 1e6
+                  << " G entries/s (checksum " << checksum << ")\n";
+    }
+
+    bool ok = true;
+    MstEdges edges = mst_edges_from_cache(cache, g.n());
+    start = clock_::now();
+    MstResult full = boruvka_mst(edges, options.nthreads);
+    double boruvka_ms = ms_since(start);
+    start = clock_::now();
+    MstResult compressed = prim_compressed(g);
+    double prim_ms = ms_since(start);
+    bool mst_match = std::abs(full.weight - compressed.weight) <= 1e-9 * std::max(1.0, full.weight) &&
+                     full.tree_edges == compressed.tree_edges;
+    // Quantized weights give a different (approximate) forest weight
+    ok = ok && (mst_match || options.weight_bits != 0);
+    std::cout << "prim compressed " << prim_ms << " ms, weight " << compressed.weight << "; boruvka "
+              << boruvka_ms << " ms, weight " << full.weight
+              << (mst_match ? "" : options.weight_bits ? "  (quantized)" : "  MISMATCH") << "\n";
+    edges = {};
+
+    TcOptions tc_options;
+    tc_options.nthreads = options.nthreads;
+    TcGraph tc_graph = tc_graph_from_cache(cache, options.nthreads);
+    graph_cache_close(&cache);
+    start = clock_::now();
+    std::uint64_t expected = tc_count(tc_graph, tc_options);
+    double tc_ms = ms_since(start);
+    const double dag_bytes = 8.0 * (tc_graph.n + 1) + 4.0 * tc_graph.col.size();
+    tc_graph = {};
+    start = clock_::now();
+    CompressedGraph dag = tc_compressed_dag(g, options.nthreads);
+    double dag_ms = ms_since(start);
+    start = clock_::now();
+    std::uint64_t triangles = tc_count_compressed(dag, tc_options);
+    double count_ms = ms_since(start);
+    ok = ok && triangles == expected;
+    std::cout << "tc compressed " << count_ms << " ms (dag " << dag_ms << " ms, " << dag.bytes() / 1048576.0
+              << " MB vs " << dag_bytes / 1048576.0 << " MB), triangles " << triangles << "; tc_count " << tc_ms
+              << " ms" << (triangles == expected ? "" : "  MISMATCH (" + std::to_string(expected) + ")") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../common/components.hpp"
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+#include "../prim/boruvka.hpp"
+#include "../prim/component_mst.hpp"
+
+// Minimum spanning forest of a possibly disconnected graph, component by
+// component. Reports the FastSV labelling on its own, then the whole
+// component_mst run (labelling, bucketing and the per-component trees)
+// next to Borůvka on the whole edge list, and checks the weight, the
+// number of tree edges and that every tree stays inside one component.
+//
+// Usage: mst_components <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0] [threads=0] [reps=3]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+template <typename F>
+static double median_ms(int reps, F &&f)
+{
+    std::vector<double> ms;
+    for (int r = 0; r < reps; r++)
+    {
+        auto start = clock_::now();
+        f();
+        ms.push_back(ms_since(start));
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0] [threads=0] [reps=3]\n";
+        return 1;
+    }
+    const std::uint64_t max_vertices = argc > 2 ? std::stoull(argv[2]) : 0;
+    const unsigned nthreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+    const int reps = argc > 4 ? std::max(1, std::stoi(argv[4])) : 3;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    std::uint64_t n = graph_cache_vertices(&cache);
+    if (max_vertices > 0 && max_vertices < n)
+        n = max_vertices;
+    const MstEdges edges = mst_edges_from_cache(cache, n);
+    graph_cache_close(&cache);
+
+    Components<std::uint32_t> cc;
+    double label_ms = median_ms(reps, [&]
+                                { cc = connected_components(edges.n, edges.u.data(), edges.v.data(), edges.u.size(), nthreads); });
+    std::uint64_t isolated = static_cast<std::uint64_t>(std::count(cc.size.begin(), cc.size.end(), 1));
+    std::cout << "vertices=" << edges.n << " edges=" << edges.u.size() << ": " << cc.size.size() << " components ("
+              << isolated << " isolated), largest " << cc.size[0] << "; fastsv " << label_ms << " ms, "
+              << cc.rounds << " rounds\n";
+
+    ComponentForest forest;
+    double forest_ms = median_ms(reps, [&]
+                                 { forest = component_mst(edges, nthreads); });
+    MstResult full;
+    double boruvka_ms = median_ms(reps, [&]
+                                  { full = boruvka_mst(edges, nthreads); });
+
+    // Every parent in the component of its child, one root per component
+    bool inside = true;
+    std::uint64_t roots = 0;
+    for (std::uint32_t v = 0; v < edges.n; v++)
+    {
+        if (forest.forest.parent[v] == MST_NO_PARENT)
+            roots++;
+        else
+            inside = inside && cc.component[forest.forest.parent[v]] == cc.component[v];
+    }
+    const bool ok = std::abs(forest.forest.weight - full.weight) <= 1e-9 * std::max(1.0, full.weight) &&
+                    forest.forest.tree_edges == full.tree_edges && inside && roots == cc.size.size();
+    std::cout << "component_mst " << forest_ms << " ms (" << forest.boruvka_components << " on boruvka, "
+              << forest.prim_components << " on prim), weight " << forest.forest.weight << ", tree edges "
+              << forest.forest.tree_edges << "; boruvka " << boruvka_ms << " ms, weight " << full.weight
+              << ", tree edges " << full.tree_edges << (ok ? "" : "  MISMATCH") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+#include "../prim/dynamic_mst.hpp"
+
+// Per-batch latency of the dynamic minimum spanning forest against a
+// full Borůvka recompute. Every batch changes the weights of random
+// existing edges (up or down) and inserts random weighted edges in equal
+// numbers; after each batch size the forest is checked against a
+// recompute.
+//
+// Usage: mst_dynamic <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0]
+//                    [batch_sizes=1,10,100,1000,10000] [batches=10]
+
+using clock_ = std::chrono::steady_clock;
+
+namespace
+{
+    double ms_since(clock_::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    }
+
+    std::vector<MstUpdate> random_batch(const DynamicMst &g, const MstEdges &initial, std::size_t size,
+                                        double max_weight, std::mt19937_64 &rng)
+    {
+        std::uniform_int_distribution<std::uint32_t> vertex(0, g.n() - 1);
+        std::uniform_int_distribution<int> weight(1, static_cast<int>(max_weight));
+        std::vector<MstUpdate> batch;
+        batch.reserve(size);
+        for (std::size_t k = 0; k < size; k++)
+        {
+            if (k % 2 == 0 && !initial.u.empty())
+            {
+                std::size_t e = rng() % initial.u.size();
+                batch.push_back({initial.u[e], initial.v[e], static_cast<double>(weight(rng))});
+            }
+            else
+                batch.push_back({vertex(rng), vertex(rng), static_cast<double>(weight(rng))});
+        }
+        return batch;
+    }
+
+    // Every parent edge exists with its recorded weight and every vertex
+    // reaches a root
+    bool valid_forest(const DynamicMst &g)
+    {
+        const auto &parent = g.parent();
+        for (std::uint32_t v = 0; v < g.n(); v++)
+        {
+            if (parent[v] == MST_NO_PARENT)
+                continue;
+            if (g.edge_weight(v, parent[v]) != g.parent_weight(v))
+                return false;
+            std::uint32_t x = v;
+            for (std::uint32_t steps = 0; parent[x] != MST_NO_PARENT; steps++)
+            {
+                if (steps > g.n())
+                    return false;
+                x = parent[x];
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [max_vertices=0] [batch_sizes=1,10,100,1000,10000]"
+                     " [batches=10]\n";
+        return 1;
+    }
+    std::uint64_t cap = argc > 2 ? std::stoull(argv[2]) : 0;
+    std::vector<std::size_t> sizes{1, 10, 100, 1000, 10000};
+    if (argc > 3)
+    {
+        sizes.clear();
+        std::stringstream list(argv[3]);
+        for (std::string item; std::getline(list, item, ',');)
+            sizes.push_back(std::stoull(item));
+    }
+    int batches = argc > 4 ? std::stoi(argv[4]) : 10;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    auto n = static_cast<std::uint32_t>(cap > 0 ? std::min<std::uint64_t>(cap, cache.header.n) : cache.header.n);
+    MstEdges initial = mst_edges_from_cache(cache, n);
+    graph_cache_close(&cache);
+    if (n == 0)
+    {
+        std::cerr << "Empty graph\n";
+        return 1;
+    }
+    double max_weight = 1.0;
+    for (double w : initial.w)
+        max_weight = std::max(max_weight, w);
+
+    auto start = clock_::now();
+    DynamicMst g(initial);
+    double init_ms = ms_since(start);
+    std::cout << "vertices=" << n << " edges=" << initial.u.size() << " forest weight " << g.weight()
+              << ", tree edges " << g.tree_edges() << ", init " << init_ms << " ms\n";
+
+    std::mt19937_64 rng(42);
+    bool ok = true;
+    for (std::size_t size : sizes)
+    {
+        std::vector<double> times;
+        std::uint64_t changes = 0, inserted = 0;
+        for (int b = 0; b < batches; b++)
+        {
+            std::vector<MstUpdate> batch = random_batch(g, initial, size, max_weight, rng);
+            start = clock_::now();
+            MstBatchResult r = g.apply(batch);
+            times.push_back(ms_since(start));
+            changes += r.tree_changes;
+            inserted += r.inserted;
+        }
+        std::sort(times.begin(), times.end());
+        double ms = times[times.size() / 2];
+
+        // Full recompute on the current graph
+        start = clock_::now();
+        MstResult full = boruvka_mst(g.edges());
+        double full_ms = ms_since(start);
+        bool match = std::abs(full.weight - g.weight()) <= 1e-9 * std::max(1.0, full.weight) &&
+                     full.tree_edges == g.tree_edges() && valid_forest(g);
+        ok = ok && match;
+        std::cout << "batch=" << size << " median " << ms << " ms (" << 1e3 * ms / static_cast<double>(size)
+                  << " us/update, x" << full_ms / ms << " vs recompute " << full_ms << " ms), " << inserted
+                  << " inserted, " << changes << " forest changes, weight " << g.weight()
+                  << (match ? "" : "  MISMATCH (recompute " + std::to_string(full.weight) + ")") << "\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "../common/graph_cache.h"
+#include "../prim/boruvka.hpp"
+#include "../prim/streaming_mst.hpp"
+
+// Semi-streaming minimum spanning forest of an edge file under a memory
+// budget. With verify=1 the file is also loaded whole and the streamed
+// forest is checked against Borůvka; leave it off for graphs that do not
+// fit in memory.
+//
+// Usage: mst_stream <graph.mtx|graph.gr> [budget_mb=1024] [max_vertices=0] [threads=0] [verify=1]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr> [budget_mb=1024] [max_vertices=0] [threads=0] [verify=1]\n";
+        return 1;
+    }
+    StreamingMstOptions options;
+    if (argc > 2)
+        options.memory_budget = static_cast<std::uint64_t>(std::stod(argv[2]) * (1 << 20));
+    options.max_vertices = argc > 3 ? std::stoull(argv[3]) : 0;
+    options.nthreads = argc > 4 ? static_cast<unsigned>(std::stoul(argv[4])) : 0;
+    bool verify = argc <= 5 || std::stoi(argv[5]) != 0;
+
+    StreamingMstResult stream;
+    auto start = clock_::now();
+    try
+    {
+        stream = streaming_mst(argv[1], options);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    double ms = ms_since(start);
+    std::cout << "stream budget=" << options.memory_budget / double(1 << 20) << " MB " << ms << " ms ("
+              << stream.bytes_read / 1e3 / ms << " MB/s), " << stream.edges_read << " edges in " << stream.blocks
+              << " blocks of " << stream.block_edges << ", peak " << stream.peak_bytes / double(1 << 20)
+              << " MB, forest weight " << stream.weight << ", tree edges " << stream.forest.u.size() << "\n";
+    if (!verify)
+        return 0;
+
+    GraphCache cache;
+    if (graph_cache_load(argv[1], &cache) != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    MstEdges edges = mst_edges_from_cache(cache, stream.forest.n);
+    graph_cache_close(&cache);
+    start = clock_::now();
+    MstResult full = boruvka_mst(edges, options.nthreads);
+    double full_ms = ms_since(start);
+    bool match = std::abs(full.weight - stream.weight) <= 1e-9 * std::max(1.0, full.weight) &&
+                 full.tree_edges == stream.forest.u.size();
+    std::cout << "boruvka in memory " << full_ms << " ms, forest weight " << full.weight << ", tree edges "
+              << full.tree_edges << (match ? "" : "  MISMATCH") << "\n";
+    return match ? 0 : 1;
+}
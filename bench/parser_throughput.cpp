@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "../common/graph_parser.h"
+
+// Parse throughput of graph_parse_file (GB/s) for 1..max_threads threads,
+// next to the getline + istringstream loop the drivers used before.
+//
+// Usage: parser_throughput <graph.mtx|graph.gr> [max_threads] [reps]
+
+using clock_ = std::chrono::steady_clock;
+
+static double median(std::vector<double> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// Counts entries as graph_parse_file does: the size line of a
+// MatrixMarket file is skipped, and pattern entries have no weight
+static std::uint64_t parse_istringstream(const std::string &path)
+{
+    std::ifstream fin(path);
+    std::string line;
+    std::uint64_t count = 0;
+    bool matrix_market = false, size_line = false;
+    while (std::getline(fin, line))
+    {
+        if (line.rfind("%%MatrixMarket", 0) == 0)
+            matrix_market = true;
+        if (line.empty() || line[0] == '%' || line[0] == 'c' || line[0] == 'p')
+            continue;
+        if (matrix_market && !size_line)
+        {
+            size_line = true;
+            continue;
+        }
+        std::istringstream iss(line[0] == 'a' ? line.substr(1) : line);
+        std::uint64_t u, v;
+        double w;
+        if (iss >> u >> v)
+        {
+            iss >> w;
+            count++;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.mtx|graph.gr> [max_threads] [reps]\n";
+        return 1;
+    }
+
+    const std::string path = argv[1];
+    unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    int reps = argc > 3 ? std::stoi(argv[3]) : 5;
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+        std::cerr << "Cannot open file: " << path << "\n";
+        return 1;
+    }
+    const double gb = static_cast<double>(st.st_size) / 1e9;
+    std::cout << "file: " << path << " (" << gb << " GB)\n";
+
+    {
+        auto start = clock_::now();
+        std::uint64_t count = parse_istringstream(path);
+        double sec = std::chrono::duration<double>(clock_::now() - start).count();
+        std::cout << "istringstream       entries=" << count << " " << gb / sec << " GB/s\n";
+    }
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned t : thread_counts)
+    {
+        std::vector<double> parse_sec, csr_sec;
+        std::uint64_t nnz = 0;
+        for (int r = 0; r < reps; r++)
+        {
+            GraphEdgeList list;
+            auto start = clock_::now();
+            if (graph_parse_file(path.c_str(), t, &list) != 0)
+                return 1;
+            auto parsed = clock_::now();
+
+            std::vector<std::uint64_t> row_ptr(list.n + 1), col_idx(list.nnz);
+            std::vector<double> weights((list.flags & GRAPH_CACHE_WEIGHTED) ? list.nnz : 0);
+            auto csr_start = clock_::now();
+            graph_edge_list_to_csr(&list, row_ptr.data(), col_idx.data(), weights.empty() ? nullptr : weights.data(), t);
+            auto csr_end = clock_::now();
+
+            parse_sec.push_back(std::chrono::duration<double>(parsed - start).count());
+            csr_sec.push_back(std::chrono::duration<double>(csr_end - csr_start).count());
+            nnz = list.nnz;
+            graph_edge_list_free(&list);
+        }
+
+        double p = median(parse_sec);
+        std::cout << "threads=" << t << " entries=" << nnz << " parse " << gb / p << " GB/s (" << p * 1e3
+                  << " ms), csr " << median(csr_sec) * 1e3 << " ms\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Sandia/triangles.hpp"
+#include "../common/graph_cache.h"
+#include "../common/perf_counters.h"
+#include "../common/reorder.hpp"
+#include "../common/rmat.hpp"
+#include "../prim/boruvka.hpp"
+
+// Effect of the vertex orderings on the native kernels. For every order
+// the tool times computing and applying the permutation, reports the
+// mean log2 distance between the ends of an edge (a proxy for the
+// locality of neighbour accesses), then times Borůvka and the triangle
+// count on the permuted graph with LLC and dTLB misses when the hardware
+// counters are available. The forest is mapped back to the original ids
+// and checked against the original graph; weights and counts must match
+// the original order.
+//
+// Usage: reorder_bench <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [orders=original,degree,rcm,community]
+//                      [threads=0] [reps=3]
+
+using clock_ = std::chrono::steady_clock;
+
+namespace
+{
+    double ms_since(clock_::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    }
+
+    struct Timing
+    {
+        double ms = 0.0;
+        PerfSample counters{};
+    };
+
+    // Median time of reps runs, counters of the median run
+    template <typename F>
+    Timing measure(PerfCounters &perf, int reps, F &&f)
+    {
+        std::vector<Timing> runs;
+        for (int r = 0; r < reps; r++)
+        {
+            Timing t;
+            perf_counters_start(&perf);
+            auto start = clock_::now();
+            f();
+            t.ms = ms_since(start);
+            perf_counters_stop(&perf, &t.counters);
+            runs.push_back(t);
+        }
+        std::sort(runs.begin(), runs.end(), [](const Timing &a, const Timing &b) { return a.ms < b.ms; });
+        return runs[runs.size() / 2];
+    }
+
+    std::string counters(const Timing &t)
+    {
+        std::string out;
+        for (int c : {PERF_LLC_MISSES, PERF_DTLB_MISSES})
+            if (t.counters.valid[c])
+                out += " " + std::string(perf_counter_name(c)) + "=" + std::to_string(t.counters.value[c]);
+        return out;
+    }
+
+    double mean_log_gap(const GraphCache &cache)
+    {
+        double sum = 0.0;
+        for (std::uint64_t i = 0; i < cache.header.n; i++)
+            for (std::uint64_t k = cache.row_ptr[i]; k < cache.row_ptr[i + 1]; k++)
+            {
+                std::uint64_t j = cache.col_idx[k];
+                sum += std::log2(1.0 + static_cast<double>(j > i ? j - i : i - j));
+            }
+        return cache.header.nnz > 0 ? sum / static_cast<double>(cache.header.nnz) : 0.0;
+    }
+
+    // Every parent edge exists in the original graph
+    bool forest_in_graph(const MstEdges &original, const std::vector<std::uint32_t> &parent)
+    {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        edges.reserve(original.u.size());
+        for (std::size_t e = 0; e < original.u.size(); e++)
+            edges.emplace_back(std::min(original.u[e], original.v[e]), std::max(original.u[e], original.v[e]));
+        std::sort(edges.begin(), edges.end());
+        for (std::uint32_t v = 0; v < parent.size(); v++)
+            if (parent[v] != MST_NO_PARENT &&
+                !std::binary_search(edges.begin(), edges.end(), std::pair{std::min(v, parent[v]), std::max(v, parent[v])}))
+                return false;
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [orders=original,degree,rcm,community] [threads=0]"
+                     " [reps=3]\n";
+        return 1;
+    }
+    std::vector<VertexOrder> orders{VertexOrder::Original, VertexOrder::Degree, VertexOrder::Rcm,
+                                    VertexOrder::Community};
+    if (argc > 2)
+    {
+        orders.clear();
+        std::stringstream list(argv[2]);
+        for (std::string item; std::getline(list, item, ',');)
+        {
+            VertexOrder order;
+            if (!vertex_order_parse(item, order))
+            {
+                std::cerr << "Unknown order: " << item << "\n";
+                return 1;
+            }
+            orders.push_back(order);
+        }
+    }
+    unsigned nthreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+    int reps = argc > 4 ? std::max(1, std::stoi(argv[4])) : 3;
+
+    PerfCounters perf;
+    if (perf_counters_open(&perf) != 0)
+        std::cerr << "Warning: hardware counters unavailable, timing only (" << perf.reason << ")\n";
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    const auto n = static_cast<std::uint32_t>(graph_cache_vertices(&cache));
+    const MstEdges original = mst_edges_from_cache(cache, n);
+    std::cout << "vertices=" << n << " entries=" << cache.header.nnz << "\n";
+
+    bool ok = true, first = true;
+    double ref_weight = 0.0, ref_triangles = 0.0;
+    for (VertexOrder order : orders)
+    {
+        auto start = clock_::now();
+        VertexPermutation perm = reorder_compute(cache, order, nthreads);
+        double order_ms = ms_since(start);
+        start = clock_::now();
+        GraphCache permuted;
+        if (reorder_apply(cache, perm, &permuted, nthreads) != 0)
+        {
+            std::cerr << "Cannot permute the graph\n";
+            return 1;
+        }
+        double apply_ms = ms_since(start);
+
+        MstEdges edges = mst_edges_from_cache(permuted, n);
+        MstResult mst;
+        Timing mst_time = measure(perf, reps, [&] { mst = boruvka_mst(edges, nthreads); });
+        TcGraph tc_graph = tc_graph_from_cache(permuted, nthreads);
+        TcOptions tc_options;
+        tc_options.nthreads = nthreads;
+        std::uint64_t triangles = 0;
+        Timing tc_time = measure(perf, reps, [&] { triangles = tc_count(tc_graph, tc_options); });
+
+        if (first)
+        {
+            ref_weight = mst.weight;
+            ref_triangles = static_cast<double>(triangles);
+            first = false;
+        }
+        bool match = std::abs(mst.weight - ref_weight) <= 1e-9 * std::max(1.0, ref_weight) &&
+                     static_cast<double>(triangles) == ref_triangles &&
+                     forest_in_graph(original, reorder_ids_to_original(perm, mst.parent));
+        ok = ok && match;
+        std::cout << vertex_order_name(order) << " order " << order_ms << " ms, apply " << apply_ms
+                  << " ms, mean log2 gap " << mean_log_gap(permuted) << "\n"
+                  << "  boruvka " << mst_time.ms << " ms" << counters(mst_time) << ", weight " << mst.weight << "\n"
+                  << "  tc " << tc_time.ms << " ms" << counters(tc_time) << ", triangles " << triangles
+                  << (match ? "" : "  MISMATCH") << "\n";
+        graph_cache_close(&permuted);
+    }
+    graph_cache_close(&cache);
+    perf_counters_close(&perf);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <spla.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "../common/graph_cache.h"
+#include "../common/spla_build.hpp"
+
+// Load + convert time of spla::Matrix: one set_uint per edge (the old
+// loaders) against a single Matrix::build from the cached CSR, each
+// followed by set_format(AccCsr) as in sandia_spla.
+//
+// Usage: spla_load <scale18.mtx> [scale19.mtx] [scale20.mtx] ...
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.mtx> [graph.mtx ...]\n";
+        return 1;
+    }
+
+    for (int arg = 1; arg < argc; arg++)
+    {
+        const std::string path = argv[arg];
+
+        auto start = clock_::now();
+        GraphCache cache;
+        if (graph_cache_load(path.c_str(), &cache) != 0)
+        {
+            std::cerr << "Cannot open file: " << path << "\n";
+            return 1;
+        }
+        double load_ms = ms_since(start);
+        auto n = static_cast<unsigned int>(cache.header.n);
+
+        start = clock_::now();
+        auto per_element = spla::Matrix::make(n, n, spla::INT);
+        for (std::uint64_t u = 0; u < cache.header.n; u++)
+            for (std::uint64_t k = cache.row_ptr[u]; k < cache.row_ptr[u + 1]; k++)
+                per_element->set_int(static_cast<unsigned int>(u), static_cast<unsigned int>(cache.col_idx[k]), 1);
+        double set_ms = ms_since(start);
+        start = clock_::now();
+        per_element->set_format(spla::FormatMatrix::AccCsr);
+        double set_convert_ms = ms_since(start);
+
+        start = clock_::now();
+        auto bulk = spla::Matrix::make(n, n, spla::INT);
+        auto coo = coo_from_cache<int>(cache, cache.header.n, cache.header.n, cache.header.nnz, false, false, 1);
+        build_matrix(bulk, coo);
+        double build_ms = ms_since(start);
+        start = clock_::now();
+        bulk->set_format(spla::FormatMatrix::AccCsr);
+        double build_convert_ms = ms_since(start);
+
+        std::cout << path << ": n=" << cache.header.n << " nnz=" << cache.header.nnz << " cache " << load_ms << " ms\n"
+                  << "  set_uint per edge: load " << set_ms << " ms + convert " << set_convert_ms
+                  << " ms = " << set_ms + set_convert_ms << " ms\n"
+                  << "  Matrix::build:     load " << build_ms << " ms + convert " << build_convert_ms
+                  << " ms = " << build_ms + build_convert_ms << " ms\n";
+
+        graph_cache_close(&cache);
+    }
+
+    return 0;
+}
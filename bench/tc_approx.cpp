@@ -0,0 +1,93 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Sandia/approx_triangles.hpp"
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+
+// Accuracy against speedup of the approximate triangle counts. The exact
+// tc_count is the reference; for every method and target error the tool
+// prints the estimate, its interval, the actual error and whether the
+// interval holds the exact count.
+//
+// Usage: tc_approx <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [rel_errors=0.1,0.05,0.02,0.01]
+//                  [confidence=0.95] [keep_probability=0.1] [threads=0]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [rel_errors=0.1,0.05,0.02,0.01] [confidence=0.95]"
+                     " [keep_probability=0.1] [threads=0]\n";
+        return 1;
+    }
+    std::vector<double> targets{0.1, 0.05, 0.02, 0.01};
+    if (argc > 2)
+    {
+        targets.clear();
+        std::stringstream list(argv[2]);
+        for (std::string item; std::getline(list, item, ',');)
+            targets.push_back(std::stod(item));
+    }
+    TcApproxOptions options;
+    options.confidence = argc > 3 ? std::stod(argv[3]) : 0.95;
+    options.keep_probability = argc > 4 ? std::stod(argv[4]) : 0.1;
+    options.nthreads = argc > 5 ? static_cast<unsigned>(std::stoul(argv[5])) : 0;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    TcGraph g = tc_graph_from_cache(cache, options.nthreads);
+    graph_cache_close(&cache);
+
+    TcOptions exact_options;
+    exact_options.nthreads = options.nthreads;
+    auto start = clock_::now();
+    std::uint64_t exact = tc_count(g, exact_options);
+    double exact_ms = ms_since(start);
+    std::cout << "vertices=" << g.n << " dag edges=" << g.col.size() << " exact " << exact << " triangles "
+              << exact_ms << " ms\n";
+
+    int misses = 0;
+    for (TcApproxMethod method : {TcApproxMethod::Wedge, TcApproxMethod::Doulion})
+        for (double target : targets)
+        {
+            options.method = method;
+            options.rel_error = target;
+            options.seed++;
+            start = clock_::now();
+            TcEstimate est = tc_approx(g, options);
+            double ms = ms_since(start);
+            double error = exact > 0 ? std::abs(est.estimate - exact) / exact : 0.0;
+            bool covered = est.lower <= exact && exact <= est.upper;
+            misses += !covered;
+            std::cout << tc_approx_name(method) << " target=" << target << " " << ms << " ms (x" << exact_ms / ms
+                      << "), estimate " << est.estimate << " [" << est.lower << ", " << est.upper << "] +-"
+                      << 100.0 * est.rel_error << "%, actual " << 100.0 * error << "%, "
+                      << (method == TcApproxMethod::Wedge ? "wedges " : "trials ") << est.samples;
+            if (method == TcApproxMethod::Doulion)
+                std::cout << " at p=" << est.keep_probability;
+            std::cout << (covered ? "" : "  OUTSIDE INTERVAL") << "\n";
+        }
+    // Intervals miss the exact count at the rate 1 - confidence; no failure
+    std::cout << misses << " of " << 2 * targets.size() << " intervals missed the exact count\n";
+    return 0;
+}
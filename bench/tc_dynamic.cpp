@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Sandia/dynamic_triangles.hpp"
+#include "../common/graph_cache.h"
+#include "../common/rmat.hpp"
+
+// Batch size against latency of the incremental triangle count, compared
+// with a full recount. Every batch deletes random existing edges and
+// inserts random vertex pairs in equal numbers; after each batch size
+// the maintained counts are checked against a recount.
+//
+// Usage: tc_dynamic <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [batch_sizes=1,10,100,1000,10000,100000]
+//                   [batches=10] [per_vertex=0]
+
+using clock_ = std::chrono::steady_clock;
+
+namespace
+{
+    double ms_since(clock_::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    }
+
+    std::vector<TcUpdate> random_batch(const DynamicTriangles &g, std::size_t size, std::mt19937_64 &rng)
+    {
+        std::uniform_int_distribution<std::uint32_t> vertex(0, g.n() - 1);
+        std::vector<TcUpdate> batch;
+        batch.reserve(size);
+        for (std::size_t k = 0; k < size; k++)
+        {
+            std::uint32_t u = vertex(rng);
+            if (k % 2 == 0)
+            {
+                for (int tries = 0; tries < 64 && g.neighbors(u).empty(); tries++)
+                    u = vertex(rng);
+                const auto &nbrs = g.neighbors(u);
+                if (!nbrs.empty())
+                {
+                    batch.push_back({u, nbrs[rng() % nbrs.size()], false});
+                    continue;
+                }
+            }
+            batch.push_back({u, vertex(rng), true});
+        }
+        return batch;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [batch_sizes=1,10,100,1000,10000,100000]"
+                     " [batches=10] [per_vertex=0]\n";
+        return 1;
+    }
+
+    std::vector<std::size_t> sizes{1, 10, 100, 1000, 10000, 100000};
+    if (argc > 2)
+    {
+        sizes.clear();
+        std::stringstream list(argv[2]);
+        for (std::string item; std::getline(list, item, ',');)
+            sizes.push_back(std::stoull(item));
+    }
+    int batches = argc > 3 ? std::stoi(argv[3]) : 10;
+    bool per_vertex = argc > 4 && std::stoi(argv[4]) != 0;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    auto start = clock_::now();
+    DynamicTriangles g(cache, per_vertex);
+    double init_ms = ms_since(start);
+    graph_cache_close(&cache);
+    if (g.n() == 0)
+    {
+        std::cerr << "Empty graph\n";
+        return 1;
+    }
+    std::cout << "vertices=" << g.n() << " edges=" << g.edges() << " triangles=" << g.triangles()
+              << " init " << init_ms << " ms" << (per_vertex ? " (per-vertex)" : "") << "\n";
+
+    // Full recount as the reference: snapshot, degree-ordered DAG, count
+    start = clock_::now();
+    g.recount();
+    double full_ms = ms_since(start);
+    std::cout << "full recount " << full_ms << " ms\n";
+
+    std::mt19937_64 rng(42);
+    bool ok = true;
+    for (std::size_t size : sizes)
+    {
+        std::vector<double> times;
+        std::uint64_t changed = 0;
+        for (int b = 0; b < batches; b++)
+        {
+            std::vector<TcUpdate> batch = random_batch(g, size, rng);
+            start = clock_::now();
+            TcBatchResult r = g.apply(batch);
+            times.push_back(ms_since(start));
+            changed += r.inserted + r.erased;
+        }
+        std::sort(times.begin(), times.end());
+        double ms = times[times.size() / 2];
+
+        std::vector<std::uint64_t> vertex;
+        std::uint64_t expected = g.recount(per_vertex ? &vertex : nullptr);
+        bool match = expected == g.triangles() && (!per_vertex || vertex == g.vertex_triangles());
+        ok = ok && match;
+        std::cout << "batch=" << size << " median " << ms << " ms (" << 1e3 * ms / static_cast<double>(size)
+                  << " us/update, x" << full_ms / ms << " vs recount), " << changed << " edges changed, triangles "
+                  << g.triangles() << (match ? "" : "  COUNT MISMATCH (recount " + std::to_string(expected) + ")")
+                  << "\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Sandia/triangles.hpp"
+#include "../common/graph_cache.h"
+
+// Intersection kernels and thread scaling of the native triangle counter.
+// Every kernel the CPU supports runs at 1, 2, 4, ... max_threads threads
+// and must report the same count as the scalar kernel on one thread.
+//
+// Usage: tc_kernels <graph.mtx|graph.gr> [max_threads] [reps] [bitmap_degree]
+
+using clock_ = std::chrono::steady_clock;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <graph.mtx|graph.gr> [max_threads] [reps] [bitmap_degree]\n";
+        return 1;
+    }
+
+    GraphCache cache;
+    if (graph_cache_load(argv[1], &cache) != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+    unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    int reps = argc > 3 ? std::stoi(argv[3]) : 3;
+    TcOptions options;
+    if (argc > 4)
+        options.bitmap_degree = static_cast<std::uint32_t>(std::stoul(argv[4]));
+
+    auto start = clock_::now();
+    TcGraph graph = tc_graph_from_cache(cache, max_threads);
+    double build_ms = std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    graph_cache_close(&cache);
+    std::uint64_t max_out = 0;
+    for (std::uint32_t r = 0; r < graph.n; r++)
+        max_out = std::max(max_out, graph.row_ptr[r + 1] - graph.row_ptr[r]);
+    std::cout << "vertices=" << graph.n << " dag_edges=" << graph.col.size() << " max_out_degree=" << max_out
+              << " build " << build_ms << " ms\n";
+
+    options.kernel = TcKernel::Scalar;
+    options.nthreads = 1;
+    start = clock_::now();
+    const std::uint64_t reference = tc_count(graph, options);
+    double base_ms = std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+    std::cout << "scalar threads=1 " << base_ms << " ms, triangles " << reference << "\n";
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(max_threads);
+
+    for (TcKernel kernel : {TcKernel::Scalar, TcKernel::Avx2, TcKernel::Avx512})
+    {
+        if (!tc_kernel_supported(kernel))
+        {
+            std::cout << tc_kernel_name(kernel) << ": not supported by this CPU\n";
+            continue;
+        }
+        options.kernel = kernel;
+        for (unsigned t : thread_counts)
+        {
+            options.nthreads = t;
+            std::vector<double> times;
+            std::uint64_t count = 0;
+            for (int r = 0; r < reps; r++)
+            {
+                start = clock_::now();
+                count = tc_count(graph, options);
+                times.push_back(std::chrono::duration<double, std::milli>(clock_::now() - start).count());
+            }
+            std::sort(times.begin(), times.end());
+            double ms = times[times.size() / 2];
+            std::cout << tc_kernel_name(kernel) << " threads=" << t << " " << ms << " ms (x" << base_ms / ms
+                      << "), triangles " << count << (count == reference ? "" : "  COUNT MISMATCH") << "\n";
+        }
+    }
+
+    return 0;
+}
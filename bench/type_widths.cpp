@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Sandia/triangles.hpp"
+#include "../common/graph_cache.h"
+#include "../common/graph_types.hpp"
+#include "../common/rmat.hpp"
+#include "../prim/boruvka.hpp"
+
+// Borůvka and the triangle count with every id/weight type pair that
+// holds the graph exactly, next to the u64:f64 pair that matches the
+// cache. Prints the narrowest pair (the one the graph_bench native
+// backend picks), then per pair the staged bytes, the staging time and
+// the median kernel time; every forest weight and count must equal the
+// widest one.
+//
+// Usage: type_widths <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [types=all|u32:u16,u64:f64,...] [threads=0] [reps=3]
+
+using clock_ = std::chrono::steady_clock;
+
+static double ms_since(clock_::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_::now() - start).count();
+}
+
+template <typename F>
+static double median_ms(int reps, F &&f)
+{
+    std::vector<double> ms;
+    for (int r = 0; r < reps; r++)
+    {
+        auto start = clock_::now();
+        f();
+        ms.push_back(ms_since(start));
+    }
+    std::sort(ms.begin(), ms.end());
+    return ms[ms.size() / 2];
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <graph.mtx|graph.gr|rmat:S[:EF[:SEED]]> [types=all|u32:u16,u64:f64,...] [threads=0] [reps=3]\n";
+        return 1;
+    }
+    const std::string list = argc > 2 ? argv[2] : "all";
+    const unsigned nthreads = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 0;
+    const int reps = argc > 4 ? std::max(1, std::stoi(argv[4])) : 3;
+
+    GraphCache cache;
+    RmatParams rmat;
+    int status = rmat_parse_spec(argv[1], rmat) ? rmat_generate(rmat, &cache) : graph_cache_load(argv[1], &cache);
+    if (status != 0)
+    {
+        std::cerr << "Cannot open file: " << argv[1] << "\n";
+        return 1;
+    }
+
+    auto start = clock_::now();
+    const GraphTypeInfo info = graph_types_scan(cache, nthreads);
+    std::cout << "vertices=" << info.vertices << " entries=" << cache.header.nnz << " weights [" << info.min_weight
+              << ", " << info.max_weight << "]" << (info.integral ? " integral" : "")
+              << (info.float_exact ? " float-exact" : "") << ", narrowest "
+              << graph_types_name(info.narrowest) << " (scan " << ms_since(start) << " ms)\n";
+
+    std::vector<GraphTypes> pairs;
+    if (list == "all")
+    {
+        for (IndexType index : {IndexType::U32, IndexType::U64})
+            for (WeightType weight : {WeightType::U16, WeightType::U32, WeightType::F32, WeightType::F64})
+                if (graph_types_fit(info, {index, weight}))
+                    pairs.push_back({index, weight});
+    }
+    else
+    {
+        std::stringstream ss(list);
+        std::string name;
+        while (std::getline(ss, name, ','))
+        {
+            GraphTypes types;
+            if (!graph_types_parse(name, types))
+            {
+                std::cerr << "Unknown types: " << name << " (expected u32|u64:u16|u32|f32|f64)\n";
+                return 1;
+            }
+            if (!graph_types_fit(info, types))
+            {
+                std::cerr << name << " does not hold this graph\n";
+                return 1;
+            }
+            pairs.push_back(types);
+        }
+    }
+    // Reference last so the narrow pairs run on a cold allocator as well
+    const GraphTypes widest{IndexType::U64, WeightType::F64};
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&](GraphTypes t)
+                               { return t.index == widest.index && t.weight == widest.weight; }),
+                pairs.end());
+    pairs.push_back(widest);
+
+    const std::uint64_t n = std::min<std::uint64_t>(info.vertices, cache.header.n);
+    struct Row
+    {
+        GraphTypes types;
+        double weight;
+    };
+    std::vector<Row> rows;
+    for (GraphTypes types : pairs)
+    {
+        graph_types_dispatch(types, [&](auto index, auto weight)
+                             {
+            using Index = decltype(index);
+            using Weight = decltype(weight);
+            auto stage = clock_::now();
+            BasicMstEdges<Index, Weight> edges = mst_edges_from_cache<Index, Weight>(cache, n);
+            double stage_ms = ms_since(stage);
+            const double bytes = static_cast<double>(edges.u.size()) * graph_types_edge_bytes(types);
+            BasicMstResult<Index> result;
+            double ms = median_ms(reps, [&] { result = boruvka_mst(edges, nthreads); });
+            rows.push_back({types, result.weight});
+            std::cout << "boruvka " << graph_types_name(types) << ": staged " << bytes / 1048576.0 << " MB ("
+                      << graph_types_edge_bytes(types) << " bytes/edge) in " << stage_ms << " ms, " << ms
+                      << " ms, weight " << result.weight << "\n"; });
+    }
+    bool ok = true;
+    for (const Row &row : rows)
+        if (row.weight != rows.back().weight)
+        {
+            std::cout << "boruvka " << graph_types_name(row.types) << " MISMATCH\n";
+            ok = false;
+        }
+
+    TcOptions options;
+    options.nthreads = nthreads;
+    std::uint64_t narrow_count = 0;
+    if (info.narrowest.index == IndexType::U32)
+    {
+        auto stage = clock_::now();
+        TcGraph g = tc_graph_from_cache(cache, nthreads);
+        double stage_ms = ms_since(stage);
+        double ms = median_ms(reps, [&] { narrow_count = tc_count(g, options); });
+        std::cout << "tc u32: dag " << (4.0 * g.col.size()) / 1048576.0 << " MB built in " << stage_ms << " ms, "
+                  << ms << " ms, triangles " << narrow_count << "\n";
+    }
+    auto stage = clock_::now();
+    BasicTcGraph<std::uint64_t> g = tc_graph_from_cache<std::uint64_t>(cache, nthreads);
+    double stage_ms = ms_since(stage);
+    std::uint64_t wide_count = 0;
+    double ms = median_ms(reps, [&] { wide_count = tc_count(g, options); });
+    std::cout << "tc u64: dag " << (8.0 * g.col.size()) / 1048576.0 << " MB built in " << stage_ms << " ms, " << ms
+              << " ms, triangles " << wide_count;
+    if (info.narrowest.index == IndexType::U32 && wide_count != narrow_count)
+    {
+        std::cout << "  MISMATCH";
+        ok = false;
+    }
+    std::cout << "\n";
+    graph_cache_close(&cache);
+    return ok ? 0 : 1;
+}
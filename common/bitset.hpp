@@ -0,0 +1,33 @@
+#ifndef BITSET_HPP
+#define BITSET_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Fixed-size bitset over vertex ids, sized once at construction
+class DenseBitset
+{
+public:
+    explicit DenseBitset(std::size_t size)
+        : m_words((size + 63) / 64, 0), m_size(size)
+    {
+    }
+
+    std::size_t size() const { return m_size; }
+
+    bool test(std::size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1u; }
+    void set(std::size_t i) { m_words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+    void reset(std::size_t i) { m_words[i >> 6] &= ~(std::uint64_t(1) << (i & 63)); }
+
+    void clear()
+    {
+        for (auto &w : m_words)
+            w = 0;
+    }
+
+private:
+    std::vector<std::uint64_t> m_words;
+    std::size_t m_size;
+};
+
+#endif // BITSET_HPP
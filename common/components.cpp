@@ -0,0 +1,105 @@
+#include "components.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+#include "parallel.hpp"
+
+namespace
+{
+    template <typename Index>
+    inline void atomic_min(Index *slot, Index value)
+    {
+        Index cur = __atomic_load_n(slot, __ATOMIC_RELAXED);
+        while (value < cur && !__atomic_compare_exchange_n(slot, &cur, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        }
+    }
+}
+
+template <typename Index>
+Components<Index> connected_components(Index n, const Index *u, const Index *v, std::uint64_t m, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    Components<Index> result;
+    std::vector<Index> f(n), gf(n);
+    parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t i = b; i < e; i++)
+            f[i] = gf[i] = static_cast<Index>(i); });
+
+    for (;;)
+    {
+        result.rounds++;
+        parallel_for(nthreads, m, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const Index x = u[k], y = v[k];
+                const Index gx = gf[x], gy = gf[y];
+                if (gx == gy)
+                    continue;
+                atomic_min(&f[__atomic_load_n(&f[x], __ATOMIC_RELAXED)], gy);
+                atomic_min(&f[__atomic_load_n(&f[y], __ATOMIC_RELAXED)], gx);
+                atomic_min(&f[x], gy);
+                atomic_min(&f[y], gx);
+            } });
+
+        parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t i = b; i < e; i++)
+                atomic_min(&f[i], gf[i]); });
+
+        std::atomic<bool> changed{false};
+        parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            bool local = false;
+            for (std::uint64_t i = b; i < e; i++)
+            {
+                const Index g = f[f[i]];
+                if (g != gf[i])
+                {
+                    gf[i] = g;
+                    local = true;
+                }
+            }
+            if (local)
+                changed.store(true, std::memory_order_relaxed); });
+        if (!changed.load())
+            break;
+    }
+    gf = {};
+
+    // Dense ids by descending size; f[v] is the smallest vertex of v's
+    // component, so the roots are the vertices with f[v] == v
+    std::vector<std::uint64_t> count(n, 0);
+    parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t i = b; i < e; i++)
+            __atomic_fetch_add(&count[f[i]], 1, __ATOMIC_RELAXED); });
+    for (Index i = 0; i < n; i++)
+        if (f[i] == i)
+            result.root.push_back(i);
+    std::stable_sort(result.root.begin(), result.root.end(), [&](Index a, Index b)
+                     { return count[a] > count[b]; });
+    result.size.resize(result.root.size());
+    std::vector<Index> id_of_root(n);
+    for (std::size_t c = 0; c < result.root.size(); c++)
+    {
+        result.size[c] = count[result.root[c]];
+        id_of_root[result.root[c]] = static_cast<Index>(c);
+    }
+    count = {};
+    result.component.resize(n);
+    parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t i = b; i < e; i++)
+            result.component[i] = id_of_root[f[i]]; });
+    return result;
+}
+
+template Components<std::uint32_t> connected_components(std::uint32_t, const std::uint32_t *, const std::uint32_t *,
+                                                        std::uint64_t, unsigned);
+template Components<std::uint64_t> connected_components(std::uint64_t, const std::uint64_t *, const std::uint64_t *,
+                                                        std::uint64_t, unsigned);
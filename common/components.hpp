@@ -0,0 +1,35 @@
+#ifndef COMPONENTS_HPP
+#define COMPONENTS_HPP
+
+#include <cstdint>
+#include <vector>
+
+//--------------------------------------------------------------------
+// Parallel connected components of an undirected edge list (FastSV).
+//
+// Every vertex keeps a parent f and grandparent gf. A round hooks, for
+// each edge (u, v) in both directions, the tree of u under the
+// grandparent of v (stochastic hooking, atomic min on f[f[u]]) and u
+// itself as well (aggressive hooking), then shortcuts f = min(f, gf)
+// and recomputes gf; it stops when no grandparent changed. All updates
+// are minima, so every vertex ends pointing at the smallest vertex of
+// its component. Components are then numbered densely by descending
+// size (ties by smallest vertex), so component 0 is the largest.
+//--------------------------------------------------------------------
+
+template <typename Index>
+struct Components
+{
+    std::vector<Index> component;    // dense id of every vertex
+    std::vector<std::uint64_t> size; // vertices per component, descending
+    std::vector<Index> root;         // smallest vertex of every component
+    std::uint32_t rounds = 0;
+};
+
+// Components of vertices [0, n) under the edges (u[k], v[k]), k < m;
+// instances for uint32_t and uint64_t ids
+template <typename Index>
+Components<Index> connected_components(Index n, const Index *u, const Index *v, std::uint64_t m,
+                                       unsigned nthreads = 0);
+
+#endif // COMPONENTS_HPP
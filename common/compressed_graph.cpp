@@ -0,0 +1,473 @@
+#include "compressed_graph.hpp"
+#include "parallel.hpp"
+#include "undirected_csr.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define COMPRESSED_X86_DECODER 1
+#endif
+
+namespace
+{
+    constexpr std::uint64_t BUILD_BLOCK = 4096; // rows per scheduling block
+    constexpr std::size_t PADDING = 16;         // bytes after the stream for whole-group loads
+
+    // Control byte -> PSHUFB mask gathering its four values, and data length
+    struct GroupTables
+    {
+        std::uint8_t shuffle[256][16];
+        std::uint8_t length[256];
+
+        GroupTables()
+        {
+            for (unsigned c = 0; c < 256; c++)
+            {
+                std::uint8_t pos = 0;
+                for (unsigned k = 0; k < 4; k++)
+                {
+                    unsigned len = ((c >> (2 * k)) & 3) + 1;
+                    for (unsigned b = 0; b < 4; b++)
+                        shuffle[c][4 * k + b] = b < len ? static_cast<std::uint8_t>(pos + b) : 0x80;
+                    pos = static_cast<std::uint8_t>(pos + len);
+                }
+                length[c] = pos;
+            }
+        }
+    };
+
+    const GroupTables &tables()
+    {
+        static const GroupTables t;
+        return t;
+    }
+
+    inline unsigned value_length(std::uint32_t x)
+    {
+        return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4;
+    }
+
+    std::uint64_t encoded_size(const std::uint32_t *cols, std::uint64_t d)
+    {
+        std::uint64_t size = (d + 3) / 4;
+        for (std::uint64_t k = 0; k < d; k++)
+            size += value_length(k == 0 ? cols[0] : cols[k] - cols[k - 1]);
+        return size;
+    }
+
+    void encode_row(const std::uint32_t *cols, std::uint64_t d, std::uint8_t *out)
+    {
+        std::uint8_t *ctrl = out;
+        std::uint8_t *data = out + (d + 3) / 4;
+        std::memset(ctrl, 0, (d + 3) / 4);
+        for (std::uint64_t k = 0; k < d; k++)
+        {
+            std::uint32_t x = k == 0 ? cols[0] : cols[k] - cols[k - 1];
+            unsigned len = value_length(x);
+            ctrl[k / 4] = static_cast<std::uint8_t>(ctrl[k / 4] | ((len - 1) << (2 * (k % 4))));
+            for (unsigned b = 0; b < len; b++)
+                *data++ = static_cast<std::uint8_t>(x >> (8 * b));
+        }
+    }
+
+    void decode_scalar(const std::uint8_t *ctrl, std::uint32_t d, std::uint32_t *out)
+    {
+        const std::uint8_t *data = ctrl + (d + 3) / 4;
+        std::uint32_t prev = 0;
+        for (std::uint32_t k = 0; k < d; k++)
+        {
+            unsigned len = ((ctrl[k / 4] >> (2 * (k % 4))) & 3) + 1;
+            std::uint32_t x = 0;
+            for (unsigned b = 0; b < len; b++)
+                x |= static_cast<std::uint32_t>(data[b]) << (8 * b);
+            data += len;
+            prev += x;
+            out[k] = prev;
+        }
+    }
+
+#ifdef COMPRESSED_X86_DECODER
+    __attribute__((target("ssse3"))) void decode_ssse3(const std::uint8_t *ctrl, std::uint32_t d, std::uint32_t *out)
+    {
+        const GroupTables &t = tables();
+        const std::uint32_t groups = (d + 3) / 4;
+        const std::uint8_t *data = ctrl + groups;
+        __m128i prev = _mm_setzero_si128();
+        for (std::uint32_t g = 0; g < groups; g++)
+        {
+            const std::uint8_t c = ctrl[g];
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            v = _mm_shuffle_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(t.shuffle[c])));
+            data += t.length[c];
+            // Prefix sum of the four deltas plus the last value so far
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, prev);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * g), v);
+            prev = _mm_shuffle_epi32(v, 0xFF);
+        }
+    }
+#endif
+
+    unsigned coding_width(WeightCoding coding)
+    {
+        switch (coding)
+        {
+        case WeightCoding::None:
+            return 0;
+        case WeightCoding::U8:
+        case WeightCoding::Quant8:
+            return 1;
+        case WeightCoding::U16:
+        case WeightCoding::Quant16:
+            return 2;
+        case WeightCoding::U32:
+        case WeightCoding::F32:
+            return 4;
+        case WeightCoding::F64:
+            return 8;
+        }
+        return 0;
+    }
+
+    struct WeightStats
+    {
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        bool integral = true; // non-negative integers
+        bool single = true;   // exact as float
+    };
+
+    WeightCoding choose_coding(const WeightStats &s, unsigned weight_bits, double &offset, double &scale)
+    {
+        offset = 0.0;
+        scale = 1.0;
+        if (weight_bits == 8 || weight_bits == 16)
+        {
+            const double levels = weight_bits == 8 ? 255.0 : 65535.0;
+            offset = s.min;
+            scale = s.max > s.min ? (s.max - s.min) / levels : 1.0;
+            return weight_bits == 8 ? WeightCoding::Quant8 : WeightCoding::Quant16;
+        }
+        if (weight_bits != 0)
+            throw std::invalid_argument("CompressedGraph: weight_bits must be 0, 8 or 16");
+        if (s.integral && s.max < 256.0)
+            return WeightCoding::U8;
+        if (s.integral && s.max < 65536.0)
+            return WeightCoding::U16;
+        if (s.integral && s.max < 4294967296.0)
+            return WeightCoding::U32;
+        return s.single ? WeightCoding::F32 : WeightCoding::F64;
+    }
+}
+
+CompressedGraph::CompressedGraph(WeightCoding coding, double offset, double scale)
+    : m_coding(coding), m_offset(offset), m_scale(scale)
+{
+}
+
+CompressedGraph::CompressedGraph(const GraphCache &cache, const CompressedGraphOptions &options)
+{
+    const unsigned nthreads = resolve_threads(options.nthreads);
+    const auto n = undirected_vertices<std::uint32_t>(cache, "CompressedGraph");
+
+    // Directed entries per row before merging, and the weight range
+    std::vector<std::uint64_t> raw(std::uint64_t(n) + 1, 0);
+    std::vector<WeightStats> stats(nthreads);
+    for_each_undirected_entry(cache, nthreads, [&](std::uint64_t i, std::uint64_t j, std::uint64_t k, unsigned t)
+                              {
+        __atomic_fetch_add(&raw[i], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&raw[j], 1, __ATOMIC_RELAXED);
+        if (!cache.weights)
+            return;
+        WeightStats &s = stats[t];
+        double w = cache.weights[k];
+        s.min = std::min(s.min, w);
+        s.max = std::max(s.max, w);
+        s.integral = s.integral && w >= 0.0 && std::floor(w) == w;
+        s.single = s.single && static_cast<double>(static_cast<float>(w)) == w; });
+    if (cache.weights)
+    {
+        WeightStats all;
+        for (const WeightStats &s : stats)
+        {
+            all.min = std::min(all.min, s.min);
+            all.max = std::max(all.max, s.max);
+            all.integral = all.integral && s.integral;
+            all.single = all.single && s.single;
+        }
+        if (all.min > all.max)
+            all.min = all.max = 1.0;
+        m_coding = choose_coding(all, options.weight_bits, m_offset, m_scale);
+    }
+
+    // Rows [first, last) staged per pass: every pass scans the cache for
+    // the entries landing in its rows
+    std::vector<std::uint64_t> ptr, fill, compact_ptr;
+    std::vector<std::uint32_t> cols, compact_cols;
+    std::vector<double> w, compact_w;
+    std::vector<std::vector<std::pair<std::uint32_t, double>>> scratch(nthreads);
+    for (std::uint32_t first = 0; first < n;)
+    {
+        std::uint32_t last = first;
+        std::uint64_t staged = 0;
+        while (last < n && (last == first || staged + raw[last] <= options.block_entries))
+            staged += raw[last++];
+
+        const std::uint32_t count = last - first;
+        ptr.assign(std::uint64_t(count) + 1, 0);
+        for (std::uint32_t r = 0; r < count; r++)
+            ptr[r + 1] = ptr[r] + raw[first + r];
+        fill.assign(ptr.begin(), ptr.end() - 1);
+        cols.resize(staged);
+        w.resize(cache.weights ? staged : 0);
+        for_each_undirected_entry(cache, nthreads, [&](std::uint64_t i, std::uint64_t j, std::uint64_t k, unsigned)
+                                  {
+            for (auto [row, col] : {std::pair{i, j}, std::pair{j, i}})
+            {
+                if (row < first || row >= last)
+                    continue;
+                std::uint64_t pos = __atomic_fetch_add(&fill[row - first], 1, __ATOMIC_RELAXED);
+                cols[pos] = static_cast<std::uint32_t>(col);
+                if (cache.weights)
+                    w[pos] = cache.weights[k];
+            } });
+
+        // Sort every row, keep the lightest of equal columns
+        std::vector<std::uint64_t> &length = fill;
+        parallel_for_dynamic(nthreads, count, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                             {
+            auto &row = scratch[t];
+            for (std::uint64_t r = b; r < e; r++)
+            {
+                row.clear();
+                for (std::uint64_t k = ptr[r]; k < ptr[r + 1]; k++)
+                    row.emplace_back(cols[k], cache.weights ? w[k] : 1.0);
+                std::sort(row.begin(), row.end());
+                std::uint64_t len = 0;
+                for (std::size_t k = 0; k < row.size(); k++)
+                {
+                    if (k > 0 && row[k].first == row[k - 1].first)
+                        continue;
+                    cols[ptr[r] + len] = row[k].first;
+                    if (cache.weights)
+                        w[ptr[r] + len] = row[k].second;
+                    len++;
+                }
+                length[r] = len;
+            } });
+
+        compact_ptr.assign(std::uint64_t(count) + 1, 0);
+        for (std::uint32_t r = 0; r < count; r++)
+            compact_ptr[r + 1] = compact_ptr[r] + length[r];
+        compact_cols.resize(compact_ptr[count]);
+        compact_w.resize(cache.weights ? compact_ptr[count] : 0);
+        parallel_for(nthreads, count, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t r = b; r < e; r++)
+            {
+                std::copy_n(cols.begin() + ptr[r], length[r], compact_cols.begin() + compact_ptr[r]);
+                if (cache.weights)
+                    std::copy_n(w.begin() + ptr[r], length[r], compact_w.begin() + compact_ptr[r]);
+            } });
+        append_rows(count, compact_ptr.data(), compact_cols.data(), cache.weights ? compact_w.data() : nullptr,
+                    nthreads);
+        first = last;
+    }
+}
+
+void CompressedGraph::append_rows(std::uint32_t count, const std::uint64_t *row_ptr, const std::uint32_t *cols,
+                                  const double *weights, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    const std::uint64_t base_row = n();
+    const std::uint64_t base_entry = entries();
+
+    // Encoded sizes, then every row in place
+    m_byte_ptr.resize(base_row + count + 1);
+    m_entry_ptr.resize(base_row + count + 1);
+    parallel_for_dynamic(nthreads, count, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t r = b; r < e; r++)
+            m_byte_ptr[base_row + r + 1] = encoded_size(cols + row_ptr[r], row_ptr[r + 1] - row_ptr[r]); });
+    for (std::uint64_t r = 0; r < count; r++)
+    {
+        m_byte_ptr[base_row + r + 1] += m_byte_ptr[base_row + r];
+        m_entry_ptr[base_row + r + 1] = base_entry + row_ptr[r + 1] - row_ptr[0];
+    }
+    m_bytes.resize(m_byte_ptr.back() + PADDING);
+    std::fill(m_bytes.end() - PADDING, m_bytes.end(), 0);
+
+    const unsigned width = coding_width(m_coding);
+    m_weights.resize((entries()) * width);
+    parallel_for_dynamic(nthreads, count, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t r = b; r < e; r++)
+        {
+            const std::uint64_t d = row_ptr[r + 1] - row_ptr[r];
+            encode_row(cols + row_ptr[r], d, m_bytes.data() + m_byte_ptr[base_row + r]);
+            std::uint8_t *out = m_weights.data() + (m_entry_ptr[base_row + r]) * width;
+            for (std::uint64_t k = 0; k < d && width > 0; k++)
+            {
+                const double x = weights[row_ptr[r] + k];
+                const double level = std::nearbyint((x - m_offset) / m_scale);
+                switch (m_coding)
+                {
+                case WeightCoding::U8:
+                    out[k] = static_cast<std::uint8_t>(x);
+                    break;
+                case WeightCoding::Quant8:
+                    out[k] = static_cast<std::uint8_t>(std::clamp(level, 0.0, 255.0));
+                    break;
+                case WeightCoding::U16:
+                case WeightCoding::Quant16:
+                {
+                    auto v = static_cast<std::uint16_t>(m_coding == WeightCoding::U16 ? x : std::clamp(level, 0.0, 65535.0));
+                    std::memcpy(out + 2 * k, &v, 2);
+                    break;
+                }
+                case WeightCoding::U32:
+                {
+                    auto v = static_cast<std::uint32_t>(x);
+                    std::memcpy(out + 4 * k, &v, 4);
+                    break;
+                }
+                case WeightCoding::F32:
+                {
+                    auto v = static_cast<float>(x);
+                    std::memcpy(out + 4 * k, &v, 4);
+                    break;
+                }
+                default:
+                    std::memcpy(out + 8 * k, &x, 8);
+                    break;
+                }
+            }
+        } });
+}
+
+std::uint64_t CompressedGraph::bytes() const
+{
+    return (m_entry_ptr.size() + m_byte_ptr.size()) * sizeof(std::uint64_t) + m_bytes.size() + m_weights.size();
+}
+
+void CompressedGraph::neighbors(std::uint32_t v, std::uint32_t *out, bool simd) const
+{
+    const std::uint8_t *row = m_bytes.data() + m_byte_ptr[v];
+#ifdef COMPRESSED_X86_DECODER
+    static const bool has_ssse3 = simd_supported();
+    if (simd && has_ssse3)
+    {
+        decode_ssse3(row, degree(v), out);
+        return;
+    }
+#endif
+    (void)simd;
+    decode_scalar(row, degree(v), out);
+}
+
+void CompressedGraph::weights(std::uint32_t v, double *out) const
+{
+    const std::uint32_t d = degree(v);
+    const unsigned width = coding_width(m_coding);
+    const std::uint8_t *in = m_weights.data() + m_entry_ptr[v] * width;
+    for (std::uint32_t k = 0; k < d; k++)
+    {
+        switch (m_coding)
+        {
+        case WeightCoding::None:
+            out[k] = 1.0;
+            break;
+        case WeightCoding::U8:
+            out[k] = in[k];
+            break;
+        case WeightCoding::Quant8:
+            out[k] = m_offset + m_scale * in[k];
+            break;
+        case WeightCoding::U16:
+        case WeightCoding::Quant16:
+        {
+            std::uint16_t x;
+            std::memcpy(&x, in + 2 * k, 2);
+            out[k] = m_coding == WeightCoding::U16 ? x : m_offset + m_scale * x;
+            break;
+        }
+        case WeightCoding::U32:
+        {
+            std::uint32_t x;
+            std::memcpy(&x, in + 4 * k, 4);
+            out[k] = x;
+            break;
+        }
+        case WeightCoding::F32:
+        {
+            float x;
+            std::memcpy(&x, in + 4 * k, 4);
+            out[k] = x;
+            break;
+        }
+        case WeightCoding::F64:
+            std::memcpy(out + k, in + 8 * k, 8);
+            break;
+        }
+    }
+}
+
+void CompressedGraph::decode_rows(std::uint32_t first, std::uint32_t last, std::vector<std::uint64_t> &row_ptr,
+                                  std::vector<std::uint64_t> &cols, std::vector<double> &weights) const
+{
+    const std::uint64_t base = m_entry_ptr[first];
+    const std::uint64_t count = m_entry_ptr[last] - base;
+    row_ptr.resize(last - first + 1);
+    for (std::uint32_t v = first; v <= last; v++)
+        row_ptr[v - first] = m_entry_ptr[v] - base;
+    cols.resize(count);
+    weights.resize(count);
+    std::vector<std::uint32_t> buffer;
+    for (std::uint32_t v = first; v < last; v++)
+    {
+        buffer.resize(degree(v) + 3);
+        neighbors(v, buffer.data());
+        std::copy_n(buffer.begin(), degree(v), cols.begin() + row_ptr[v - first]);
+        this->weights(v, weights.data() + row_ptr[v - first]);
+    }
+}
+
+bool CompressedGraph::simd_supported()
+{
+#ifdef COMPRESSED_X86_DECODER
+    return __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+const char *CompressedGraph::coding_name(WeightCoding coding)
+{
+    switch (coding)
+    {
+    case WeightCoding::None:
+        return "none";
+    case WeightCoding::U8:
+        return "u8";
+    case WeightCoding::U16:
+        return "u16";
+    case WeightCoding::U32:
+        return "u32";
+    case WeightCoding::F32:
+        return "f32";
+    case WeightCoding::F64:
+        return "f64";
+    case WeightCoding::Quant8:
+        return "quant8";
+    case WeightCoding::Quant16:
+        return "quant16";
+    }
+    return "?";
+}
@@ -0,0 +1,106 @@
+#ifndef COMPRESSED_GRAPH_HPP
+#define COMPRESSED_GRAPH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "graph_cache.h"
+
+//--------------------------------------------------------------------
+// Compressed adjacency store.
+//
+// Every row keeps its neighbours ascending as deltas (the first one
+// absolute) in Stream VByte form: one control byte per group of four
+// values, two bits per value giving its length of 1-4 bytes, followed by
+// the data bytes of the row. Decoding a group is a table lookup of the
+// control byte, one PSHUFB and a prefix sum in SSE registers (SSSE3,
+// picked at run time; scalar elsewhere).
+//
+// Weights are stored per entry in the narrowest lossless form (8, 16 or
+// 32-bit integers, float or double) or, on request, quantized linearly
+// to 8 or 16 bits between the smallest and the largest weight.
+// Quantization is lossy: forests and counts built on it may differ from
+// the exact ones.
+//
+// Built from a graph cache the store holds the undirected simple graph:
+// both directions of every entry, self loops dropped, parallel entries
+// merged keeping the lightest. Rows are staged in blocks of at most
+// block_entries directed entries, so the uncompressed form of the whole
+// graph is never held in memory. Rows can also be appended directly.
+//--------------------------------------------------------------------
+
+enum class WeightCoding : std::uint8_t
+{
+    None, // pattern graph, every weight reads as 1
+    U8,
+    U16,
+    U32,
+    F32,
+    F64,
+    Quant8,
+    Quant16
+};
+
+struct CompressedGraphOptions
+{
+    unsigned weight_bits = 0;                          // 0: lossless, 8 or 16: quantized
+    std::uint64_t block_entries = std::uint64_t(1) << 26; // directed entries staged per build pass
+    unsigned nthreads = 0;                             // 0: $GRAPH_THREADS or the number of cores
+};
+
+class CompressedGraph
+{
+public:
+    CompressedGraph() = default;
+
+    // Undirected graph of the cache, vertices [0, max(n, max_index + 1))
+    CompressedGraph(const GraphCache &cache, const CompressedGraphOptions &options = {});
+
+    // Empty store whose rows are added with append_rows; scale and offset
+    // describe the quantization levels (weight = offset + level * scale)
+    explicit CompressedGraph(WeightCoding coding, double offset = 0.0, double scale = 1.0);
+
+    // Appends count rows: row k has the strictly ascending columns
+    // cols[row_ptr[k] .. row_ptr[k + 1]) and their weights (ignored for
+    // WeightCoding::None, may then be null)
+    void append_rows(std::uint32_t count, const std::uint64_t *row_ptr, const std::uint32_t *cols,
+                     const double *weights, unsigned nthreads = 0);
+
+    std::uint32_t n() const { return static_cast<std::uint32_t>(m_entry_ptr.size() - 1); }
+    std::uint64_t entries() const { return m_entry_ptr.back(); }
+    std::uint32_t degree(std::uint32_t v) const
+    {
+        return static_cast<std::uint32_t>(m_entry_ptr[v + 1] - m_entry_ptr[v]);
+    }
+    WeightCoding coding() const { return m_coding; }
+
+    // Bytes held: offsets, encoded neighbours and weights
+    std::uint64_t bytes() const;
+
+    // Neighbours of v, ascending, into out[0, degree(v)). out must have
+    // room for degree(v) + 3 values: the SIMD decoder writes whole groups.
+    void neighbors(std::uint32_t v, std::uint32_t *out, bool simd = true) const;
+
+    // Weights of the entries of v in neighbour order
+    void weights(std::uint32_t v, double *out) const;
+
+    // CSR slice of rows [first, last) with row_ptr starting at 0, for
+    // building library matrices block by block
+    void decode_rows(std::uint32_t first, std::uint32_t last, std::vector<std::uint64_t> &row_ptr,
+                     std::vector<std::uint64_t> &cols, std::vector<double> &weights) const;
+
+    // False if the CPU has no SSSE3, so neighbors() always decodes scalar
+    static bool simd_supported();
+    static const char *coding_name(WeightCoding coding);
+
+private:
+    std::vector<std::uint64_t> m_entry_ptr{0}; // n + 1
+    std::vector<std::uint64_t> m_byte_ptr{0};  // n + 1, into m_bytes
+    std::vector<std::uint8_t> m_bytes;         // padded for 16-byte loads
+    std::vector<std::uint8_t> m_weights;       // entries() * width
+    WeightCoding m_coding = WeightCoding::None;
+    double m_offset = 0.0;
+    double m_scale = 1.0;
+};
+
+#endif // COMPRESSED_GRAPH_HPP
@@ -0,0 +1,215 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "graph_cache.h"
+#include "graph_parser.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static char *cache_path_for(const char *src_path)
+{
+    size_t len = strlen(src_path);
+    char *path = malloc(len + sizeof(GRAPH_CACHE_SUFFIX));
+    if (path == NULL)
+        return NULL;
+    memcpy(path, src_path, len);
+    memcpy(path + len, GRAPH_CACHE_SUFFIX, sizeof(GRAPH_CACHE_SUFFIX));
+    return path;
+}
+
+static size_t image_length(uint64_t n, uint64_t nnz, uint32_t flags)
+{
+    size_t length = sizeof(GraphCacheHeader) + (n + 1) * sizeof(uint64_t) + nnz * sizeof(uint64_t);
+    if (flags & GRAPH_CACHE_WEIGHTED)
+        length += nnz * sizeof(double);
+    return length;
+}
+
+static void attach_sections(GraphCache *cache)
+{
+    char *p = (char *)cache->base + sizeof(GraphCacheHeader);
+    cache->row_ptr = (const uint64_t *)p;
+    p += (cache->header.n + 1) * sizeof(uint64_t);
+    cache->col_idx = (const uint64_t *)p;
+    p += cache->header.nnz * sizeof(uint64_t);
+    cache->weights = (cache->header.flags & GRAPH_CACHE_WEIGHTED) ? (const double *)p : NULL;
+}
+
+static int try_map_cache(const char *cache_path, const struct stat *src, GraphCache *cache)
+{
+    int fd = open(cache_path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(GraphCacheHeader))
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+
+    const GraphCacheHeader *h = (const GraphCacheHeader *)base;
+    if (h->magic != GRAPH_CACHE_MAGIC || h->version != GRAPH_CACHE_VERSION ||
+        h->src_size != (uint64_t)src->st_size || h->src_mtime != (int64_t)src->st_mtim.tv_sec ||
+        h->src_mtime_ns != (int64_t)src->st_mtim.tv_nsec ||
+        image_length(h->n, h->nnz, h->flags) != (size_t)st.st_size)
+    {
+        munmap(base, (size_t)st.st_size);
+        return -1;
+    }
+
+    cache->header = *h;
+    cache->base = base;
+    cache->length = (size_t)st.st_size;
+    cache->mapped = true;
+    attach_sections(cache);
+    return 0;
+}
+
+//--------------------------------------------------------------------
+// Public API
+//--------------------------------------------------------------------
+int graph_cache_alloc(uint64_t n, uint64_t nnz, uint32_t flags, GraphCache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+    size_t length = image_length(n, nnz, flags);
+    char *base = malloc(length);
+    if (base == NULL)
+        return -1;
+
+    GraphCacheHeader *h = (GraphCacheHeader *)base;
+    memset(h, 0, sizeof(*h));
+    h->magic = GRAPH_CACHE_MAGIC;
+    h->version = GRAPH_CACHE_VERSION;
+    h->flags = flags;
+    h->n = n;
+    h->nnz = nnz;
+
+    cache->header = *h;
+    cache->base = base;
+    cache->length = length;
+    cache->mapped = false;
+    attach_sections(cache);
+    return 0;
+}
+
+int graph_cache_save(const char *src_path, GraphCache *cache)
+{
+    struct stat src;
+    if (stat(src_path, &src) != 0)
+    {
+        fprintf(stderr, "graph_cache: cannot stat %s\n", src_path);
+        return -1;
+    }
+    cache->header.src_size = (uint64_t)src.st_size;
+    cache->header.src_mtime = (int64_t)src.st_mtim.tv_sec;
+    cache->header.src_mtime_ns = (int64_t)src.st_mtim.tv_nsec;
+    if (!cache->mapped)
+        *(GraphCacheHeader *)cache->base = cache->header;
+
+    // Write to a temporary file and rename, so readers never see a torn cache
+    char *cache_path = cache_path_for(src_path);
+    char *tmp_path = cache_path ? malloc(strlen(cache_path) + 5) : NULL;
+    bool written = false;
+    if (tmp_path != NULL)
+    {
+        sprintf(tmp_path, "%s.tmp", cache_path);
+        FILE *f = fopen(tmp_path, "wb");
+        if (f != NULL)
+        {
+            written = fwrite(&cache->header, sizeof(GraphCacheHeader), 1, f) == 1;
+            size_t body = cache->length - sizeof(GraphCacheHeader);
+            written = written && fwrite((const char *)cache->base + sizeof(GraphCacheHeader), 1, body, f) == body;
+            written = (fclose(f) == 0) && written;
+            written = written && rename(tmp_path, cache_path) == 0;
+            if (!written)
+                unlink(tmp_path);
+        }
+    }
+    free(tmp_path);
+    free(cache_path);
+    return written ? 0 : -1;
+}
+
+int graph_cache_store(const char *src_path, const GraphEdgeList *edges, GraphCache *cache)
+{
+    struct stat src;
+    if (stat(src_path, &src) != 0)
+    {
+        fprintf(stderr, "graph_cache: cannot stat %s\n", src_path);
+        return -1;
+    }
+
+    GraphCache image;
+    if (graph_cache_alloc(edges->n, edges->nnz, edges->flags | GRAPH_CACHE_SORTED, &image) != 0)
+        return -1;
+    image.header.max_index = edges->max_index;
+
+    graph_edge_list_to_csr(edges, (uint64_t *)image.row_ptr, (uint64_t *)image.col_idx, (double *)image.weights, 0);
+
+    if (graph_cache_save(src_path, &image) != 0)
+        fprintf(stderr, "graph_cache: cannot write cache for %s, keeping it in memory\n", src_path);
+
+    if (cache != NULL)
+        *cache = image;
+    else
+        graph_cache_close(&image);
+    return 0;
+}
+
+int graph_cache_load(const char *src_path, GraphCache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    struct stat src;
+    if (stat(src_path, &src) != 0)
+    {
+        fprintf(stderr, "graph_cache: cannot stat %s\n", src_path);
+        return -1;
+    }
+
+    char *cache_path = cache_path_for(src_path);
+    if (cache_path == NULL)
+        return -1;
+    int hit = try_map_cache(cache_path, &src, cache);
+    free(cache_path);
+    if (hit == 0)
+        return 0;
+
+    GraphEdgeList edges;
+    if (graph_parse_file(src_path, 0, &edges) != 0)
+        return -1;
+
+    int info = graph_cache_store(src_path, &edges, cache);
+    graph_edge_list_free(&edges);
+    return info;
+}
+
+void graph_cache_close(GraphCache *cache)
+{
+    if (cache->base != NULL)
+    {
+        if (cache->mapped)
+            munmap(cache->base, cache->length);
+        else
+            free(cache->base);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+uint64_t graph_cache_vertices(const GraphCache *cache)
+{
+    if (cache->header.nnz > 0 && cache->header.max_index + 1 > cache->header.n)
+        return cache->header.max_index + 1;
+    return cache->header.n;
+}
@@ -0,0 +1,102 @@
+#ifndef GRAPH_CACHE_H
+#define GRAPH_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//--------------------------------------------------------------------
+// Binary CSR cache of a text graph (MatrixMarket or DIMACS).
+//
+// The cache lives next to the source file as "<source>.gcsr" and is
+// laid out as
+//
+//   GraphCacheHeader | row_ptr[n + 1] | col_idx[nnz] | weights[nnz]
+//
+// with all indices 0-based and every section 8-byte aligned, so the
+// arrays can be used straight from the mapping. It is rebuilt when the
+// source file's size or mtime changes or the format version differs.
+//--------------------------------------------------------------------
+
+#define GRAPH_CACHE_MAGIC 0x52534347u /* "GCSR" */
+#define GRAPH_CACHE_VERSION 1u
+#define GRAPH_CACHE_SUFFIX ".gcsr"
+
+enum
+{
+    GRAPH_CACHE_SYMMETRIC = 1u << 0, // MatrixMarket "symmetric": only one triangle is stored
+    GRAPH_CACHE_SORTED = 1u << 1,    // columns are ascending inside every row
+    GRAPH_CACHE_WEIGHTED = 1u << 2,  // weights[] section is present
+    GRAPH_CACHE_DIMACS = 1u << 3     // parsed from a DIMACS "p"/"a" file
+};
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t n;          // number of vertices (max of declared and observed)
+    uint64_t nnz;        // number of stored entries
+    uint64_t src_size;   // st_size of the source file
+    int64_t src_mtime;   // st_mtim of the source file, seconds
+    int64_t src_mtime_ns; // st_mtim of the source file, nanoseconds
+    uint64_t max_index;  // largest 0-based vertex id seen in the entries
+} GraphCacheHeader;
+
+// One parsed entry, 0-based
+typedef struct
+{
+    uint64_t i;
+    uint64_t j;
+    double value;
+} GraphEdge;
+
+// Parser output, see graph_parser.h
+typedef struct GraphEdgeList GraphEdgeList;
+
+typedef struct
+{
+    GraphCacheHeader header;
+    const uint64_t *row_ptr;
+    const uint64_t *col_idx;
+    const double *weights; // NULL for pattern graphs
+    void *base;            // mapping (mapped == true) or heap image
+    size_t length;
+    bool mapped;
+} GraphCache;
+
+// Opens the cache for src_path, parsing and writing it first when it is
+// missing or stale. If the cache file cannot be written the graph is
+// kept in an in-memory image instead. Returns 0 on success.
+int graph_cache_load(const char *src_path, GraphCache *cache);
+
+// Builds the CSR image of edges and writes it as the cache of src_path.
+// The image is returned in cache when it is not NULL.
+int graph_cache_store(const char *src_path, const GraphEdgeList *edges, GraphCache *cache);
+
+// Allocates an in-memory image for n vertices and nnz entries (with a
+// weights section if flags has GRAPH_CACHE_WEIGHTED): header filled in,
+// sections attached, contents uninitialized. Returns 0 on success.
+int graph_cache_alloc(uint64_t n, uint64_t nnz, uint32_t flags, GraphCache *cache);
+
+// Stamps the image with the size and mtime of src_path and writes it as
+// that file's cache. Returns 0 on success.
+int graph_cache_save(const char *src_path, GraphCache *cache);
+
+void graph_cache_close(GraphCache *cache);
+
+// Vertices of the graph: the declared size, raised to max_index + 1 when
+// an entry lies beyond it
+uint64_t graph_cache_vertices(const GraphCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRAPH_CACHE_H
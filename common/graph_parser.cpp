@@ -0,0 +1,320 @@
+#include "graph_parser.h"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t MIN_CHUNK_BYTES = 1 << 20;
+    constexpr std::uint64_t SORT_BLOCK_ROWS = 4096;
+
+    struct EdgeListImpl
+    {
+        std::vector<std::vector<GraphEdge>> buffers;
+        std::vector<const GraphEdge *> chunks;
+        std::vector<std::uint64_t> chunk_sizes;
+    };
+
+    struct ChunkResult
+    {
+        std::vector<GraphEdge> edges;
+        std::uint64_t max_index = 0;
+        bool weighted = false;
+    };
+
+    // $GRAPH_PARSE_THREADS takes precedence over the generic setting
+    unsigned parse_threads(unsigned nthreads)
+    {
+        if (nthreads == 0)
+        {
+            if (const char *env = std::getenv("GRAPH_PARSE_THREADS"))
+            {
+                int t = std::atoi(env);
+                if (t > 0)
+                    return static_cast<unsigned>(t);
+            }
+        }
+        return resolve_threads(nthreads);
+    }
+
+    inline const char *skip_blanks(const char *p, const char *end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    inline const char *line_end(const char *p, const char *end)
+    {
+        auto eol = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        return eol ? eol : end;
+    }
+
+    // Parses "[a] u v [w]" records in [p, end); everything else is skipped
+    void parse_chunk(const char *p, const char *end, ChunkResult &out)
+    {
+        while (p < end)
+        {
+            const char *eol = line_end(p, end);
+            const char *q = skip_blanks(p, eol);
+            p = (eol < end) ? eol + 1 : end;
+
+            if (q == eol || *q == '%' || *q == 'c' || *q == 'p')
+                continue;
+            if (*q == 'a')
+                q = skip_blanks(q + 1, eol);
+
+            std::uint64_t u = 0, v = 0;
+            auto r = std::from_chars(q, eol, u);
+            if (r.ec != std::errc())
+                continue;
+            r = std::from_chars(skip_blanks(r.ptr, eol), eol, v);
+            if (r.ec != std::errc())
+                continue;
+
+            double w = 1.0;
+            if (std::from_chars(skip_blanks(r.ptr, eol), eol, w).ec == std::errc())
+                out.weighted = true;
+            else
+                w = 1.0;
+
+            if (u == 0 || v == 0)
+                continue;
+            u--;
+            v--;
+            out.max_index = std::max(out.max_index, std::max(u, v));
+            out.edges.push_back({u, v, w});
+        }
+    }
+
+    // Reads the banner, comments and the size / "p" line. Returns the first
+    // byte of the entry section.
+    const char *parse_preamble(const char *p, const char *end, GraphEdgeList *list, std::uint64_t &nnz_hint)
+    {
+        while (p < end)
+        {
+            const char *eol = line_end(p, end);
+            const char *q = skip_blanks(p, eol);
+            const char *next = (eol < end) ? eol + 1 : end;
+
+            if (static_cast<std::size_t>(eol - q) >= 14 && std::strncmp(q, "%%MatrixMarket", 14) == 0)
+            {
+                std::string banner(q, eol);
+                std::transform(banner.begin(), banner.end(), banner.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                if (banner.find("symmetric") != std::string::npos)
+                    list->flags |= GRAPH_CACHE_SYMMETRIC;
+            }
+            else if (q == eol || *q == '\r' || *q == '%' || *q == 'c')
+            {
+            }
+            else if (*q == 'p')
+            {
+                // p <problem> <nodes> <arcs>
+                q = skip_blanks(q + 1, eol);
+                while (q < eol && *q != ' ' && *q != '\t')
+                    q++;
+                std::uint64_t nodes = 0;
+                auto r = std::from_chars(skip_blanks(q, eol), eol, nodes);
+                std::from_chars(skip_blanks(r.ptr, eol), eol, nnz_hint);
+                list->n = nodes;
+                list->flags |= GRAPH_CACHE_DIMACS;
+                return next;
+            }
+            else
+            {
+                // MatrixMarket size line: rows cols nnz
+                std::uint64_t rows = 0, cols = 0;
+                auto r = std::from_chars(q, eol, rows);
+                r = std::from_chars(skip_blanks(r.ptr, eol), eol, cols);
+                std::from_chars(skip_blanks(r.ptr, eol), eol, nnz_hint);
+                list->n = std::max(rows, cols);
+                return next;
+            }
+            p = next;
+        }
+        return end;
+    }
+
+    EdgeListImpl *attach_impl(GraphEdgeList *list, EdgeListImpl *impl)
+    {
+        list->impl = impl;
+        list->nchunks = impl->chunks.size();
+        list->chunks = impl->chunks.data();
+        list->chunk_sizes = impl->chunk_sizes.data();
+        list->nnz = 0;
+        for (auto size : impl->chunk_sizes)
+            list->nnz += size;
+        return impl;
+    }
+}
+
+extern "C" int graph_parse_file(const char *path, unsigned nthreads, GraphEdgeList *list)
+{
+    *list = GraphEdgeList{};
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        std::fprintf(stderr, "graph_parse_file: cannot open file %s\n", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    auto size = static_cast<std::size_t>(st.st_size);
+    const char *data = nullptr;
+    if (size > 0)
+    {
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            close(fd);
+            std::fprintf(stderr, "graph_parse_file: mmap failed for %s\n", path);
+            return -1;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(map);
+    }
+    close(fd);
+
+    const char *end = data + size;
+    std::uint64_t nnz_hint = 0;
+    const char *body = parse_preamble(data, end, list, nnz_hint);
+
+    // Newline-aligned chunk boundaries
+    auto body_size = static_cast<std::size_t>(end - body);
+    unsigned threads = parse_threads(nthreads);
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, body_size / MIN_CHUNK_BYTES + 1)));
+
+    std::vector<const char *> bounds(threads + 1, end);
+    bounds[0] = body;
+    for (unsigned t = 1; t < threads; t++)
+    {
+        const char *b = body + body_size / threads * t;
+        b = std::max(b, bounds[t - 1]);
+        bounds[t] = (b < end) ? std::min(end, line_end(b, end) + 1) : end;
+    }
+
+    std::vector<ChunkResult> results(threads);
+    run_threads(threads, [&](unsigned t)
+                {
+        auto bytes = static_cast<std::size_t>(bounds[t + 1] - bounds[t]);
+        std::uint64_t reserve = nnz_hint > 0 ? nnz_hint / threads + nnz_hint / threads / 16 + 16 : bytes / 12;
+        results[t].edges.reserve(reserve);
+        parse_chunk(bounds[t], bounds[t + 1], results[t]); });
+
+    if (data != nullptr)
+        munmap(const_cast<char *>(data), size);
+
+    auto impl = new EdgeListImpl();
+    for (auto &r : results)
+    {
+        if (r.weighted)
+            list->flags |= GRAPH_CACHE_WEIGHTED;
+        if (!r.edges.empty())
+            list->max_index = std::max(list->max_index, r.max_index);
+        impl->chunks.push_back(r.edges.data());
+        impl->chunk_sizes.push_back(r.edges.size());
+        impl->buffers.push_back(std::move(r.edges));
+    }
+    attach_impl(list, impl);
+    if (list->nnz > 0 && list->max_index + 1 > list->n)
+        list->n = list->max_index + 1;
+    return 0;
+}
+
+extern "C" void graph_edge_list_wrap(GraphEdge *edges, uint64_t nnz, uint64_t n, uint32_t flags, GraphEdgeList *list)
+{
+    *list = GraphEdgeList{};
+    auto impl = new EdgeListImpl();
+    impl->chunks.push_back(edges);
+    impl->chunk_sizes.push_back(nnz);
+    attach_impl(list, impl);
+    list->flags = flags;
+    for (uint64_t k = 0; k < nnz; k++)
+        list->max_index = std::max(list->max_index, std::max(edges[k].i, edges[k].j));
+    list->n = (nnz > 0 && list->max_index + 1 > n) ? list->max_index + 1 : n;
+}
+
+extern "C" void graph_edge_list_free(GraphEdgeList *list)
+{
+    delete static_cast<EdgeListImpl *>(list->impl);
+    *list = GraphEdgeList{};
+}
+
+extern "C" void graph_edge_list_to_csr(const GraphEdgeList *list, uint64_t *row_ptr, uint64_t *col_idx,
+                                       double *weights, unsigned nthreads)
+{
+    const std::uint64_t n = list->n;
+    const unsigned threads = static_cast<unsigned>(std::min<std::size_t>(parse_threads(nthreads), std::max<std::size_t>(1, list->nchunks)));
+
+    // Row counts, accumulated with relaxed atomics straight from the chunks
+    std::fill(row_ptr, row_ptr + n + 1, 0);
+    run_threads(threads, [&](unsigned t)
+                {
+        for (std::size_t c = t; c < list->nchunks; c += threads)
+            for (std::uint64_t k = 0; k < list->chunk_sizes[c]; k++)
+                __atomic_fetch_add(&row_ptr[list->chunks[c][k].i + 1], 1, __ATOMIC_RELAXED); });
+    for (std::uint64_t r = 0; r < n; r++)
+        row_ptr[r + 1] += row_ptr[r];
+
+    std::vector<std::uint64_t> cursor(row_ptr, row_ptr + n);
+    run_threads(threads, [&](unsigned t)
+                {
+        for (std::size_t c = t; c < list->nchunks; c += threads)
+        {
+            for (std::uint64_t k = 0; k < list->chunk_sizes[c]; k++)
+            {
+                const GraphEdge &e = list->chunks[c][k];
+                std::uint64_t pos = __atomic_fetch_add(&cursor[e.i], 1, __ATOMIC_RELAXED);
+                col_idx[pos] = e.j;
+                if (weights)
+                    weights[pos] = e.value;
+            }
+        } });
+
+    // Sort every row by (column, weight) so the image does not depend on
+    // the scatter order
+    const unsigned sort_threads = parse_threads(nthreads);
+    std::vector<std::vector<std::pair<std::uint64_t, double>>> scratch(sort_threads);
+    parallel_for_dynamic(sort_threads, n, SORT_BLOCK_ROWS, [&](std::uint64_t first, std::uint64_t last, unsigned t)
+                         {
+        auto &row = scratch[t];
+        for (std::uint64_t r = first; r < last; r++)
+        {
+            std::uint64_t b = row_ptr[r], e = row_ptr[r + 1];
+            if (e - b < 2)
+                continue;
+            if (weights == nullptr)
+            {
+                std::sort(col_idx + b, col_idx + e);
+                continue;
+            }
+            row.clear();
+            for (std::uint64_t k = b; k < e; k++)
+                row.emplace_back(col_idx[k], weights[k]);
+            std::sort(row.begin(), row.end());
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                col_idx[k] = row[k - b].first;
+                weights[k] = row[k - b].second;
+            }
+        } });
+}
@@ -0,0 +1,53 @@
+#ifndef GRAPH_PARSER_H
+#define GRAPH_PARSER_H
+
+#include "graph_cache.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//--------------------------------------------------------------------
+// Parallel MatrixMarket / DIMACS parser.
+//
+// The file is mmapped and split into newline-aligned chunks that are
+// parsed concurrently with std::from_chars. Every thread appends to its
+// own buffer; the buffers are handed out as they are (chunks[t]), never
+// concatenated. Comment lines ('%', 'c'), the MatrixMarket banner and
+// size line and the DIMACS "p" line are handled; DIMACS arcs are read
+// from "a" lines. Indices are converted to 0-based, entries with a zero
+// index are dropped, and a missing value column reads as weight 1.
+//--------------------------------------------------------------------
+
+struct GraphEdgeList
+{
+    size_t nchunks;
+    const GraphEdge *const *chunks;
+    const uint64_t *chunk_sizes;
+    uint64_t nnz;       // total entries over all chunks
+    uint64_t n;         // declared size, raised to max_index + 1 if needed
+    uint64_t max_index; // largest 0-based vertex id in the entries
+    uint32_t flags;     // GRAPH_CACHE_SYMMETRIC / WEIGHTED / DIMACS
+    void *impl;
+};
+
+// nthreads == 0 uses $GRAPH_PARSE_THREADS or the number of cores.
+// Returns 0 on success.
+int graph_parse_file(const char *path, unsigned nthreads, GraphEdgeList *list);
+
+// Wraps a caller-owned contiguous edge array as a one-chunk list.
+void graph_edge_list_wrap(GraphEdge *edges, uint64_t nnz, uint64_t n, uint32_t flags, GraphEdgeList *list);
+
+void graph_edge_list_free(GraphEdgeList *list);
+
+// Scatters the list into CSR arrays (row_ptr[n + 1], col_idx[nnz] and,
+// if not NULL, weights[nnz]) and sorts every row by column.
+void graph_edge_list_to_csr(const GraphEdgeList *list, uint64_t *row_ptr, uint64_t *col_idx, double *weights,
+                            unsigned nthreads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRAPH_PARSER_H
@@ -0,0 +1,312 @@
+#include "graph_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    constexpr int MAX_SITES = 256;
+    constexpr int BUCKETS = 64;
+    // Per-thread cap on buffered trace events (~32 bytes each)
+    constexpr std::size_t MAX_EVENTS_PER_THREAD = std::size_t(1) << 24;
+
+    enum class SiteKind
+    {
+        Timer,
+        Counter
+    };
+
+    struct Site
+    {
+        const char *name = nullptr;
+        const char *file = nullptr;
+        int line = 0;
+        SiteKind kind = SiteKind::Timer;
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> total{0};
+        std::atomic<std::uint64_t> min{UINT64_MAX};
+        std::atomic<std::uint64_t> max{0};
+        // bucket b holds durations in [2^(b-1), 2^b) ns, bucket 0 holds 0
+        std::atomic<std::uint64_t> buckets[BUCKETS] = {};
+    };
+
+    struct Event
+    {
+        std::uint64_t start;
+        std::uint64_t value; // duration in ns, or the counter increment
+        std::int32_t site;
+    };
+
+    struct ThreadEvents
+    {
+        std::uint32_t tid = 0;
+        std::vector<Event> events;
+        std::uint64_t dropped = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        Site sites[MAX_SITES];
+        std::atomic<int> nsites{0};
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+        const char *chrome_path = nullptr;
+        std::uint64_t epoch = 0;
+    };
+
+    // Never destroyed, so sites used from static destructors still work
+    Registry &registry()
+    {
+        static Registry *r = new Registry;
+        return *r;
+    }
+
+    std::uint64_t now_ns()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    void atomic_min(std::atomic<std::uint64_t> &slot, std::uint64_t v)
+    {
+        std::uint64_t cur = slot.load(std::memory_order_relaxed);
+        while (v < cur && !slot.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void atomic_max(std::atomic<std::uint64_t> &slot, std::uint64_t v)
+    {
+        std::uint64_t cur = slot.load(std::memory_order_relaxed);
+        while (v > cur && !slot.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    int bucket_of(std::uint64_t ns)
+    {
+        int b = 0;
+        while (ns > 0 && b < BUCKETS - 1)
+        {
+            ns >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    // Upper bound of the bucket holding the q-quantile sample, clamped to
+    // the observed range
+    std::uint64_t quantile(const Site &s, double q)
+    {
+        const std::uint64_t lo = s.min.load(std::memory_order_relaxed);
+        const std::uint64_t hi = s.max.load(std::memory_order_relaxed);
+        std::uint64_t calls = s.calls.load(std::memory_order_relaxed);
+        std::uint64_t target = static_cast<std::uint64_t>(q * static_cast<double>(calls));
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++)
+        {
+            seen += s.buckets[b].load(std::memory_order_relaxed);
+            if (seen > target)
+                return std::max(lo, std::min(hi, b == 0 ? 0 : (std::uint64_t(1) << b) - 1));
+        }
+        return hi;
+    }
+
+    ThreadEvents *thread_events()
+    {
+        thread_local ThreadEvents *mine = nullptr;
+        if (!mine)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.threads.push_back(std::make_unique<ThreadEvents>());
+            mine = r.threads.back().get();
+            mine->tid = static_cast<std::uint32_t>(r.threads.size());
+        }
+        return mine;
+    }
+
+    void push_event(int site, std::uint64_t start, std::uint64_t value)
+    {
+        ThreadEvents *te = thread_events();
+        if (te->events.size() < MAX_EVENTS_PER_THREAD)
+            te->events.push_back({start, value, site});
+        else
+            te->dropped++;
+    }
+
+    void report_at_exit()
+    {
+        Registry &r = registry();
+        graph_trace_report(stderr);
+        if (r.chrome_path && graph_trace_write_chrome(r.chrome_path) != 0)
+            std::fprintf(stderr, "graph_trace: cannot write %s\n", r.chrome_path);
+    }
+
+    void json_escaped(FILE *out, const char *s)
+    {
+        for (; *s; s++)
+        {
+            if (*s == '"' || *s == '\\')
+                std::fputc('\\', out);
+            std::fputc(*s, out);
+        }
+    }
+
+    int register_site(const char *name, const char *file, int line, SiteKind kind)
+    {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        int n = r.nsites.load(std::memory_order_relaxed);
+        for (int i = 0; i < n; i++)
+            if (r.sites[i].line == line && std::strcmp(r.sites[i].file, file) == 0 &&
+                std::strcmp(r.sites[i].name, name) == 0)
+                return i;
+        if (n == 0)
+        {
+            r.epoch = now_ns();
+            const char *path = std::getenv("GRAPH_TRACE_FILE");
+            r.chrome_path = (path && *path) ? path : nullptr;
+            std::atexit(report_at_exit);
+        }
+        if (n == MAX_SITES)
+        {
+            std::fprintf(stderr, "graph_trace: more than %d sites, %s:%d not traced\n", MAX_SITES, file, line);
+            return -1;
+        }
+        r.sites[n].name = name;
+        r.sites[n].file = file;
+        r.sites[n].line = line;
+        r.sites[n].kind = kind;
+        r.nsites.store(n + 1, std::memory_order_release);
+        return n;
+    }
+}
+
+extern "C"
+{
+    int graph_trace_site(const char *name, const char *file, int line)
+    {
+        return register_site(name, file, line, SiteKind::Timer);
+    }
+
+    int graph_trace_counter_site(const char *name, const char *file, int line)
+    {
+        return register_site(name, file, line, SiteKind::Counter);
+    }
+
+    uint64_t graph_trace_now(void)
+    {
+        return now_ns();
+    }
+
+    void graph_trace_record(int site, uint64_t start_ns)
+    {
+        if (site < 0)
+            return;
+        std::uint64_t d = now_ns() - start_ns;
+        Registry &r = registry();
+        Site &s = r.sites[site];
+        s.calls.fetch_add(1, std::memory_order_relaxed);
+        s.total.fetch_add(d, std::memory_order_relaxed);
+        s.buckets[bucket_of(d)].fetch_add(1, std::memory_order_relaxed);
+        atomic_min(s.min, d);
+        atomic_max(s.max, d);
+        if (r.chrome_path)
+            push_event(site, start_ns, d);
+    }
+
+    void graph_trace_count(int site, uint64_t value)
+    {
+        if (site < 0)
+            return;
+        Registry &r = registry();
+        Site &s = r.sites[site];
+        s.calls.fetch_add(1, std::memory_order_relaxed);
+        s.total.fetch_add(value, std::memory_order_relaxed);
+        if (r.chrome_path)
+            push_event(site, now_ns(), value);
+    }
+
+    void graph_trace_report(FILE *out)
+    {
+        Registry &r = registry();
+        int n = r.nsites.load(std::memory_order_acquire);
+        if (n == 0)
+            return;
+
+        std::vector<int> order(n);
+        for (int i = 0; i < n; i++)
+            order[i] = i;
+        // Timers by total time, counters after them
+        std::sort(order.begin(), order.end(), [&](int a, int b)
+                  {
+            const Site &x = r.sites[a], &y = r.sites[b];
+            if (x.kind != y.kind)
+                return x.kind == SiteKind::Timer;
+            return x.total.load() > y.total.load(); });
+
+        std::fprintf(out, "%-32s %10s %12s %10s %10s %10s %10s %10s  %s\n",
+                     "site", "calls", "total ms", "mean ns", "min ns", "p50 ns", "p99 ns", "max ns", "location");
+        for (int i : order)
+        {
+            const Site &s = r.sites[i];
+            std::uint64_t calls = s.calls.load();
+            std::uint64_t total = s.total.load();
+            if (s.kind == SiteKind::Counter)
+            {
+                std::fprintf(out, "%-32s %10llu %12s sum %llu  %s:%d\n", s.name, (unsigned long long)calls, "",
+                             (unsigned long long)total, s.file, s.line);
+                continue;
+            }
+            if (calls == 0)
+                continue;
+            std::fprintf(out, "%-32s %10llu %12.3f %10llu %10llu %10llu %10llu %10llu  %s:%d\n",
+                         s.name, (unsigned long long)calls, total / 1e6,
+                         (unsigned long long)(total / calls), (unsigned long long)s.min.load(),
+                         (unsigned long long)quantile(s, 0.5), (unsigned long long)quantile(s, 0.99),
+                         (unsigned long long)s.max.load(), s.file, s.line);
+        }
+    }
+
+    int graph_trace_write_chrome(const char *path)
+    {
+        Registry &r = registry();
+        FILE *out = std::fopen(path, "w");
+        if (!out)
+            return -1;
+
+        std::lock_guard<std::mutex> lock(r.mutex);
+        std::fprintf(out, "{\"traceEvents\":[\n");
+        bool first = true;
+        std::uint64_t dropped = 0;
+        for (const auto &te : r.threads)
+        {
+            dropped += te->dropped;
+            for (const Event &e : te->events)
+            {
+                const Site &s = r.sites[e.site];
+                std::fprintf(out, "%s{\"name\":\"", first ? "" : ",\n");
+                json_escaped(out, s.name);
+                double ts = (e.start - r.epoch) / 1e3;
+                if (s.kind == SiteKind::Counter)
+                    std::fprintf(out, "\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%llu}}",
+                                 ts, te->tid, (unsigned long long)e.value);
+                else
+                    std::fprintf(out, "\",\"cat\":\"graph\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                                 ts, e.value / 1e3, te->tid);
+                first = false;
+            }
+        }
+        std::fprintf(out, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%llu}}\n",
+                     (unsigned long long)dropped);
+        return std::fclose(out) == 0 ? 0 : -1;
+    }
+}
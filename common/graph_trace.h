@@ -0,0 +1,115 @@
+#ifndef GRAPH_TRACE_H
+#define GRAPH_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//--------------------------------------------------------------------
+// Call-site tracing for the hot loops of the drivers.
+//
+// TRACE_CALL(name, stmt) times one statement, TRACE_COUNT(name, value)
+// adds to a counter, and TRACE_SCOPE(name) (C++ only) times the rest of
+// the enclosing block. Each site registers itself once and then records
+// with relaxed atomics into a log2 histogram of durations. The summary
+// is printed to stderr at exit; when $GRAPH_TRACE_FILE is set, every
+// timed call is also written there as a Chrome trace_event JSON file
+// (chrome://tracing, Perfetto).
+//
+// Without -DGRAPH_TRACE (CMake option GRAPH_TRACE) the macros expand to
+// the bare statement and nothing is recorded.
+//--------------------------------------------------------------------
+
+// Return the id of the timer / counter site (name, file:line), registering it
+// on first use
+int graph_trace_site(const char *name, const char *file, int line);
+int graph_trace_counter_site(const char *name, const char *file, int line);
+uint64_t graph_trace_now(void);
+void graph_trace_record(int site, uint64_t start_ns);
+void graph_trace_count(int site, uint64_t value);
+
+// Per-site histogram summary; called at exit when any site was used
+void graph_trace_report(FILE *out);
+// Returns 0 on success
+int graph_trace_write_chrome(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define GRAPH_TRACE_CAT2_(a, b) a##b
+#define GRAPH_TRACE_CAT_(a, b) GRAPH_TRACE_CAT2_(a, b)
+
+#ifdef GRAPH_TRACE
+
+// The static id is cached with atomic loads and stores, since C has no
+// function-call initializer like TRACE_SCOPE's. Threads racing on the
+// first call all register; registration is serialized and returns the
+// same id for the same site, so any store wins. Release / acquire makes
+// the registered site visible to the threads that only load the id
+#define TRACE_CALL(name, stmt)                                                 \
+    do                                                                         \
+    {                                                                          \
+        static int trace_site_ = -1;                                           \
+        int trace_id_ = __atomic_load_n(&trace_site_, __ATOMIC_ACQUIRE);       \
+        if (trace_id_ < 0)                                                     \
+        {                                                                      \
+            trace_id_ = graph_trace_site(name, __FILE__, __LINE__);            \
+            __atomic_store_n(&trace_site_, trace_id_, __ATOMIC_RELEASE);       \
+        }                                                                      \
+        uint64_t trace_start_ = graph_trace_now();                             \
+        stmt;                                                                  \
+        graph_trace_record(trace_id_, trace_start_);                           \
+    } while (0)
+
+#define TRACE_COUNT(name, value)                                               \
+    do                                                                         \
+    {                                                                          \
+        static int trace_site_ = -1;                                           \
+        int trace_id_ = __atomic_load_n(&trace_site_, __ATOMIC_ACQUIRE);       \
+        if (trace_id_ < 0)                                                     \
+        {                                                                      \
+            trace_id_ = graph_trace_counter_site(name, __FILE__, __LINE__);    \
+            __atomic_store_n(&trace_site_, trace_id_, __ATOMIC_RELEASE);       \
+        }                                                                      \
+        graph_trace_count(trace_id_, (uint64_t)(value));                       \
+    } while (0)
+
+#ifdef __cplusplus
+class GraphTraceScope
+{
+public:
+    explicit GraphTraceScope(int site) : m_site(site), m_start(graph_trace_now()) {}
+    ~GraphTraceScope() { graph_trace_record(m_site, m_start); }
+    GraphTraceScope(const GraphTraceScope &) = delete;
+    GraphTraceScope &operator=(const GraphTraceScope &) = delete;
+
+private:
+    int m_site;
+    uint64_t m_start;
+};
+
+#define TRACE_SCOPE(name)                                                                       \
+    static const int GRAPH_TRACE_CAT_(trace_site_, __LINE__) = graph_trace_site(name, __FILE__, __LINE__); \
+    GraphTraceScope GRAPH_TRACE_CAT_(trace_scope_, __LINE__)(GRAPH_TRACE_CAT_(trace_site_, __LINE__))
+#endif
+
+#else
+
+#define TRACE_CALL(name, stmt) \
+    do                         \
+    {                          \
+        stmt;                  \
+    } while (0)
+#define TRACE_COUNT(name, value) ((void)0)
+#ifdef __cplusplus
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // GRAPH_TRACE
+
+#endif // GRAPH_TRACE_H
@@ -0,0 +1,149 @@
+#include "graph_types.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace
+{
+    struct Partial
+    {
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        bool integral = true;
+        bool float_exact = true;
+    };
+
+    const char *index_name(IndexType index)
+    {
+        return index == IndexType::U64 ? "u64" : "u32";
+    }
+
+    const char *weight_name(WeightType weight)
+    {
+        switch (weight)
+        {
+        case WeightType::U16:
+            return "u16";
+        case WeightType::U32:
+            return "u32";
+        case WeightType::F32:
+            return "f32";
+        case WeightType::F64:
+            return "f64";
+        }
+        return "?";
+    }
+}
+
+GraphTypeInfo graph_types_scan(const GraphCache &cache, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    GraphTypeInfo info;
+    info.vertices = graph_cache_vertices(&cache);
+
+    const std::uint64_t nnz = cache.header.nnz;
+    if (cache.weights && nnz > 0)
+    {
+        std::vector<Partial> partial(nthreads);
+        parallel_for(nthreads, nnz, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                     {
+            Partial p;
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const double w = cache.weights[k];
+                p.min = std::min(p.min, w);
+                p.max = std::max(p.max, w);
+                p.integral = p.integral && std::floor(w) == w;
+                p.float_exact = p.float_exact && static_cast<double>(static_cast<float>(w)) == w;
+            }
+            partial[t] = p; });
+        info.min_weight = std::numeric_limits<double>::infinity();
+        info.max_weight = -std::numeric_limits<double>::infinity();
+        for (const Partial &p : partial)
+        {
+            info.min_weight = std::min(info.min_weight, p.min);
+            info.max_weight = std::max(info.max_weight, p.max);
+            info.integral = info.integral && p.integral;
+            info.float_exact = info.float_exact && p.float_exact;
+        }
+    }
+
+    info.narrowest.index = IndexType::U32;
+    if (!graph_types_fit(info, info.narrowest))
+        info.narrowest.index = IndexType::U64;
+    for (WeightType weight : {WeightType::U16, WeightType::U32, WeightType::F32, WeightType::F64})
+    {
+        info.narrowest.weight = weight;
+        if (graph_types_fit(info, info.narrowest))
+            break;
+    }
+    return info;
+}
+
+IndexType graph_index_type(const GraphCache &cache)
+{
+    GraphTypeInfo info;
+    info.vertices = graph_cache_vertices(&cache);
+    return graph_types_fit(info, {IndexType::U32, WeightType::F64}) ? IndexType::U32 : IndexType::U64;
+}
+
+bool graph_types_fit(const GraphTypeInfo &info, GraphTypes types)
+{
+    if (types.index == IndexType::U32 && info.vertices >= std::numeric_limits<std::uint32_t>::max())
+        return false;
+    switch (types.weight)
+    {
+    case WeightType::U16:
+        return info.integral && info.min_weight >= 0.0 && info.max_weight <= 65535.0;
+    case WeightType::U32:
+        return info.integral && info.min_weight >= 0.0 && info.max_weight <= 4294967295.0;
+    case WeightType::F32:
+        return info.float_exact;
+    case WeightType::F64:
+        return true;
+    }
+    return false;
+}
+
+bool graph_types_parse(const std::string &name, GraphTypes &types)
+{
+    const std::size_t colon = name.find(':');
+    if (colon == std::string::npos)
+        return false;
+    const std::string index = name.substr(0, colon);
+    const std::string weight = name.substr(colon + 1);
+
+    GraphTypes parsed;
+    if (index == "u32")
+        parsed.index = IndexType::U32;
+    else if (index == "u64")
+        parsed.index = IndexType::U64;
+    else
+        return false;
+
+    static const std::pair<const char *, WeightType> weights[] = {
+        {"u16", WeightType::U16}, {"u32", WeightType::U32}, {"f32", WeightType::F32}, {"f64", WeightType::F64}};
+    for (const auto &[text, value] : weights)
+        if (weight == text)
+        {
+            parsed.weight = value;
+            types = parsed;
+            return true;
+        }
+    return false;
+}
+
+std::string graph_types_name(GraphTypes types)
+{
+    return std::string(index_name(types.index)) + ":" + weight_name(types.weight);
+}
+
+std::size_t graph_types_edge_bytes(GraphTypes types)
+{
+    return graph_types_dispatch(types, [](auto index, auto weight)
+                                { return 2 * sizeof(index) + sizeof(weight); });
+}
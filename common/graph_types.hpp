@@ -0,0 +1,102 @@
+#ifndef GRAPH_TYPES_HPP
+#define GRAPH_TYPES_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "graph_cache.h"
+
+//--------------------------------------------------------------------
+// Index and weight widths of the native kernels.
+//
+// The cache keeps 64-bit ids and double weights whatever the file holds,
+// but most inputs have fewer than 2^32 vertices and small integer
+// weights. The staging arrays and kernels of Borůvka and tc are
+// templated on the vertex id and weight types; graph_types_scan picks
+// the narrowest pair that represents the cache exactly:
+//  - ids: uint32_t below 2^32 - 1 vertices (the largest value is the
+//    kernels' sentinel), uint64_t above;
+//  - weights: uint16_t / uint32_t for non-negative integers up to their
+//    maximum, float when every weight survives the round trip, double
+//    otherwise. Pattern graphs read as weight 1.
+// graph_types_dispatch calls a generic lambda with value-initialized
+// objects of the chosen types, so callers instantiate their typed path
+// once per supported pair.
+//--------------------------------------------------------------------
+
+enum class IndexType : std::uint8_t
+{
+    U32,
+    U64
+};
+
+enum class WeightType : std::uint8_t
+{
+    U16,
+    U32,
+    F32,
+    F64
+};
+
+struct GraphTypes
+{
+    IndexType index = IndexType::U32;
+    WeightType weight = WeightType::F64;
+};
+
+struct GraphTypeInfo
+{
+    std::uint64_t vertices = 0; // max(n, max_index + 1)
+    double min_weight = 1.0;
+    double max_weight = 1.0;
+    bool integral = true;       // every weight is a whole number
+    bool float_exact = true;    // every weight equals its float rounding
+    GraphTypes narrowest;
+};
+
+// One parallel pass over the weights of the cache
+GraphTypeInfo graph_types_scan(const GraphCache &cache, unsigned nthreads = 0);
+
+// Narrowest id type alone, from the header (for pattern kernels)
+IndexType graph_index_type(const GraphCache &cache);
+
+// True if every id and weight of the scanned graph is exact in types
+bool graph_types_fit(const GraphTypeInfo &info, GraphTypes types);
+
+// "u32:u16", "u64:f32", ...: index, then weight
+bool graph_types_parse(const std::string &name, GraphTypes &types);
+std::string graph_types_name(GraphTypes types);
+
+// Bytes of one staged edge (two ids and a weight)
+std::size_t graph_types_edge_bytes(GraphTypes types);
+
+template <typename F>
+decltype(auto) graph_types_dispatch_weight(WeightType weight, F &&f)
+{
+    switch (weight)
+    {
+    case WeightType::U16:
+        return f(std::uint16_t{});
+    case WeightType::U32:
+        return f(std::uint32_t{});
+    case WeightType::F32:
+        return f(float{});
+    case WeightType::F64:
+        break;
+    }
+    return f(double{});
+}
+
+// f(index, weight) with Index and Weight objects of the types
+template <typename F>
+decltype(auto) graph_types_dispatch(GraphTypes types, F &&f)
+{
+    if (types.index == IndexType::U64)
+        return graph_types_dispatch_weight(types.weight, [&](auto weight)
+                                           { return f(std::uint64_t{}, weight); });
+    return graph_types_dispatch_weight(types.weight, [&](auto weight)
+                                       { return f(std::uint32_t{}, weight); });
+}
+
+#endif // GRAPH_TYPES_HPP
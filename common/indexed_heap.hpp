@@ -0,0 +1,143 @@
+#ifndef INDEXED_HEAP_HPP
+#define INDEXED_HEAP_HPP
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+//--------------------------------------------------------------------
+// Indexed d-ary min-heap over vertex ids [0, capacity) with decrease-key.
+//
+// Every vertex is stored at most once, so relaxing an already queued
+// vertex moves it up in place instead of adding a stale duplicate. All
+// storage is allocated in the constructor.
+//--------------------------------------------------------------------
+
+template <typename Key, unsigned D = 4>
+class IndexedDaryHeap
+{
+public:
+    struct Stats
+    {
+        std::uint64_t pushes = 0;    // vertices inserted
+        std::uint64_t decreases = 0; // keys lowered in place
+        std::uint64_t ignored = 0;   // relaxations that did not lower the key
+        std::uint64_t pops = 0;
+    };
+
+    explicit IndexedDaryHeap(std::uint32_t capacity)
+        : m_pos(capacity, NPOS)
+    {
+        m_keys.reserve(capacity);
+        m_items.reserve(capacity);
+    }
+
+    bool empty() const { return m_items.empty(); }
+    std::size_t size() const { return m_items.size(); }
+    bool contains(std::uint32_t v) const { return m_pos[v] != NPOS; }
+    const Stats &stats() const { return m_stats; }
+
+    // Inserts v with key, or lowers its key if it is already queued.
+    // Returns false when v was queued with a key that is not greater.
+    bool push_or_decrease(std::uint32_t v, Key key)
+    {
+        std::uint32_t i = m_pos[v];
+        if (i == NPOS)
+        {
+            i = static_cast<std::uint32_t>(m_items.size());
+            m_keys.push_back(key);
+            m_items.push_back(v);
+            m_pos[v] = i;
+            m_stats.pushes++;
+        }
+        else if (key < m_keys[i])
+        {
+            m_keys[i] = key;
+            m_stats.decreases++;
+        }
+        else
+        {
+            m_stats.ignored++;
+            return false;
+        }
+        sift_up(i);
+        return true;
+    }
+
+    // Removes and returns the (key, vertex) with the smallest key
+    std::pair<Key, std::uint32_t> pop()
+    {
+        std::pair<Key, std::uint32_t> top{m_keys[0], m_items[0]};
+        m_pos[top.second] = NPOS;
+        m_stats.pops++;
+
+        std::uint32_t last = static_cast<std::uint32_t>(m_items.size() - 1);
+        if (last > 0)
+        {
+            m_keys[0] = m_keys[last];
+            m_items[0] = m_items[last];
+            m_pos[m_items[0]] = 0;
+        }
+        m_keys.pop_back();
+        m_items.pop_back();
+        if (!m_items.empty())
+            sift_down(0);
+        return top;
+    }
+
+private:
+    static constexpr std::uint32_t NPOS = std::numeric_limits<std::uint32_t>::max();
+
+    void place(std::uint32_t i, Key key, std::uint32_t v)
+    {
+        m_keys[i] = key;
+        m_items[i] = v;
+        m_pos[v] = i;
+    }
+
+    void sift_up(std::uint32_t i)
+    {
+        Key key = m_keys[i];
+        std::uint32_t v = m_items[i];
+        while (i > 0)
+        {
+            std::uint32_t parent = (i - 1) / D;
+            if (!(key < m_keys[parent]))
+                break;
+            place(i, m_keys[parent], m_items[parent]);
+            i = parent;
+        }
+        place(i, key, v);
+    }
+
+    void sift_down(std::uint32_t i)
+    {
+        const std::uint32_t n = static_cast<std::uint32_t>(m_items.size());
+        Key key = m_keys[i];
+        std::uint32_t v = m_items[i];
+        for (;;)
+        {
+            std::uint32_t first = i * D + 1;
+            if (first >= n)
+                break;
+            std::uint32_t last = first + D < n ? first + D : n;
+            std::uint32_t best = first;
+            for (std::uint32_t c = first + 1; c < last; c++)
+                if (m_keys[c] < m_keys[best])
+                    best = c;
+            if (!(m_keys[best] < key))
+                break;
+            place(i, m_keys[best], m_items[best]);
+            i = best;
+        }
+        place(i, key, v);
+    }
+
+    std::vector<Key> m_keys;
+    std::vector<std::uint32_t> m_items;
+    std::vector<std::uint32_t> m_pos;
+    Stats m_stats;
+};
+
+#endif // INDEXED_HEAP_HPP
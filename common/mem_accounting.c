@@ -0,0 +1,179 @@
+#define _GNU_SOURCE
+
+#include "mem_accounting.h"
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+static _Atomic int64_t live_bytes;
+static _Atomic int64_t peak_bytes;
+static _Atomic uint64_t alloc_count;
+
+void graph_mem_count_alloc(size_t bytes)
+{
+    int64_t now = atomic_fetch_add_explicit(&live_bytes, (int64_t)bytes, memory_order_relaxed) + (int64_t)bytes;
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    int64_t peak = atomic_load_explicit(&peak_bytes, memory_order_relaxed);
+    while (now > peak &&
+           !atomic_compare_exchange_weak_explicit(&peak_bytes, &peak, now, memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+void graph_mem_count_free(size_t bytes)
+{
+    atomic_fetch_sub_explicit(&live_bytes, (int64_t)bytes, memory_order_relaxed);
+}
+
+// Overridden by the strong definition in mem_hooks.c
+__attribute__((weak)) bool graph_mem_all_allocations(void)
+{
+    return false;
+}
+
+//--------------------------------------------------------------------
+// Counting allocators. With the malloc hooks linked, malloc itself counts
+// and these pass through; otherwise a 16-byte header keeps the size.
+//--------------------------------------------------------------------
+
+#define HEADER 16
+
+void *graph_mem_malloc(size_t size)
+{
+    if (graph_mem_all_allocations())
+        return malloc(size);
+    unsigned char *p = malloc(size + HEADER);
+    if (p == NULL)
+        return NULL;
+    memcpy(p, &size, sizeof(size));
+    graph_mem_count_alloc(size);
+    return p + HEADER;
+}
+
+void *graph_mem_calloc(size_t count, size_t size)
+{
+    if (graph_mem_all_allocations())
+        return calloc(count, size);
+    if (size != 0 && count > (SIZE_MAX - HEADER) / size)
+        return NULL;
+    size_t bytes = count * size;
+    unsigned char *p = calloc(1, bytes + HEADER);
+    if (p == NULL)
+        return NULL;
+    memcpy(p, &bytes, sizeof(bytes));
+    graph_mem_count_alloc(bytes);
+    return p + HEADER;
+}
+
+void *graph_mem_realloc(void *ptr, size_t size)
+{
+    if (graph_mem_all_allocations())
+        return realloc(ptr, size);
+    if (ptr == NULL)
+        return graph_mem_malloc(size);
+    unsigned char *base = (unsigned char *)ptr - HEADER;
+    size_t old;
+    memcpy(&old, base, sizeof(old));
+    unsigned char *p = realloc(base, size + HEADER);
+    if (p == NULL)
+        return NULL;
+    memcpy(p, &size, sizeof(size));
+    graph_mem_count_free(old);
+    graph_mem_count_alloc(size);
+    return p + HEADER;
+}
+
+void graph_mem_free(void *ptr)
+{
+    if (graph_mem_all_allocations())
+    {
+        free(ptr);
+        return;
+    }
+    if (ptr == NULL)
+        return;
+    unsigned char *base = (unsigned char *)ptr - HEADER;
+    size_t size;
+    memcpy(&size, base, sizeof(size));
+    graph_mem_count_free(size);
+    free(base);
+}
+
+//--------------------------------------------------------------------
+// Resident set
+//--------------------------------------------------------------------
+
+// Value in kB of a "Key:   123 kB" line of /proc/self/status, -1 if absent
+static int64_t status_kb(const char *key)
+{
+    int fd = open("/proc/self/status", O_RDONLY);
+    if (fd < 0)
+        return -1;
+    char buf[4096];
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+    buf[len] = '\0';
+
+    size_t klen = strlen(key);
+    char *line = buf;
+    while (line)
+    {
+        if (strncmp(line, key, klen) == 0 && line[klen] == ':')
+            return strtoll(line + klen + 1, NULL, 10);
+        line = strchr(line, '\n');
+        if (line)
+            line++;
+    }
+    return -1;
+}
+
+// Resets VmHWM to the current RSS (Linux 4.0+)
+static bool reset_hwm(void)
+{
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0)
+        return false;
+    bool ok = write(fd, "5", 1) == 1;
+    close(fd);
+    return ok;
+}
+
+void graph_mem_phase_begin(GraphMemPhase *phase)
+{
+    memset(phase, 0, sizeof(*phase));
+    phase->hwm_per_phase = reset_hwm();
+    phase->live_start = atomic_load_explicit(&live_bytes, memory_order_relaxed);
+    phase->allocs = atomic_load_explicit(&alloc_count, memory_order_relaxed);
+    atomic_store_explicit(&peak_bytes, phase->live_start, memory_order_relaxed);
+}
+
+void graph_mem_phase_end(GraphMemPhase *phase)
+{
+    phase->live_end = atomic_load_explicit(&live_bytes, memory_order_relaxed);
+    phase->live_peak = atomic_load_explicit(&peak_bytes, memory_order_relaxed);
+    phase->allocs = atomic_load_explicit(&alloc_count, memory_order_relaxed) - phase->allocs;
+    phase->rss_kb = status_kb("VmRSS");
+    phase->rss_hwm_kb = status_kb("VmHWM");
+    if (phase->rss_hwm_kb < 0)
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        phase->rss_hwm_kb = usage.ru_maxrss;
+        phase->hwm_per_phase = false;
+    }
+}
+
+void graph_mem_print(FILE *out, const char *name, const GraphMemPhase *phase)
+{
+    const double mb = 1024.0 * 1024.0;
+    fprintf(out, "%s: live %.1f -> %.1f MB, peak %.1f MB, %llu allocs, RSS %.1f MB, RSS peak %.1f MB%s\n",
+            name, phase->live_start / mb, phase->live_end / mb, phase->live_peak / mb,
+            (unsigned long long)phase->allocs, phase->rss_kb / 1024.0, phase->rss_hwm_kb / 1024.0,
+            phase->hwm_per_phase ? "" : " (since start)");
+}
@@ -0,0 +1,63 @@
+#ifndef MEM_ACCOUNTING_H
+#define MEM_ACCOUNTING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//--------------------------------------------------------------------
+// Per-phase memory accounting.
+//
+// Two sources are combined:
+//  - live heap bytes, counted by the allocator functions below. They are
+//    handed to GraphBLAS through GxB_init / LAGr_Init, and when the
+//    executable links mem_hooks.c (CMake option GRAPH_MEM_HOOKS) malloc,
+//    calloc, realloc, free and therefore operator new/delete are
+//    interposed as well, so every heap allocation is counted;
+//  - the resident set: VmRSS and its high-water mark VmHWM from
+//    /proc/self/status. The mark is reset at the start of every phase
+//    through /proc/self/clear_refs when the kernel allows it, otherwise
+//    it is the peak since process start (getrusage off Linux).
+//--------------------------------------------------------------------
+
+typedef struct
+{
+    int64_t live_start;  // counted heap bytes when the phase began
+    int64_t live_end;    // ... and when it ended
+    int64_t live_peak;   // highest counted heap bytes during the phase
+    uint64_t allocs;     // allocations made during the phase
+    int64_t rss_kb;      // resident set at the end of the phase
+    int64_t rss_hwm_kb;  // resident high-water mark
+    bool hwm_per_phase;  // false: rss_hwm_kb is the peak since process start
+} GraphMemPhase;
+
+// Counting allocators, signature-compatible with GxB_init
+void *graph_mem_malloc(size_t size);
+void *graph_mem_calloc(size_t count, size_t size);
+void *graph_mem_realloc(void *ptr, size_t size);
+void graph_mem_free(void *ptr);
+
+// True when mem_hooks.c is linked and every heap allocation is counted
+bool graph_mem_all_allocations(void);
+
+void graph_mem_phase_begin(GraphMemPhase *phase);
+void graph_mem_phase_end(GraphMemPhase *phase);
+
+// One line: "<name>: live ..., peak ..., allocs ..., RSS ..., RSS peak ..."
+void graph_mem_print(FILE *out, const char *name, const GraphMemPhase *phase);
+
+// Used by mem_hooks.c
+void graph_mem_count_alloc(size_t bytes);
+void graph_mem_count_free(size_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_ACCOUNTING_H
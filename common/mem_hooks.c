@@ -0,0 +1,86 @@
+#define _GNU_SOURCE
+
+#include "mem_accounting.h"
+
+// Interposes the malloc family so that every heap allocation of the
+// process (operator new included) is counted. Link this file into the
+// executable, not into a library; glibc only.
+
+#ifdef __GLIBC__
+
+#include <errno.h>
+#include <malloc.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+bool graph_mem_all_allocations(void)
+{
+    return true;
+}
+
+static void *counted(void *p)
+{
+    if (p)
+        graph_mem_count_alloc(malloc_usable_size(p));
+    return p;
+}
+
+void *malloc(size_t size)
+{
+    return counted(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size)
+{
+    return counted(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void *p = __libc_realloc(ptr, size);
+    if (p == NULL)
+    {
+        // glibc frees ptr for size 0, otherwise ptr is untouched
+        if (ptr && size == 0)
+            graph_mem_count_free(old);
+        return NULL;
+    }
+    graph_mem_count_free(old);
+    return counted(p);
+}
+
+void free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+    graph_mem_count_free(malloc_usable_size(ptr));
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void *p = counted(__libc_memalign(alignment, size));
+    if (p == NULL)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//--------------------------------------------------------------------
+// Minimal std::thread helpers shared by the native kernels.
+//--------------------------------------------------------------------
+
+// requested == 0 uses $GRAPH_THREADS or the number of cores
+inline unsigned resolve_threads(unsigned requested)
+{
+    if (requested > 0)
+        return requested;
+    if (const char *env = std::getenv("GRAPH_THREADS"))
+    {
+        int t = std::atoi(env);
+        if (t > 0)
+            return static_cast<unsigned>(t);
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs f(t) for t in [0, nthreads), f(0) on the calling thread
+template <typename F>
+void run_threads(unsigned nthreads, F &&f)
+{
+    std::vector<std::thread> pool;
+    pool.reserve(nthreads);
+    for (unsigned t = 1; t < nthreads; t++)
+        pool.emplace_back(f, t);
+    f(0u);
+    for (auto &th : pool)
+        th.join();
+}
+
+// Static split of [0, count) into one contiguous range per thread:
+// f(begin, end, t)
+template <typename F>
+void parallel_for(unsigned nthreads, std::uint64_t count, F &&f)
+{
+    nthreads = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(nthreads, count)));
+    run_threads(nthreads, [&](unsigned t)
+                {
+        std::uint64_t begin = count * t / nthreads;
+        std::uint64_t end = count * (t + 1) / nthreads;
+        f(begin, end, t); });
+}
+
+// Dynamic schedule: threads grab blocks of `block` items until [0, count)
+// is exhausted, f(begin, end, t) per block
+template <typename F>
+void parallel_for_dynamic(unsigned nthreads, std::uint64_t count, std::uint64_t block, F &&f)
+{
+    std::atomic<std::uint64_t> next{0};
+    run_threads(nthreads, [&](unsigned t)
+                {
+        for (;;)
+        {
+            std::uint64_t begin = next.fetch_add(block, std::memory_order_relaxed);
+            if (begin >= count)
+                break;
+            f(begin, std::min(count, begin + block), t);
+        } });
+}
+
+// Work stealing over tasks [0, count) of uneven cost: task i starts on the
+// deque of thread i % nthreads, every thread runs its own deque from the
+// front (so lower tasks start first) and, once it is empty, steals from
+// the back of the others. f(task, t) per task
+template <typename F>
+void parallel_tasks(unsigned nthreads, std::uint64_t count, F &&f)
+{
+    nthreads = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(nthreads, count)));
+    struct alignas(64) Queue
+    {
+        std::mutex lock;
+        std::deque<std::uint64_t> tasks;
+    };
+    std::vector<Queue> queues(nthreads);
+    for (std::uint64_t i = 0; i < count; i++)
+        queues[i % nthreads].tasks.push_back(i);
+
+    run_threads(nthreads, [&](unsigned t)
+                {
+        for (;;)
+        {
+            std::uint64_t task = count;
+            for (unsigned k = 0; k < nthreads && task == count; k++)
+            {
+                Queue &q = queues[(t + k) % nthreads];
+                std::lock_guard<std::mutex> guard(q.lock);
+                if (q.tasks.empty())
+                    continue;
+                if (k == 0)
+                {
+                    task = q.tasks.front();
+                    q.tasks.pop_front();
+                }
+                else
+                {
+                    task = q.tasks.back();
+                    q.tasks.pop_back();
+                }
+            }
+            // No task is ever added, so empty deques everywhere mean done
+            if (task == count)
+                break;
+            f(task, t);
+        } });
+}
+
+#endif // PARALLEL_HPP
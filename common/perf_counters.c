@@ -0,0 +1,163 @@
+#define _GNU_SOURCE
+
+#include "perf_counters.h"
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *const COUNTER_NAMES[PERF_NCOUNTERS] = {
+    "cycles", "instructions", "llc_misses", "branch_misses", "dtlb_misses"};
+
+const char *perf_counter_name(int counter)
+{
+    return (counter >= 0 && counter < PERF_NCOUNTERS) ? COUNTER_NAMES[counter] : "unknown";
+}
+
+#ifdef __linux__
+
+static void event_attr(int counter, struct perf_event_attr *attr)
+{
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->type = PERF_TYPE_HARDWARE;
+    switch (counter)
+    {
+    case PERF_CYCLES:
+        attr->config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_LLC_MISSES:
+        attr->config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case PERF_BRANCH_MISSES:
+        attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case PERF_DTLB_MISSES:
+        attr->type = PERF_TYPE_HW_CACHE;
+        attr->config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    }
+    attr->disabled = 1;
+    attr->inherit = 1;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+}
+
+int perf_counters_open(PerfCounters *pc)
+{
+    memset(pc, 0, sizeof(*pc));
+    pc->leader = -1;
+    int first_errno = 0;
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+    {
+        struct perf_event_attr attr;
+        event_attr(c, &attr);
+        // Members follow the leader's enable state
+        if (pc->leader >= 0)
+            attr.disabled = 0;
+        pc->fd[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, pc->leader, 0);
+        if (pc->fd[c] < 0)
+        {
+            if (first_errno == 0)
+                first_errno = errno;
+            pc->fd[c] = -1;
+            continue;
+        }
+        if (pc->leader < 0)
+            pc->leader = pc->fd[c];
+    }
+
+    pc->available = pc->leader >= 0;
+    if (!pc->available)
+    {
+        if (first_errno == EACCES || first_errno == EPERM)
+            snprintf(pc->reason, sizeof(pc->reason),
+                     "perf_event_open: %s (check /proc/sys/kernel/perf_event_paranoid)", strerror(first_errno));
+        else
+            snprintf(pc->reason, sizeof(pc->reason), "perf_event_open: %s", strerror(first_errno));
+        return -1;
+    }
+    return 0;
+}
+
+void perf_counters_close(PerfCounters *pc)
+{
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+    {
+        if (pc->fd[c] >= 0)
+            close(pc->fd[c]);
+        pc->fd[c] = -1;
+    }
+    pc->leader = -1;
+    pc->available = false;
+}
+
+void perf_counters_start(PerfCounters *pc)
+{
+    if (!pc->available)
+        return;
+    ioctl(pc->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(pc->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample)
+{
+    memset(sample, 0, sizeof(*sample));
+    if (!pc->available)
+        return;
+    ioctl(pc->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+    {
+        // value, time_enabled, time_running
+        uint64_t data[3];
+        if (pc->fd[c] < 0 || read(pc->fd[c], data, sizeof(data)) != (ssize_t)sizeof(data))
+            continue;
+        if (data[2] == 0)
+            continue;
+        sample->value[c] = (data[2] < data[1])
+                               ? (uint64_t)((double)data[0] * (double)data[1] / (double)data[2])
+                               : data[0];
+        sample->valid[c] = true;
+    }
+}
+
+#else
+
+int perf_counters_open(PerfCounters *pc)
+{
+    memset(pc, 0, sizeof(*pc));
+    for (int c = 0; c < PERF_NCOUNTERS; c++)
+        pc->fd[c] = -1;
+    pc->leader = -1;
+    snprintf(pc->reason, sizeof(pc->reason), "perf_event_open is Linux-only");
+    return -1;
+}
+
+void perf_counters_close(PerfCounters *pc)
+{
+    pc->available = false;
+}
+
+void perf_counters_start(PerfCounters *pc)
+{
+    (void)pc;
+}
+
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample)
+{
+    (void)pc;
+    memset(sample, 0, sizeof(*sample));
+}
+
+#endif
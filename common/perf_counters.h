@@ -0,0 +1,66 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//--------------------------------------------------------------------
+// Hardware counters around a measured phase, via perf_event_open.
+//
+// The events are opened as one group (so they are scheduled together)
+// on the calling process with inherit set, so threads created after
+// perf_counters_open are counted as well; open the counters before the
+// libraries start their thread pools. User-space only, which works with
+// the default perf_event_paranoid of 2. Events the CPU or VM does not
+// provide are skipped; if none can be opened (no permission, no PMU,
+// not Linux) the counters stay unavailable and every call is a no-op.
+// Values are scaled by time_enabled / time_running when the kernel had
+// to multiplex the group.
+//--------------------------------------------------------------------
+
+enum
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_NCOUNTERS
+};
+
+typedef struct
+{
+    int fd[PERF_NCOUNTERS]; // -1 for events that could not be opened
+    int leader;
+    bool available;
+    char reason[128]; // why nothing could be opened
+} PerfCounters;
+
+typedef struct
+{
+    uint64_t value[PERF_NCOUNTERS];
+    bool valid[PERF_NCOUNTERS];
+} PerfSample;
+
+// Returns 0 when at least one counter is available
+int perf_counters_open(PerfCounters *pc);
+void perf_counters_close(PerfCounters *pc);
+
+// Resets and enables the group / disables it and reads the deltas
+void perf_counters_start(PerfCounters *pc);
+void perf_counters_stop(PerfCounters *pc, PerfSample *sample);
+
+// Short snake_case event names, e.g. "llc_misses"
+const char *perf_counter_name(int counter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_COUNTERS_H
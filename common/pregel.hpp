@@ -0,0 +1,319 @@
+#ifndef PREGEL_HPP
+#define PREGEL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "parallel.hpp"
+
+//--------------------------------------------------------------------
+// Shared-memory vertex-centric BSP engine in the style of Pregel.
+//
+// Vertices [0, n) are split into one contiguous partition per thread.
+// A superstep runs compute() on every vertex of the partition that has
+// not voted to halt or has received messages (which wakes it up), then
+// a barrier delivers the messages for the next superstep. The run ends
+// when every vertex has halted and no message is in flight, or when
+// the master hook returns false.
+//
+// Messages are buffered per sending thread and destination partition
+// and handed over in batches of `batch` envelopes under the partition's
+// lock, so there is no per-message synchronisation. While the program
+// asks for combining (it may switch per superstep), a batch is sorted
+// and combined by destination before it leaves the sender, and the
+// receiver combines the batches again into one message per vertex.
+//
+// A program provides
+//
+//   struct Program
+//   {
+//       using Value = ...;     // per-vertex state, kept by the engine
+//       using Message = ...;
+//       using Aggregate = ...; // reduced over all vertices every superstep,
+//                              // Aggregate{} is the identity
+//       void compute(PregelContext<Program> &ctx, Value &value,
+//                    const Message *messages, std::size_t count);
+//       bool combining(std::uint32_t superstep) const;
+//       Message combine(const Message &a, const Message &b) const;
+//       Aggregate aggregate(const Aggregate &a, const Aggregate &b) const;
+//       // Between supersteps with the superstep's aggregate; false stops
+//       bool master(std::uint32_t superstep, const Aggregate &total);
+//       const char *phase() const; // name of the next superstep, for stats
+//   };
+//
+// compute() may call ctx.send(), ctx.vote_to_halt() and
+// ctx.aggregate(), and runs concurrently for vertices of different
+// partitions: it must only write the value of its own vertex and
+// per-thread state indexed by ctx.thread().
+//--------------------------------------------------------------------
+
+struct PregelOptions
+{
+    unsigned nthreads = 0;                       // 0: $GRAPH_THREADS or the number of cores
+    std::size_t batch = 1024;                    // envelopes per handed-over batch
+    std::uint32_t max_supersteps = std::numeric_limits<std::uint32_t>::max();
+};
+
+struct PregelSuperstep
+{
+    const char *phase = "";
+    double ms = 0.0;               // compute, batch hand-over and delivery
+    std::uint64_t active = 0;      // vertices that ran compute
+    std::uint64_t sent = 0;        // messages passed to send()
+    std::uint64_t transferred = 0; // envelopes handed over, after sender-side combining
+    std::uint64_t delivered = 0;   // messages read by compute next superstep
+    std::uint64_t batches = 0;
+    std::uint64_t bytes = 0;       // transferred * envelope size
+};
+
+template <typename Program>
+class PregelEngine;
+
+template <typename Program>
+class PregelContext
+{
+public:
+    using Message = typename Program::Message;
+    using Aggregate = typename Program::Aggregate;
+
+    std::uint64_t vertex() const { return m_vertex; }
+    std::uint32_t superstep() const { return m_superstep; }
+    unsigned thread() const { return m_thread; }
+
+    void send(std::uint64_t to, const Message &message) { m_engine->send(*this, to, message); }
+    void vote_to_halt() { m_halt = true; }
+    void aggregate(const Aggregate &value) { m_aggregate = m_engine->m_program.aggregate(m_aggregate, value); }
+
+private:
+    friend class PregelEngine<Program>;
+
+    PregelEngine<Program> *m_engine = nullptr;
+    std::uint64_t m_vertex = 0;
+    std::uint32_t m_superstep = 0;
+    unsigned m_thread = 0;
+    bool m_halt = false;
+    bool m_combining = false;
+    Aggregate m_aggregate{};
+    std::uint64_t m_sent = 0;
+    std::uint64_t m_transferred = 0;
+    std::uint64_t m_batches = 0;
+};
+
+template <typename Program>
+class PregelEngine
+{
+public:
+    using Value = typename Program::Value;
+    using Message = typename Program::Message;
+    using Aggregate = typename Program::Aggregate;
+
+    struct Envelope
+    {
+        std::uint64_t to;
+        Message message;
+    };
+
+    PregelEngine(Program &program, std::uint64_t n, const PregelOptions &options = {})
+        : m_program(program), m_n(n), m_options(options), m_values(n), m_halted(n, 0)
+    {
+        m_threads = static_cast<unsigned>(
+            std::max<std::uint64_t>(1, std::min<std::uint64_t>(resolve_threads(options.nthreads), n)));
+        m_chunk = std::max<std::uint64_t>(1, (n + m_threads - 1) / m_threads);
+        m_options.batch = std::max<std::size_t>(1, m_options.batch);
+        m_partitions = std::vector<Partition>(m_threads);
+        m_outbox.assign(m_threads, std::vector<std::vector<Envelope>>(m_threads));
+    }
+
+    std::vector<Value> &values() { return m_values; }
+
+    // Runs supersteps until every vertex halted with no message in flight
+    // or master() returns false; one entry per superstep
+    std::vector<PregelSuperstep> run()
+    {
+        using clock = std::chrono::steady_clock;
+        std::vector<PregelSuperstep> stats;
+        for (std::uint32_t superstep = 0; superstep < m_options.max_supersteps; superstep++)
+        {
+            auto start = clock::now();
+            PregelSuperstep step;
+            step.phase = m_program.phase();
+            const bool combining = m_program.combining(superstep);
+            std::vector<PregelContext<Program>> contexts(m_threads);
+            std::vector<std::uint64_t> active(m_threads, 0), awake(m_threads, 0);
+
+            run_threads(m_threads, [&](unsigned t)
+                        {
+                PregelContext<Program> &ctx = contexts[t];
+                ctx.m_engine = this;
+                ctx.m_superstep = superstep;
+                ctx.m_thread = t;
+                ctx.m_combining = combining;
+                const Partition &part = m_partitions[t];
+                const std::uint64_t begin = partition_begin(t), end = partition_begin(t + 1);
+                for (std::uint64_t v = begin; v < end; v++)
+                {
+                    const std::uint64_t local = v - begin;
+                    const std::size_t count =
+                        part.ptr.empty() ? 0 : static_cast<std::size_t>(part.ptr[local + 1] - part.ptr[local]);
+                    if (m_halted[v] && count == 0)
+                        continue;
+                    ctx.m_vertex = v;
+                    ctx.m_halt = false;
+                    m_program.compute(ctx, m_values[v], count ? part.messages.data() + part.ptr[local] : nullptr,
+                                      count);
+                    m_halted[v] = ctx.m_halt;
+                    active[t]++;
+                    awake[t] += !ctx.m_halt;
+                }
+                for (unsigned p = 0; p < m_threads; p++)
+                    flush(ctx, p); });
+
+            Aggregate total{};
+            std::uint64_t still_awake = 0;
+            for (unsigned t = 0; t < m_threads; t++)
+            {
+                total = m_program.aggregate(total, contexts[t].m_aggregate);
+                step.active += active[t];
+                step.sent += contexts[t].m_sent;
+                step.transferred += contexts[t].m_transferred;
+                step.batches += contexts[t].m_batches;
+                still_awake += awake[t];
+            }
+            step.bytes = step.transferred * sizeof(Envelope);
+
+            std::vector<std::uint64_t> delivered(m_threads, 0);
+            run_threads(m_threads, [&](unsigned t)
+                        { delivered[t] = deliver(t, combining); });
+            for (std::uint64_t d : delivered)
+                step.delivered += d;
+
+            const bool proceed = m_program.master(superstep, total);
+            step.ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            stats.push_back(step);
+            if (!proceed || (still_awake == 0 && step.delivered == 0))
+                break;
+        }
+        return stats;
+    }
+
+private:
+    friend class PregelContext<Program>;
+
+    struct alignas(64) Partition
+    {
+        std::mutex lock;
+        std::vector<std::vector<Envelope>> inbox; // batches for the next superstep
+        std::vector<std::uint64_t> ptr;           // messages of local vertex i: [ptr[i], ptr[i + 1])
+        std::vector<Message> messages;
+        std::vector<Message> slot; // combining: one message per local vertex
+        std::vector<std::uint8_t> has;
+    };
+
+    std::uint64_t partition_begin(unsigned t) const { return std::min<std::uint64_t>(m_n, m_chunk * t); }
+
+    void send(PregelContext<Program> &ctx, std::uint64_t to, const Message &message)
+    {
+        ctx.m_sent++;
+        const auto p = static_cast<unsigned>(to / m_chunk);
+        std::vector<Envelope> &out = m_outbox[ctx.m_thread][p];
+        out.push_back({to, message});
+        if (out.size() >= m_options.batch)
+            flush(ctx, p);
+    }
+
+    // Hands the batch for partition p over, combined first if requested
+    void flush(PregelContext<Program> &ctx, unsigned p)
+    {
+        std::vector<Envelope> &out = m_outbox[ctx.m_thread][p];
+        if (out.empty())
+            return;
+        if (ctx.m_combining)
+        {
+            std::sort(out.begin(), out.end(), [](const Envelope &a, const Envelope &b)
+                      { return a.to < b.to; });
+            std::size_t kept = 0;
+            for (std::size_t k = 1; k < out.size(); k++)
+            {
+                if (out[k].to == out[kept].to)
+                    out[kept].message = m_program.combine(out[kept].message, out[k].message);
+                else
+                    out[++kept] = out[k];
+            }
+            out.resize(kept + 1);
+        }
+        ctx.m_transferred += out.size();
+        ctx.m_batches++;
+        std::vector<Envelope> batch;
+        batch.reserve(m_options.batch);
+        batch.swap(out);
+        Partition &part = m_partitions[p];
+        std::lock_guard<std::mutex> guard(part.lock);
+        part.inbox.push_back(std::move(batch));
+    }
+
+    // Turns the batches received by partition t into per-vertex messages
+    std::uint64_t deliver(unsigned t, bool combining)
+    {
+        Partition &part = m_partitions[t];
+        const std::uint64_t begin = partition_begin(t), size = partition_begin(t + 1) - begin;
+        part.ptr.assign(size + 1, 0);
+        part.messages.clear();
+        if (part.inbox.empty())
+            return 0;
+
+        if (combining)
+        {
+            part.slot.resize(size);
+            part.has.assign(size, 0);
+            for (const auto &batch : part.inbox)
+                for (const Envelope &e : batch)
+                {
+                    const std::uint64_t local = e.to - begin;
+                    if (part.has[local])
+                        part.slot[local] = m_program.combine(part.slot[local], e.message);
+                    else
+                    {
+                        part.slot[local] = e.message;
+                        part.has[local] = 1;
+                    }
+                }
+            for (std::uint64_t i = 0; i < size; i++)
+            {
+                part.ptr[i + 1] = part.ptr[i] + part.has[i];
+                if (part.has[i])
+                    part.messages.push_back(part.slot[i]);
+            }
+        }
+        else
+        {
+            for (const auto &batch : part.inbox)
+                for (const Envelope &e : batch)
+                    part.ptr[e.to - begin + 1]++;
+            for (std::uint64_t i = 0; i < size; i++)
+                part.ptr[i + 1] += part.ptr[i];
+            part.messages.resize(part.ptr[size]);
+            std::vector<std::uint64_t> fill(part.ptr.begin(), part.ptr.end() - 1);
+            for (const auto &batch : part.inbox)
+                for (const Envelope &e : batch)
+                    part.messages[fill[e.to - begin]++] = e.message;
+        }
+        part.inbox.clear();
+        return part.messages.size();
+    }
+
+    Program &m_program;
+    std::uint64_t m_n;
+    PregelOptions m_options;
+    unsigned m_threads = 1;
+    std::uint64_t m_chunk = 1;
+    std::vector<Value> m_values;
+    std::vector<std::uint8_t> m_halted;
+    std::vector<Partition> m_partitions;
+    std::vector<std::vector<std::vector<Envelope>>> m_outbox; // [sender][partition]
+};
+
+#endif // PREGEL_HPP
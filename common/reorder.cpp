@@ -0,0 +1,384 @@
+#include "reorder.hpp"
+#include "parallel.hpp"
+#include "undirected_csr.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    constexpr std::uint64_t BUILD_BLOCK = 4096;       // rows per scheduling block
+    constexpr std::uint64_t PARALLEL_FRONTIER = 4096; // smaller BFS levels run on the calling thread
+    constexpr int PERIPHERAL_SWEEPS = 4;              // BFS sweeps looking for a pseudo-peripheral start
+    constexpr int LABEL_ROUNDS = 10;                  // label propagation rounds at most
+    constexpr std::uint32_t COMMUNITY_LIMIT = 1 << 12; // community size cap, about an L2 of rows
+    constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    // Undirected pattern; parallel entries are kept, the users tolerate them
+    using Adjacency = UndirectedCsr<std::uint32_t>;
+
+    // Vertices by ascending (or descending) degree, ascending id among equal
+    // degrees; counting sort
+    std::vector<std::uint32_t> by_degree(const Adjacency &g, bool descending)
+    {
+        std::uint64_t max_degree = 0;
+        for (std::uint32_t v = 0; v < g.n; v++)
+            max_degree = std::max(max_degree, g.degree(v));
+        auto key = [&](std::uint32_t v) { return descending ? max_degree - g.degree(v) : g.degree(v); };
+        std::vector<std::uint64_t> bucket(max_degree + 2, 0);
+        for (std::uint32_t v = 0; v < g.n; v++)
+            bucket[key(v) + 1]++;
+        for (std::uint64_t d = 0; d <= max_degree; d++)
+            bucket[d + 1] += bucket[d];
+        std::vector<std::uint32_t> order(g.n);
+        for (std::uint32_t v = 0; v < g.n; v++)
+            order[bucket[key(v)]++] = v;
+        return order;
+    }
+
+    VertexPermutation from_order(std::vector<std::uint32_t> order, unsigned nthreads)
+    {
+        VertexPermutation perm;
+        perm.new_of_old.resize(order.size());
+        parallel_for(nthreads, order.size(), [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t r = b; r < e; r++)
+                perm.new_of_old[order[r]] = static_cast<std::uint32_t>(r); });
+        perm.old_of_new = std::move(order);
+        return perm;
+    }
+
+    // Cuthill-McKee BFS from start, appending to out. Level by level: every
+    // unvisited neighbour is claimed by the first frontier vertex listing it
+    // (atomic min of the frontier position), then each frontier vertex
+    // appends its claims in adjacency order, which is the sequential order.
+    // Visited vertices get `stamp` in seen. Returns the number of levels;
+    // the last one starts at last_level.
+    class LevelBfs
+    {
+    public:
+        LevelBfs(const Adjacency &g, unsigned nthreads)
+            : m_g(g), m_threads(nthreads), m_seen(g.n, 0), m_claim(g.n, NONE)
+        {
+        }
+
+        std::uint32_t run(std::uint32_t start, std::uint32_t stamp, std::vector<std::uint32_t> &out,
+                          std::size_t &last_level)
+        {
+            std::size_t begin = out.size();
+            out.push_back(start);
+            m_seen[start] = stamp;
+            std::uint32_t levels = 0;
+            while (begin < out.size())
+            {
+                const std::size_t end = out.size();
+                const std::uint64_t frontier = end - begin;
+                const unsigned threads = frontier >= PARALLEL_FRONTIER ? m_threads : 1;
+                last_level = begin;
+                levels++;
+
+                parallel_for(threads, frontier, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+                    for (std::uint64_t k = b; k < e; k++)
+                        for_unseen(out[begin + k], stamp, [&](std::uint32_t w)
+                                   {
+                            std::uint32_t cur = __atomic_load_n(&m_claim[w], __ATOMIC_RELAXED);
+                            while (k < cur && !__atomic_compare_exchange_n(&m_claim[w], &cur, static_cast<std::uint32_t>(k), true,
+                                                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                            {
+                            } }); });
+
+                m_count.assign(frontier + 1, 0);
+                parallel_for(threads, frontier, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+                    for (std::uint64_t k = b; k < e; k++)
+                        for_claimed(out[begin + k], stamp, k, [&](std::uint32_t) { m_count[k + 1]++; }); });
+                for (std::uint64_t k = 0; k < frontier; k++)
+                    m_count[k + 1] += m_count[k];
+
+                out.resize(end + m_count[frontier]);
+                parallel_for(threads, frontier, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+                    for (std::uint64_t k = b; k < e; k++)
+                    {
+                        std::uint64_t pos = end + m_count[k];
+                        for_claimed(out[begin + k], stamp, k, [&](std::uint32_t w) { out[pos++] = w; });
+                    } });
+                parallel_for(threads, out.size() - end, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+                    for (std::uint64_t k = end + b; k < end + e; k++)
+                    {
+                        m_seen[out[k]] = stamp;
+                        m_claim[out[k]] = NONE;
+                    } });
+                begin = end;
+            }
+            return levels;
+        }
+
+        bool seen(std::uint32_t v, std::uint32_t stamp) const { return m_seen[v] == stamp; }
+
+    private:
+        template <typename F>
+        void for_unseen(std::uint32_t v, std::uint32_t stamp, F &&f) const
+        {
+            for (std::uint64_t x = m_g.ptr[v]; x < m_g.ptr[v + 1]; x++)
+                if (m_seen[m_g.adj[x]] != stamp)
+                    f(m_g.adj[x]);
+        }
+
+        // Claims of frontier position k, each vertex once (duplicates of a
+        // row are adjacent after the degree sort)
+        template <typename F>
+        void for_claimed(std::uint32_t v, std::uint32_t stamp, std::uint64_t k, F &&f) const
+        {
+            std::uint32_t prev = NONE;
+            for (std::uint64_t x = m_g.ptr[v]; x < m_g.ptr[v + 1]; x++)
+            {
+                std::uint32_t w = m_g.adj[x];
+                if (w != prev && m_seen[w] != stamp && m_claim[w] == k)
+                    f(w);
+                prev = w;
+            }
+        }
+
+        const Adjacency &m_g;
+        unsigned m_threads;
+        std::vector<std::uint32_t> m_seen;
+        std::vector<std::uint32_t> m_claim;
+        std::vector<std::uint64_t> m_count;
+    };
+
+    VertexPermutation rcm_order(Adjacency &g, unsigned nthreads)
+    {
+        const std::vector<std::uint32_t> ascending = by_degree(g, false);
+        std::vector<std::uint32_t> rank(g.n);
+        for (std::uint32_t r = 0; r < g.n; r++)
+            rank[ascending[r]] = r;
+        // Neighbours by ascending degree: the Cuthill-McKee visiting order
+        parallel_for_dynamic(nthreads, g.n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t v = b; v < e; v++)
+                std::sort(g.adj.begin() + g.ptr[v], g.adj.begin() + g.ptr[v + 1],
+                          [&](std::uint32_t x, std::uint32_t y) { return rank[x] < rank[y]; }); });
+
+        constexpr std::uint32_t DONE = 1;
+        LevelBfs bfs(g, nthreads);
+        std::vector<std::uint32_t> order, sweep;
+        order.reserve(g.n);
+        std::uint32_t stamp = DONE;
+        for (std::uint32_t start : ascending)
+        {
+            if (bfs.seen(start, DONE))
+                continue;
+            // George-Liu: restart from a lowest-degree vertex of the last
+            // level while the eccentricity grows
+            std::uint32_t eccentricity = 0;
+            for (int s = 0; s < PERIPHERAL_SWEEPS && g.degree(start) > 0; s++)
+            {
+                sweep.clear();
+                std::size_t last = 0;
+                std::uint32_t levels = bfs.run(start, ++stamp, sweep, last);
+                if (levels <= eccentricity)
+                    break;
+                eccentricity = levels;
+                start = *std::min_element(sweep.begin() + last, sweep.end(), [&](std::uint32_t x, std::uint32_t y)
+                                          { return rank[x] < rank[y]; });
+            }
+            std::size_t last = 0;
+            bfs.run(start, DONE, order, last);
+        }
+        std::reverse(order.begin(), order.end());
+        return from_order(std::move(order), nthreads);
+    }
+
+    // Label propagation in place (asynchronous rounds): every vertex takes
+    // the most frequent label among its neighbours, the smallest on ties,
+    // but keeps its own label while that is among the most frequent.
+    // Communities stop accepting members at COMMUNITY_LIMIT, otherwise a
+    // power-law graph collapses into one community and nothing moves.
+    VertexPermutation community_order(const Adjacency &g, unsigned nthreads)
+    {
+        std::vector<std::uint32_t> label(g.n), size(g.n, 1);
+        for (std::uint32_t v = 0; v < g.n; v++)
+            label[v] = v;
+        std::vector<std::vector<std::uint32_t>> scratch(nthreads);
+        for (int round = 0; round < LABEL_ROUNDS; round++)
+        {
+            std::uint64_t changed = 0;
+            parallel_for_dynamic(nthreads, g.n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                                 {
+                auto &labels = scratch[t];
+                std::uint64_t moved = 0;
+                for (std::uint64_t v = b; v < e; v++)
+                {
+                    labels.clear();
+                    for (std::uint64_t x = g.ptr[v]; x < g.ptr[v + 1]; x++)
+                        labels.push_back(__atomic_load_n(&label[g.adj[x]], __ATOMIC_RELAXED));
+                    std::sort(labels.begin(), labels.end());
+                    const std::uint32_t own = label[v];
+                    std::uint32_t best = own;
+                    std::size_t best_count = 0, own_count = 0;
+                    for (std::size_t i = 0; i < labels.size();)
+                    {
+                        std::size_t j = i;
+                        while (j < labels.size() && labels[j] == labels[i])
+                            j++;
+                        if (labels[i] == own)
+                            own_count = j - i;
+                        else if (__atomic_load_n(&size[labels[i]], __ATOMIC_RELAXED) >= COMMUNITY_LIMIT)
+                        {
+                            i = j;
+                            continue;
+                        }
+                        if (j - i > best_count)
+                        {
+                            best_count = j - i;
+                            best = labels[i];
+                        }
+                        i = j;
+                    }
+                    if (own_count < best_count)
+                    {
+                        __atomic_fetch_add(&size[best], 1, __ATOMIC_RELAXED);
+                        __atomic_fetch_sub(&size[own], 1, __ATOMIC_RELAXED);
+                        __atomic_store_n(&label[v], best, __ATOMIC_RELAXED);
+                        moved++;
+                    }
+                }
+                __atomic_fetch_add(&changed, moved, __ATOMIC_RELAXED); });
+            if (changed * 1000 <= g.n)
+                break;
+        }
+
+        // Communities in order of their label, members in original order
+        std::vector<std::uint64_t> bucket(std::uint64_t(g.n) + 1, 0);
+        for (std::uint32_t v = 0; v < g.n; v++)
+            bucket[label[v] + 1]++;
+        for (std::uint32_t l = 0; l < g.n; l++)
+            bucket[l + 1] += bucket[l];
+        std::vector<std::uint32_t> order(g.n);
+        for (std::uint32_t v = 0; v < g.n; v++)
+            order[bucket[label[v]]++] = v;
+        return from_order(std::move(order), nthreads);
+    }
+}
+
+VertexPermutation reorder_compute(const GraphCache &cache, VertexOrder order, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    if (order == VertexOrder::Original)
+    {
+        std::vector<std::uint32_t> identity(undirected_vertices<std::uint32_t>(cache, "reorder"));
+        for (std::uint32_t v = 0; v < identity.size(); v++)
+            identity[v] = v;
+        return from_order(std::move(identity), nthreads);
+    }
+    Adjacency g = undirected_csr<std::uint32_t>(cache, nthreads, "reorder");
+    switch (order)
+    {
+    case VertexOrder::Degree:
+        return from_order(by_degree(g, true), nthreads);
+    case VertexOrder::Rcm:
+        return rcm_order(g, nthreads);
+    default:
+        return community_order(g, nthreads);
+    }
+}
+
+int reorder_apply(const GraphCache &cache, const VertexPermutation &perm, GraphCache *out, unsigned nthreads)
+{
+    nthreads = resolve_threads(nthreads);
+    const std::uint64_t n = perm.old_of_new.size();
+    const std::uint64_t rows = cache.header.n;
+    if (n < rows)
+        return -1;
+    const std::uint32_t flags = cache.header.flags | GRAPH_CACHE_SORTED;
+    if (graph_cache_alloc(n, cache.header.nnz, flags, out) != 0)
+        return -1;
+    auto *row_ptr = const_cast<std::uint64_t *>(out->row_ptr);
+    auto *col_idx = const_cast<std::uint64_t *>(out->col_idx);
+    auto *weights = const_cast<double *>(out->weights);
+
+    row_ptr[0] = 0;
+    for (std::uint64_t r = 0; r < n; r++)
+    {
+        std::uint64_t old = perm.old_of_new[r];
+        row_ptr[r + 1] = row_ptr[r] + (old < rows ? cache.row_ptr[old + 1] - cache.row_ptr[old] : 0);
+    }
+
+    std::vector<std::vector<std::pair<std::uint64_t, double>>> scratch(nthreads);
+    std::vector<std::uint64_t> max_index(nthreads, 0);
+    parallel_for_dynamic(nthreads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+        auto &row = scratch[t];
+        for (std::uint64_t r = b; r < e; r++)
+        {
+            std::uint64_t old = perm.old_of_new[r];
+            if (old >= rows)
+                continue;
+            row.clear();
+            for (std::uint64_t k = cache.row_ptr[old]; k < cache.row_ptr[old + 1]; k++)
+                row.emplace_back(perm.new_of_old[cache.col_idx[k]], cache.weights ? cache.weights[k] : 1.0);
+            std::sort(row.begin(), row.end());
+            if (!row.empty())
+                max_index[t] = std::max({max_index[t], r, row.back().first});
+            std::uint64_t pos = row_ptr[r];
+            for (const auto &[c, w] : row)
+            {
+                col_idx[pos] = c;
+                if (weights)
+                    weights[pos] = w;
+                pos++;
+            }
+        } });
+
+    out->header.max_index = *std::max_element(max_index.begin(), max_index.end());
+    *static_cast<GraphCacheHeader *>(out->base) = out->header;
+    return 0;
+}
+
+std::vector<std::uint32_t> reorder_ids_to_original(const VertexPermutation &perm,
+                                                   const std::vector<std::uint32_t> &ids)
+{
+    std::vector<std::uint32_t> out(ids.size());
+    for (std::size_t v = 0; v < ids.size(); v++)
+    {
+        std::uint32_t id = ids[v];
+        out[perm.old_of_new[v]] = id < perm.old_of_new.size() ? perm.old_of_new[id] : id;
+    }
+    return out;
+}
+
+bool vertex_order_parse(const std::string &name, VertexOrder &order)
+{
+    static const std::pair<const char *, VertexOrder> names[] = {{"original", VertexOrder::Original},
+                                                                 {"degree", VertexOrder::Degree},
+                                                                 {"rcm", VertexOrder::Rcm},
+                                                                 {"community", VertexOrder::Community}};
+    for (const auto &[text, value] : names)
+        if (name == text)
+        {
+            order = value;
+            return true;
+        }
+    return false;
+}
+
+const char *vertex_order_name(VertexOrder order)
+{
+    switch (order)
+    {
+    case VertexOrder::Original:
+        return "original";
+    case VertexOrder::Degree:
+        return "degree";
+    case VertexOrder::Rcm:
+        return "rcm";
+    case VertexOrder::Community:
+        return "community";
+    }
+    return "?";
+}
@@ -0,0 +1,75 @@
+#ifndef REORDER_HPP
+#define REORDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graph_cache.h"
+
+//--------------------------------------------------------------------
+// Vertex reordering of a cached graph.
+//
+// The loaders keep the ids of the file, which scatters the neighbours of
+// a vertex across memory on the internet and graph500 inputs. An order
+// is computed once on the undirected pattern, the CSR image is permuted
+// into a new cache (rows renumbered, columns renumbered and sorted) and
+// the permutation is kept so that per-vertex results can be mapped back
+// to the ids of the file:
+//  - Degree: descending undirected degree, hubs first and together;
+//  - Rcm: reverse Cuthill-McKee from a pseudo-peripheral vertex of every
+//    component, which keeps the neighbours of a vertex in a narrow band;
+//  - Community: label propagation communities laid out contiguously, in
+//    the spirit of Rabbit order / Gorder but without their dendrogram.
+// Every stage is parallel: degrees and adjacency with atomics, the RCM
+// BFS level by level (a vertex goes to its first parent in the frontier,
+// which reproduces the sequential order), label propagation in
+// asynchronous rounds that update the labels in place. Degree and RCM
+// orders are deterministic; the community order depends on the thread
+// count and on scheduling, since a vertex may see labels already
+// changed in the same round.
+//--------------------------------------------------------------------
+
+enum class VertexOrder
+{
+    Original,
+    Degree,
+    Rcm,
+    Community
+};
+
+struct VertexPermutation
+{
+    std::vector<std::uint32_t> new_of_old;
+    std::vector<std::uint32_t> old_of_new;
+};
+
+// Order of vertices [0, max(n, max_index + 1)) of the cache. Throws
+// std::runtime_error beyond 32-bit ids.
+VertexPermutation reorder_compute(const GraphCache &cache, VertexOrder order, unsigned nthreads = 0);
+
+// Fills out with the permuted in-memory image: row new_of_old[i] holds
+// the entries of row i with renumbered, ascending columns. The flags of
+// the source are kept. Returns 0 on success.
+int reorder_apply(const GraphCache &cache, const VertexPermutation &perm, GraphCache *out, unsigned nthreads = 0);
+
+// Per-vertex values indexed by new id, returned indexed by original id
+template <typename T>
+std::vector<T> reorder_to_original(const VertexPermutation &perm, const std::vector<T> &values)
+{
+    std::vector<T> out(values.size());
+    for (std::size_t v = 0; v < values.size(); v++)
+        out[perm.old_of_new[v]] = values[v];
+    return out;
+}
+
+// Vertex ids indexed by new id (such as MST parents), renumbered and
+// returned indexed by original id; ids outside the permutation (sentinels)
+// are kept
+std::vector<std::uint32_t> reorder_ids_to_original(const VertexPermutation &perm,
+                                                   const std::vector<std::uint32_t> &ids);
+
+bool vertex_order_parse(const std::string &name, VertexOrder &order);
+const char *vertex_order_name(VertexOrder order);
+
+#endif // REORDER_HPP
@@ -0,0 +1,320 @@
+#include "rmat.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint64_t GEN_BLOCK = 1 << 16;     // edges per scheduling block
+    constexpr std::uint64_t SORT_BLOCK_ROWS = 4096;  // as in graph_parser.cpp
+    constexpr std::uint64_t WRITE_BLOCK = 1 << 20;   // entries formatted per task
+
+    std::uint64_t splitmix64(std::uint64_t &state)
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    double unit(std::uint64_t &state)
+    {
+        return static_cast<double>(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Seed-dependent bijection of [0, 2^scale): odd multiplies and
+    // xor-shifts, both invertible modulo 2^scale
+    class Scramble
+    {
+    public:
+        Scramble(unsigned scale, std::uint64_t seed)
+            : m_mask(scale >= 64 ? ~0ull : (1ull << scale) - 1), m_shift(std::max(1u, scale / 2))
+        {
+            std::uint64_t s = seed ^ 0x5851f42d4c957f2dull;
+            m_mul1 = splitmix64(s) | 1;
+            m_mul2 = splitmix64(s) | 1;
+            m_add = splitmix64(s);
+        }
+
+        std::uint64_t operator()(std::uint64_t x) const
+        {
+            x = (x * m_mul1 + m_add) & m_mask;
+            x ^= x >> m_shift;
+            x = (x * m_mul2) & m_mask;
+            x ^= x >> m_shift;
+            return x;
+        }
+
+    private:
+        std::uint64_t m_mask;
+        unsigned m_shift;
+        std::uint64_t m_mul1 = 1, m_mul2 = 1, m_add = 0;
+    };
+
+    struct Edge
+    {
+        std::uint64_t u, v;
+        double w;
+    };
+
+    // Edge k of the stream; identical on every call
+    Edge rmat_edge(const RmatParams &p, const Scramble &scramble, std::uint64_t k)
+    {
+        std::uint64_t state = p.seed * 0xd1342543de82ef95ull + k;
+        splitmix64(state);
+        const double ab = p.a + p.b, abc = p.a + p.b + p.c;
+        std::uint64_t u = 0, v = 0;
+        for (unsigned level = 0; level < p.scale; level++)
+        {
+            double r = unit(state);
+            u <<= 1;
+            v <<= 1;
+            if (r >= abc)
+            {
+                u |= 1;
+                v |= 1;
+            }
+            else if (r >= ab)
+                u |= 1;
+            else if (r >= p.a)
+                v |= 1;
+        }
+        double w = p.max_weight ? static_cast<double>(1 + splitmix64(state) % p.max_weight) : 1.0;
+        return {scramble(u), scramble(v), w};
+    }
+
+    // Runs f(u, v, w) for both directions of every non-loop edge
+    template <typename F>
+    void for_each_entry(const RmatParams &p, const Scramble &scramble, unsigned threads, F &&f)
+    {
+        const std::uint64_t m = static_cast<std::uint64_t>(p.edge_factor) << p.scale;
+        parallel_for_dynamic(threads, m, GEN_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                             {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                Edge edge = rmat_edge(p, scramble, k);
+                if (edge.u == edge.v)
+                    continue;
+                f(edge.u, edge.v, edge.w);
+                f(edge.v, edge.u, edge.w);
+            } });
+    }
+
+    template <typename Format>
+    int write_text(const char *path, const GraphCache &cache, const std::string &banner, Format &&format)
+    {
+        FILE *out = std::fopen(path, "wb");
+        if (!out)
+        {
+            std::fprintf(stderr, "rmat: cannot write %s\n", path);
+            return -1;
+        }
+        bool ok = std::fwrite(banner.data(), 1, banner.size(), out) == banner.size();
+
+        // Rows are cut into blocks of about WRITE_BLOCK entries, formatted in
+        // parallel one round of `threads` blocks at a time and written in order
+        const std::uint64_t n = cache.header.n;
+        std::vector<std::uint64_t> cuts{0};
+        for (std::uint64_t r = 0; r < n;)
+        {
+            std::uint64_t target = cache.row_ptr[r] + WRITE_BLOCK;
+            std::uint64_t next = static_cast<std::uint64_t>(
+                std::upper_bound(cache.row_ptr + r + 1, cache.row_ptr + n + 1, target) - cache.row_ptr - 1);
+            r = std::max(r + 1, next);
+            cuts.push_back(std::min(r, n));
+        }
+
+        const unsigned threads = resolve_threads(0);
+        std::vector<std::string> text(threads);
+        for (std::size_t first = 0; ok && first + 1 < cuts.size(); first += threads)
+        {
+            std::size_t count = std::min<std::size_t>(threads, cuts.size() - 1 - first);
+            parallel_for_dynamic(threads, count, 1, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                                 {
+                for (std::uint64_t t = b; t < e; t++)
+                {
+                    std::string &s = text[t];
+                    s.clear();
+                    char line[96];
+                    for (std::uint64_t r = cuts[first + t]; r < cuts[first + t + 1]; r++)
+                        for (std::uint64_t k = cache.row_ptr[r]; k < cache.row_ptr[r + 1]; k++)
+                            s.append(line, format(line, r, cache.col_idx[k], cache.weights ? cache.weights[k] : 1.0));
+                } });
+            for (std::size_t t = 0; ok && t < count; t++)
+                ok = std::fwrite(text[t].data(), 1, text[t].size(), out) == text[t].size();
+        }
+        ok = (std::fclose(out) == 0) && ok;
+        if (!ok)
+            std::fprintf(stderr, "rmat: error writing %s\n", path);
+        return ok ? 0 : -1;
+    }
+
+    // "<u+1> <v+1>[ <w>]\n" with the given prefix, returns its length
+    std::size_t format_entry(char *line, const char *prefix, std::uint64_t u, std::uint64_t v, double w, bool weighted)
+    {
+        char *p = line;
+        for (; *prefix; prefix++)
+            *p++ = *prefix;
+        char *end = line + 80; // three numbers of at most 20 digits fit with room to spare
+        p = std::to_chars(p, end, u + 1).ptr;
+        *p++ = ' ';
+        p = std::to_chars(p, end, v + 1).ptr;
+        if (weighted)
+        {
+            *p++ = ' ';
+            p = std::to_chars(p, end, static_cast<std::uint64_t>(w)).ptr;
+        }
+        *p++ = '\n';
+        return static_cast<std::size_t>(p - line);
+    }
+}
+
+int rmat_generate(const RmatParams &p, GraphCache *cache)
+{
+    std::memset(cache, 0, sizeof(*cache));
+    if (p.scale == 0 || p.scale > 40 || p.a < 0 || p.b < 0 || p.c < 0 || p.a + p.b + p.c > 1.0)
+    {
+        std::fprintf(stderr, "rmat: invalid parameters\n");
+        return -1;
+    }
+    const unsigned threads = resolve_threads(p.nthreads);
+    const std::uint64_t n = 1ull << p.scale;
+    const Scramble scramble(p.scale, p.seed);
+
+    // Pass 1: row lengths
+    std::vector<std::uint64_t> degree(n + 1, 0);
+    for_each_entry(p, scramble, threads, [&](std::uint64_t u, std::uint64_t, double)
+                   { __atomic_fetch_add(&degree[u + 1], 1, __ATOMIC_RELAXED); });
+    for (std::uint64_t r = 0; r < n; r++)
+        degree[r + 1] += degree[r];
+    const std::uint64_t total = degree[n];
+
+    // Pass 2: regenerate and scatter into the image
+    const std::uint32_t flags = GRAPH_CACHE_SORTED | (p.max_weight ? GRAPH_CACHE_WEIGHTED : 0);
+    GraphCache raw;
+    if (graph_cache_alloc(n, total, flags, &raw) != 0)
+        return -1;
+    auto *row_ptr = const_cast<std::uint64_t *>(raw.row_ptr);
+    auto *col_idx = const_cast<std::uint64_t *>(raw.col_idx);
+    auto *weights = const_cast<double *>(raw.weights);
+    std::copy(degree.begin(), degree.end(), row_ptr);
+    std::vector<std::uint64_t> &cursor = degree;
+    for_each_entry(p, scramble, threads, [&](std::uint64_t u, std::uint64_t v, double w)
+                   {
+        std::uint64_t pos = __atomic_fetch_add(&cursor[u], 1, __ATOMIC_RELAXED);
+        col_idx[pos] = v;
+        if (weights)
+            weights[pos] = w; });
+
+    // Sort every row by (column, weight) and keep the first of each column;
+    // the unique length of row r goes to cursor[r]
+    std::vector<std::vector<std::pair<std::uint64_t, double>>> scratch(threads);
+    parallel_for_dynamic(threads, n, SORT_BLOCK_ROWS, [&](std::uint64_t first, std::uint64_t last, unsigned t)
+                         {
+        auto &row = scratch[t];
+        for (std::uint64_t r = first; r < last; r++)
+        {
+            std::uint64_t b = row_ptr[r], e = row_ptr[r + 1];
+            row.clear();
+            for (std::uint64_t k = b; k < e; k++)
+                row.emplace_back(col_idx[k], weights ? weights[k] : 1.0);
+            std::sort(row.begin(), row.end());
+            std::uint64_t len = 0;
+            for (std::size_t k = 0; k < row.size(); k++)
+            {
+                if (k > 0 && row[k].first == row[k - 1].first)
+                    continue;
+                col_idx[b + len] = row[k].first;
+                if (weights)
+                    weights[b + len] = row[k].second;
+                len++;
+            }
+            cursor[r] = len;
+        } });
+
+    // Compact into the final image
+    std::uint64_t nnz = 0;
+    for (std::uint64_t r = 0; r < n; r++)
+        nnz += cursor[r];
+    if (graph_cache_alloc(n, nnz, flags, cache) != 0)
+    {
+        graph_cache_close(&raw);
+        return -1;
+    }
+    auto *out_ptr = const_cast<std::uint64_t *>(cache->row_ptr);
+    out_ptr[0] = 0;
+    for (std::uint64_t r = 0; r < n; r++)
+        out_ptr[r + 1] = out_ptr[r] + cursor[r];
+    std::vector<std::uint64_t> max_col(threads, 0);
+    parallel_for(threads, n, [&](std::uint64_t first, std::uint64_t last, unsigned t)
+                 {
+        for (std::uint64_t r = first; r < last; r++)
+        {
+            std::uint64_t len = cursor[r];
+            std::copy(col_idx + row_ptr[r], col_idx + row_ptr[r] + len, const_cast<std::uint64_t *>(cache->col_idx) + out_ptr[r]);
+            if (weights)
+                std::copy(weights + row_ptr[r], weights + row_ptr[r] + len, const_cast<double *>(cache->weights) + out_ptr[r]);
+            if (len > 0)
+                max_col[t] = std::max({max_col[t], r, col_idx[row_ptr[r] + len - 1]});
+        } });
+    graph_cache_close(&raw);
+
+    cache->header.max_index = *std::max_element(max_col.begin(), max_col.end());
+    *static_cast<GraphCacheHeader *>(cache->base) = cache->header;
+    return 0;
+}
+
+bool rmat_parse_spec(const std::string &spec, RmatParams &params)
+{
+    if (spec.compare(0, 5, "rmat:") != 0)
+        return false;
+    std::uint64_t fields[3] = {params.scale, params.edge_factor, params.seed};
+    std::size_t pos = 5;
+    for (int f = 0; f < 3 && pos <= spec.size(); f++)
+    {
+        std::size_t end = spec.find(':', pos);
+        if (end == std::string::npos)
+            end = spec.size();
+        auto res = std::from_chars(spec.data() + pos, spec.data() + end, fields[f]);
+        if (res.ec != std::errc() || res.ptr != spec.data() + end)
+            return false;
+        pos = end + 1;
+    }
+    params.scale = static_cast<unsigned>(fields[0]);
+    params.edge_factor = static_cast<unsigned>(fields[1]);
+    params.seed = fields[2];
+    return true;
+}
+
+int rmat_write_mtx(const char *path, GraphCache *cache)
+{
+    const bool weighted = cache->weights != nullptr;
+    std::string banner = std::string("%%MatrixMarket matrix coordinate ") + (weighted ? "integer" : "pattern") +
+                         " general\n" + std::to_string(cache->header.n) + " " + std::to_string(cache->header.n) +
+                         " " + std::to_string(cache->header.nnz) + "\n";
+    int info = write_text(path, *cache, banner, [&](char *line, std::uint64_t u, std::uint64_t v, double w)
+                          { return format_entry(line, "", u, v, w, weighted); });
+    if (info != 0)
+        return info;
+    cache->header.flags &= ~static_cast<std::uint32_t>(GRAPH_CACHE_DIMACS);
+    return graph_cache_save(path, cache);
+}
+
+int rmat_write_dimacs(const char *path, GraphCache *cache)
+{
+    std::string banner = "p sp " + std::to_string(cache->header.n) + " " + std::to_string(cache->header.nnz) + "\n";
+    int info = write_text(path, *cache, banner, [&](char *line, std::uint64_t u, std::uint64_t v, double w)
+                          { return format_entry(line, "a ", u, v, w, true); });
+    if (info != 0)
+        return info;
+    // What the parser reports for a DIMACS file (its arcs always carry a weight)
+    if (!cache->weights)
+        return 0;
+    cache->header.flags |= GRAPH_CACHE_DIMACS;
+    return graph_cache_save(path, cache);
+}
@@ -0,0 +1,50 @@
+#ifndef RMAT_HPP
+#define RMAT_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "graph_cache.h"
+
+//--------------------------------------------------------------------
+// Graph500-style R-MAT / Kronecker generator.
+//
+// Edge k of the edge_factor * 2^scale edges draws its quadrant at every
+// level from a generator seeded with (seed, k), so the graph depends on
+// the seed only, never on the thread count. Vertex ids are scrambled by
+// a seed-derived bijection, self loops are dropped, both directions of
+// every edge are stored and duplicates are merged keeping the smallest
+// weight. Weights are integers in [1, max_weight].
+//
+// The CSR is filled directly: one pass counts the row lengths, a second
+// one regenerates the edges and scatters them, so no edge list is ever
+// materialized.
+//--------------------------------------------------------------------
+
+struct RmatParams
+{
+    unsigned scale = 16;
+    unsigned edge_factor = 16;
+    double a = 0.57;
+    double b = 0.19;
+    double c = 0.19;
+    std::uint64_t seed = 1;
+    std::uint32_t max_weight = 255; // 0: pattern graph, no weights section
+    unsigned nthreads = 0;          // 0: $GRAPH_THREADS or the number of cores
+};
+
+// Fills cache with an in-memory image (as graph_cache_load would return
+// for the same graph). Returns 0 on success.
+int rmat_generate(const RmatParams &params, GraphCache *cache);
+
+// Parses "rmat:<scale>[:<edge_factor>[:<seed>]]"; false if spec is not
+// an rmat spec
+bool rmat_parse_spec(const std::string &spec, RmatParams &params);
+
+// Writes the graph in a loader format (1-based MatrixMarket "general"
+// or DIMACS "p sp"/"a" lines), then the matching .gcsr cache next to it
+// so the first load does not parse. Returns 0 on success.
+int rmat_write_mtx(const char *path, GraphCache *cache);
+int rmat_write_dimacs(const char *path, GraphCache *cache);
+
+#endif // RMAT_HPP
@@ -0,0 +1,106 @@
+#ifndef SPLA_BUILD_HPP
+#define SPLA_BUILD_HPP
+
+#include <spla.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "graph_cache.h"
+#include "graph_trace.h"
+
+//--------------------------------------------------------------------
+// Bulk construction of spla::Matrix from the cached CSR.
+//
+// The entries are gathered once into (row, col, value) arrays of the
+// 32-bit key width SPLA uses and passed to Matrix::build through
+// MemView, instead of one set_* call per edge. Arrays are row-major
+// sorted, so the following COO -> CSR conversion is a single scan.
+//--------------------------------------------------------------------
+
+template <typename T>
+struct SplaCoo
+{
+    std::vector<unsigned int> rows;
+    std::vector<unsigned int> cols;
+    std::vector<T> values;
+};
+
+// Takes the first `limit` entries of rows [0, nrows) with column < ncols.
+// With transpose the result holds A^T, still sorted by (row, col). Values
+// come from the cache weights when use_weights is set, else `fallback`.
+template <typename T>
+SplaCoo<T> coo_from_cache(const GraphCache &cache, std::uint64_t nrows, std::uint64_t ncols, std::uint64_t limit,
+                          bool transpose, bool use_weights, T fallback)
+{
+    nrows = std::min<std::uint64_t>(nrows, cache.header.n);
+    const std::uint64_t end = std::min<std::uint64_t>(cache.row_ptr[nrows], limit);
+    auto value = [&](std::uint64_t k)
+    { return (use_weights && cache.weights) ? static_cast<T>(cache.weights[k]) : fallback; };
+
+    SplaCoo<T> coo;
+    std::uint64_t count = 0;
+    for (std::uint64_t k = 0; k < end; k++)
+        count += cache.col_idx[k] < ncols;
+    coo.rows.resize(count);
+    coo.cols.resize(count);
+    coo.values.resize(count);
+
+    if (!transpose)
+    {
+        std::uint64_t pos = 0;
+        for (std::uint64_t u = 0; u < nrows; u++)
+        {
+            for (std::uint64_t k = cache.row_ptr[u]; k < cache.row_ptr[u + 1] && k < end; k++)
+            {
+                if (cache.col_idx[k] >= ncols)
+                    continue;
+                coo.rows[pos] = static_cast<unsigned int>(u);
+                coo.cols[pos] = static_cast<unsigned int>(cache.col_idx[k]);
+                coo.values[pos] = value(k);
+                pos++;
+            }
+        }
+        return coo;
+    }
+
+    // Counting sort by column keeps rows ascending inside every column
+    std::vector<std::uint64_t> offset(ncols + 1, 0);
+    for (std::uint64_t k = 0; k < end; k++)
+        if (cache.col_idx[k] < ncols)
+            offset[cache.col_idx[k] + 1]++;
+    for (std::uint64_t c = 0; c < ncols; c++)
+        offset[c + 1] += offset[c];
+    for (std::uint64_t u = 0; u < nrows; u++)
+    {
+        for (std::uint64_t k = cache.row_ptr[u]; k < cache.row_ptr[u + 1] && k < end; k++)
+        {
+            std::uint64_t c = cache.col_idx[k];
+            if (c >= ncols)
+                continue;
+            std::uint64_t pos = offset[c]++;
+            coo.rows[pos] = static_cast<unsigned int>(c);
+            coo.cols[pos] = static_cast<unsigned int>(u);
+            coo.values[pos] = value(k);
+        }
+    }
+    return coo;
+}
+
+template <typename T>
+void build_matrix(const spla::ref_ptr<spla::Matrix> &m, SplaCoo<T> &coo)
+{
+    auto keys1 = spla::MemView::make(coo.rows.data(), coo.rows.size() * sizeof(unsigned int), false);
+    auto keys2 = spla::MemView::make(coo.cols.data(), coo.cols.size() * sizeof(unsigned int), false);
+    auto values = spla::MemView::make(coo.values.data(), coo.values.size() * sizeof(T), false);
+    spla::Status status;
+    TRACE_CALL("spla::Matrix::build", status = m->build(keys1, keys2, values));
+    if (status != spla::Status::Ok)
+    {
+        throw std::runtime_error("spla::Matrix::build failed");
+    }
+}
+
+#endif // SPLA_BUILD_HPP
@@ -0,0 +1,90 @@
+#ifndef UNDIRECTED_CSR_HPP
+#define UNDIRECTED_CSR_HPP
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "graph_cache.h"
+#include "parallel.hpp"
+
+//--------------------------------------------------------------------
+// Undirected adjacency of a cached graph.
+//
+// The cache stores the entries as the file lists them, one direction
+// for symmetric MatrixMarket and both for general files. The kernels
+// that need every neighbour of a vertex (tc, the dynamic tc, the
+// reorderings, the compressed graph) build the same thing. They take
+// both directions of every non-loop entry. A counting pass adds the
+// degrees with atomics, and a second pass scatters the entries through
+// atomic cursors. Parallel entries are kept and the rows are left
+// unsorted; callers sort and merge as they need.
+//--------------------------------------------------------------------
+
+constexpr std::uint64_t UNDIRECTED_BLOCK = 4096; // cache rows per scheduling block
+
+// Vertex count of the cache as an Index; throws when the ids do not fit
+// below the largest value, which the kernels keep as a sentinel
+template <typename Index>
+Index undirected_vertices(const GraphCache &cache, const char *who)
+{
+    const std::uint64_t n = graph_cache_vertices(&cache);
+    if (n >= std::numeric_limits<Index>::max())
+        throw std::runtime_error(std::string(who) + ": too many vertices for " + std::to_string(8 * sizeof(Index)) +
+                                 "-bit ids");
+    return static_cast<Index>(n);
+}
+
+// f(i, j, k, t) for every entry k = (i, j) of the cache with i != j,
+// cache rows spread over nthreads (t is the worker)
+template <typename F>
+void for_each_undirected_entry(const GraphCache &cache, unsigned nthreads, F &&f)
+{
+    parallel_for_dynamic(nthreads, cache.header.n, UNDIRECTED_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+        for (std::uint64_t i = b; i < e; i++)
+            for (std::uint64_t k = cache.row_ptr[i]; k < cache.row_ptr[i + 1]; k++)
+            {
+                const std::uint64_t j = cache.col_idx[k];
+                if (j != i)
+                    f(i, j, k, t);
+            } });
+}
+
+template <typename Index>
+struct UndirectedCsr
+{
+    Index n = 0;
+    std::vector<std::uint64_t> ptr; // row v is adj[ptr[v], ptr[v + 1])
+    std::vector<Index> adj;
+
+    std::uint64_t degree(Index v) const { return ptr[v + 1] - ptr[v]; }
+};
+
+// Both directions of every non-loop entry; who names the caller in the
+// error thrown by undirected_vertices
+template <typename Index>
+UndirectedCsr<Index> undirected_csr(const GraphCache &cache, unsigned nthreads, const char *who)
+{
+    UndirectedCsr<Index> g;
+    g.n = undirected_vertices<Index>(cache, who);
+    g.ptr.assign(std::uint64_t(g.n) + 1, 0);
+    for_each_undirected_entry(cache, nthreads, [&](std::uint64_t i, std::uint64_t j, std::uint64_t, unsigned)
+                              {
+        __atomic_fetch_add(&g.ptr[i + 1], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&g.ptr[j + 1], 1, __ATOMIC_RELAXED); });
+    for (Index v = 0; v < g.n; v++)
+        g.ptr[v + 1] += g.ptr[v];
+
+    g.adj.resize(g.ptr[g.n]);
+    std::vector<std::uint64_t> cursor(g.ptr.begin(), g.ptr.end() - 1);
+    for_each_undirected_entry(cache, nthreads, [&](std::uint64_t i, std::uint64_t j, std::uint64_t, unsigned)
+                              {
+        g.adj[__atomic_fetch_add(&cursor[i], 1, __ATOMIC_RELAXED)] = static_cast<Index>(j);
+        g.adj[__atomic_fetch_add(&cursor[j], 1, __ATOMIC_RELAXED)] = static_cast<Index>(i); });
+    return g;
+}
+
+#endif // UNDIRECTED_CSR_HPP
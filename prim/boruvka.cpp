@@ -0,0 +1,304 @@
+#include "boruvka.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../common/parallel.hpp"
+
+namespace
+{
+    constexpr std::uint64_t EMPTY = std::numeric_limits<std::uint64_t>::max();
+
+    // Lock-free union-find: find with path halving, union links the larger
+    // root under the smaller one with a single CAS
+    template <typename Index>
+    class UnionFind
+    {
+    public:
+        UnionFind(Index n, unsigned nthreads)
+            : m_parent(n)
+        {
+            parallel_for(nthreads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+                for (std::uint64_t i = b; i < e; i++)
+                    m_parent[i].store(static_cast<Index>(i), std::memory_order_relaxed); });
+        }
+
+        Index find(Index x)
+        {
+            for (;;)
+            {
+                Index p = m_parent[x].load(std::memory_order_acquire);
+                if (p == x)
+                    return x;
+                Index gp = m_parent[p].load(std::memory_order_acquire);
+                if (p != gp)
+                    m_parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel);
+                x = gp;
+            }
+        }
+
+        bool unite(Index a, Index b)
+        {
+            for (;;)
+            {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                    return false;
+                if (a < b)
+                    std::swap(a, b);
+                Index expected = a;
+                if (m_parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+                    return true;
+            }
+        }
+
+    private:
+        std::vector<std::atomic<Index>> m_parent;
+    };
+
+    inline void atomic_min(std::atomic<std::uint64_t> &slot, std::uint64_t value)
+    {
+        std::uint64_t cur = slot.load(std::memory_order_relaxed);
+        while (value < cur && !slot.compare_exchange_weak(cur, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Order-preserving 32-bit keys: the weight itself when all weights are
+    // small non-negative integers (the usual case), otherwise its rank.
+    // Unsigned weight types are their own keys and need no array.
+    template <typename Weight>
+    std::vector<std::uint32_t> weight_keys(const std::vector<Weight> &w, unsigned nthreads)
+    {
+        std::vector<std::uint32_t> keys(w.size());
+        std::atomic<bool> integral{true};
+        parallel_for(nthreads, w.size(), [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                if (!(w[k] >= 0 && w[k] < 4294967296.0 && std::floor(w[k]) == w[k]))
+                {
+                    integral.store(false, std::memory_order_relaxed);
+                    return;
+                }
+                keys[k] = static_cast<std::uint32_t>(w[k]);
+            } });
+        if (integral.load())
+            return keys;
+
+        std::vector<Weight> sorted(w);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        parallel_for(nthreads, w.size(), [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+                keys[k] = static_cast<std::uint32_t>(std::lower_bound(sorted.begin(), sorted.end(), w[k]) - sorted.begin()); });
+        return keys;
+    }
+}
+
+template <typename Index, typename Weight>
+BasicMstEdges<Index, Weight> mst_edges_from_cache(const GraphCache &cache, std::uint64_t n)
+{
+    BasicMstEdges<Index, Weight> edges;
+    edges.n = static_cast<Index>(n);
+    std::uint64_t rows = std::min<std::uint64_t>(n, cache.header.n);
+    edges.u.reserve(cache.row_ptr[rows]);
+    edges.v.reserve(cache.row_ptr[rows]);
+    edges.w.reserve(cache.row_ptr[rows]);
+    for (std::uint64_t u = 0; u < rows; u++)
+    {
+        for (std::uint64_t k = cache.row_ptr[u]; k < cache.row_ptr[u + 1]; k++)
+        {
+            if (cache.col_idx[k] >= n)
+                continue;
+            edges.u.push_back(static_cast<Index>(u));
+            edges.v.push_back(static_cast<Index>(cache.col_idx[k]));
+            edges.w.push_back(cache.weights ? static_cast<Weight>(cache.weights[k]) : Weight(1));
+        }
+    }
+    return edges;
+}
+
+template <typename Index, typename Weight>
+std::vector<Index> orient_forest(const BasicMstEdges<Index, Weight> &all, const std::vector<std::uint64_t> &edges)
+{
+    const Index n = all.n;
+    std::vector<std::uint64_t> offset(std::uint64_t(n) + 1, 0);
+    for (auto e : edges)
+    {
+        offset[all.u[e] + 1]++;
+        offset[all.v[e] + 1]++;
+    }
+    for (Index i = 0; i < n; i++)
+        offset[i + 1] += offset[i];
+    std::vector<Index> adj(offset[n]);
+    std::vector<std::uint64_t> fill(offset.begin(), offset.end() - 1);
+    for (auto e : edges)
+    {
+        adj[fill[all.u[e]]++] = all.v[e];
+        adj[fill[all.v[e]]++] = all.u[e];
+    }
+
+    std::vector<Index> parent(n, mst_no_parent<Index>);
+    std::vector<bool> seen(n, false);
+    std::vector<Index> queue;
+    queue.reserve(n);
+    for (Index root = 0; root < n; root++)
+    {
+        if (seen[root])
+            continue;
+        seen[root] = true;
+        queue.clear();
+        queue.push_back(root);
+        for (std::size_t head = 0; head < queue.size(); head++)
+        {
+            Index x = queue[head];
+            for (std::uint64_t k = offset[x]; k < offset[x + 1]; k++)
+            {
+                Index y = adj[k];
+                if (seen[y])
+                    continue;
+                seen[y] = true;
+                parent[y] = x;
+                queue.push_back(y);
+            }
+        }
+    }
+    return parent;
+}
+
+template <typename Index, typename Weight>
+BasicMstResult<Index> boruvka_mst(const BasicMstEdges<Index, Weight> &edges, unsigned nthreads)
+{
+    const unsigned threads = resolve_threads(nthreads);
+    const Index n = edges.n;
+    const std::uint64_t m = edges.u.size();
+    if (m >= EMPTY >> 32)
+        throw std::runtime_error("boruvka_mst: too many edges for 32-bit edge ids");
+
+    BasicMstResult<Index> result;
+    constexpr bool direct_keys = std::is_unsigned_v<Weight> && sizeof(Weight) <= sizeof(std::uint32_t);
+    std::vector<std::uint32_t> keys;
+    if constexpr (!direct_keys)
+        keys = weight_keys(edges.w, threads);
+    auto key = [&](std::uint64_t id) -> std::uint64_t
+    {
+        if constexpr (direct_keys)
+            return edges.w[id];
+        else
+            return keys[id];
+    };
+
+    UnionFind<Index> uf(n, threads);
+    std::vector<std::atomic<std::uint64_t>> best(n);
+
+    std::vector<std::uint64_t> active;
+    active.reserve(m);
+    for (std::uint64_t e = 0; e < m; e++)
+        if (edges.u[e] != edges.v[e])
+            active.push_back(e);
+
+    std::vector<std::vector<std::uint64_t>> chosen(threads);
+    std::vector<double> weight(threads, 0.0);
+    std::vector<std::uint64_t> kept(threads + 1);
+    std::vector<std::uint64_t> next(active.size());
+
+    while (!active.empty())
+    {
+        result.rounds++;
+
+        parallel_for(threads, n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t i = b; i < e; i++)
+                best[i].store(EMPTY, std::memory_order_relaxed); });
+
+        // Lightest outgoing edge of every component
+        parallel_for(threads, active.size(), [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                std::uint64_t id = active[k];
+                Index cu = uf.find(edges.u[id]);
+                Index cv = uf.find(edges.v[id]);
+                if (cu == cv)
+                    continue;
+                std::uint64_t packed = (key(id) << 32) | id;
+                atomic_min(best[cu], packed);
+                atomic_min(best[cv], packed);
+            } });
+
+        // Contract along the chosen edges
+        std::uint64_t merged_before = result.tree_edges;
+        parallel_for(threads, n, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                     {
+            for (std::uint64_t c = b; c < e; c++)
+            {
+                std::uint64_t packed = best[c].load(std::memory_order_relaxed);
+                if (packed == EMPTY)
+                    continue;
+                std::uint64_t id = packed & 0xffffffffu;
+                if (uf.unite(edges.u[id], edges.v[id]))
+                {
+                    weight[t] += static_cast<double>(edges.w[id]);
+                    chosen[t].push_back(id);
+                }
+            } });
+        result.tree_edges = 0;
+        for (auto &c : chosen)
+            result.tree_edges += c.size();
+        if (result.tree_edges == merged_before)
+            break;
+
+        // Drop edges that became internal to a component
+        parallel_for(threads, active.size(), [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                     {
+            std::uint64_t count = 0;
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                std::uint64_t id = active[k];
+                if (uf.find(edges.u[id]) != uf.find(edges.v[id]))
+                    next[b + count++] = id;
+            }
+            kept[t + 1] = count; });
+        std::uint64_t total = 0;
+        const unsigned parts = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(threads, active.size())));
+        for (unsigned t = 0; t < parts; t++)
+        {
+            std::uint64_t b = active.size() * t / parts;
+            std::copy(next.begin() + b, next.begin() + b + kept[t + 1], active.begin() + total);
+            total += kept[t + 1];
+        }
+        active.resize(total);
+    }
+
+    std::vector<std::uint64_t> tree;
+    tree.reserve(result.tree_edges);
+    for (unsigned t = 0; t < threads; t++)
+    {
+        result.weight += weight[t];
+        tree.insert(tree.end(), chosen[t].begin(), chosen[t].end());
+    }
+    result.parent = orient_forest(edges, tree);
+    return result;
+}
+
+#define BORUVKA_INSTANTIATE(Index, Weight)                                                                   \
+    template BasicMstEdges<Index, Weight> mst_edges_from_cache<Index, Weight>(const GraphCache &, std::uint64_t); \
+    template std::vector<Index> orient_forest(const BasicMstEdges<Index, Weight> &,                          \
+                                              const std::vector<std::uint64_t> &);                           \
+    template BasicMstResult<Index> boruvka_mst(const BasicMstEdges<Index, Weight> &, unsigned);
+
+BORUVKA_INSTANTIATE(std::uint32_t, std::uint16_t)
+BORUVKA_INSTANTIATE(std::uint32_t, std::uint32_t)
+BORUVKA_INSTANTIATE(std::uint32_t, float)
+BORUVKA_INSTANTIATE(std::uint32_t, double)
+BORUVKA_INSTANTIATE(std::uint64_t, std::uint16_t)
+BORUVKA_INSTANTIATE(std::uint64_t, std::uint32_t)
+BORUVKA_INSTANTIATE(std::uint64_t, float)
+BORUVKA_INSTANTIATE(std::uint64_t, double)
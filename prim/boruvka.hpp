@@ -0,0 +1,68 @@
+#ifndef BORUVKA_HPP
+#define BORUVKA_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "../common/graph_cache.h"
+
+//--------------------------------------------------------------------
+// Native parallel Borůvka minimum spanning forest.
+//
+// Every round computes the lightest outgoing edge of each component
+// with an atomic min over packed (weight key << 32 | edge id) words,
+// then merges the chosen edges with a lock-free union-find. Ties are
+// broken by edge id, so the chosen edges never close a cycle.
+//--------------------------------------------------------------------
+
+// Vertex ids and weights are template parameters (see
+// common/graph_types.hpp); MstEdges and MstResult are the 32-bit id,
+// double weight instances that the other kernels use. Instances exist
+// for uint32_t and uint64_t ids with uint16_t, uint32_t, float and
+// double weights.
+
+template <typename Index>
+constexpr Index mst_no_parent = std::numeric_limits<Index>::max();
+
+constexpr std::uint32_t MST_NO_PARENT = mst_no_parent<std::uint32_t>;
+
+template <typename Index>
+struct BasicMstResult
+{
+    double weight = 0.0;
+    // parent[v] in the forest rooted at the smallest vertex of every
+    // component, mst_no_parent for roots (unset in mst / mst_parents)
+    std::vector<Index> parent;
+    std::uint64_t tree_edges = 0;
+    std::uint32_t rounds = 0;
+};
+
+// Undirected edge list, one entry per stored (u, v) pair
+template <typename Index, typename Weight>
+struct BasicMstEdges
+{
+    Index n = 0;
+    std::vector<Index> u;
+    std::vector<Index> v;
+    std::vector<Weight> w;
+};
+
+using MstResult = BasicMstResult<std::uint32_t>;
+using MstEdges = BasicMstEdges<std::uint32_t, double>;
+
+// Entries of rows [0, n) with column < n; pattern graphs get weight 1.
+// Weights are converted to Weight as they are, so the caller picks a type
+// that holds them (graph_types_fit).
+template <typename Index = std::uint32_t, typename Weight = double>
+BasicMstEdges<Index, Weight> mst_edges_from_cache(const GraphCache &cache, std::uint64_t n);
+
+// Roots every tree of the forest given by `edges` (indices into all)
+// at its smallest vertex
+template <typename Index, typename Weight>
+std::vector<Index> orient_forest(const BasicMstEdges<Index, Weight> &all, const std::vector<std::uint64_t> &edges);
+
+template <typename Index, typename Weight>
+BasicMstResult<Index> boruvka_mst(const BasicMstEdges<Index, Weight> &edges, unsigned nthreads = 0);
+
+#endif // BORUVKA_HPP
@@ -0,0 +1,230 @@
+#include "component_mst.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "../common/components.hpp"
+#include "../common/indexed_heap.hpp"
+#include "../common/parallel.hpp"
+
+namespace
+{
+    constexpr std::uint64_t PRIM_MAX_VERTICES = std::numeric_limits<std::uint32_t>::max() - 1; // heap ids are 32-bit
+    constexpr std::uint64_t BORUVKA_EDGES = std::uint64_t(1) << 18; // components this large use Borůvka even alone
+    constexpr std::uint64_t POOL_SHARE = 8; // the pool runs if small components hold 1/POOL_SHARE of the edges
+
+    // Per-thread buffers of the Prim components, sized by the largest
+    template <typename Weight>
+    struct PrimScratch
+    {
+        std::unique_ptr<IndexedDaryHeap<Weight>> heap;
+        std::vector<std::uint64_t> ptr;
+        std::vector<std::uint32_t> adj;
+        std::vector<Weight> w;
+        std::vector<std::uint32_t> via;
+        std::vector<char> done;
+    };
+}
+
+template <typename Index, typename Weight>
+BasicComponentForest<Index> component_mst(const BasicMstEdges<Index, Weight> &edges, unsigned nthreads)
+{
+    const unsigned threads = resolve_threads(nthreads);
+    const Index n = edges.n;
+    const std::uint64_t m = edges.u.size();
+    BasicComponentForest<Index> out;
+    out.forest.parent.assign(n, mst_no_parent<Index>);
+    if (n == 0)
+        return out;
+
+    const Components<Index> cc = connected_components(n, edges.u.data(), edges.v.data(), m, threads);
+    const std::uint64_t ncomp = cc.size.size();
+    out.components = ncomp;
+    out.largest = cc.size[0];
+    out.label_rounds = cc.rounds;
+
+    // Edges per component, self loops dropped
+    std::vector<std::uint64_t> edge_ptr(ncomp + 1, 0);
+    parallel_for(threads, m, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t k = b; k < e; k++)
+            if (edges.u[k] != edges.v[k])
+                __atomic_fetch_add(&edge_ptr[cc.component[edges.u[k]] + 1], 1, __ATOMIC_RELAXED); });
+    for (std::uint64_t c = 0; c < ncomp; c++)
+        edge_ptr[c + 1] += edge_ptr[c];
+
+    // Components of two or more vertices form a prefix (sizes descend)
+    const std::uint64_t spanning = static_cast<std::uint64_t>(
+        std::find_if(cc.size.begin(), cc.size.end(), [](std::uint64_t s)
+                     { return s < 2; }) -
+        cc.size.begin());
+    std::vector<std::uint64_t> large, small;
+    std::uint64_t small_edges = 0;
+    for (std::uint64_t c = 0; c < spanning; c++)
+    {
+        const std::uint64_t component_edges = edge_ptr[c + 1] - edge_ptr[c];
+        if ((threads > 1 && component_edges * threads > edge_ptr[ncomp]) || component_edges >= BORUVKA_EDGES ||
+            cc.size[c] > PRIM_MAX_VERTICES)
+        {
+            large.push_back(c);
+        }
+        else
+        {
+            small.push_back(c);
+            small_edges += component_edges;
+        }
+    }
+
+    // Little for the pool: one Borůvka over the whole list grows all the
+    // trees at once, without copying any component out
+    if (small_edges * POOL_SHARE < edge_ptr[ncomp])
+    {
+        out.boruvka_components = spanning;
+        BasicMstResult<Index> tree = boruvka_mst(edges, threads);
+        out.forest.weight = tree.weight;
+        out.forest.rounds = tree.rounds;
+        out.forest.parent = std::move(tree.parent);
+        out.forest.tree_edges = tree.tree_edges;
+        return out;
+    }
+    out.boruvka_components = large.size();
+    out.prim_components = small.size();
+
+    // Vertices grouped by component, ascending inside each, so local id 0
+    // is the smallest vertex and the root of the tree
+    std::vector<std::uint64_t> vertex_ptr(ncomp + 1, 0);
+    for (std::uint64_t c = 0; c < ncomp; c++)
+        vertex_ptr[c + 1] = vertex_ptr[c] + cc.size[c];
+    std::vector<Index> members(n), local(n);
+    {
+        std::vector<std::uint64_t> fill(vertex_ptr.begin(), vertex_ptr.end() - 1);
+        for (Index x = 0; x < n; x++)
+        {
+            const Index c = cc.component[x];
+            const std::uint64_t pos = fill[c]++;
+            members[pos] = x;
+            local[x] = static_cast<Index>(pos - vertex_ptr[c]);
+        }
+    }
+
+    // Edge ids bucketed by component
+    std::vector<std::uint64_t> bucket(edge_ptr[ncomp]);
+    {
+        std::vector<std::uint64_t> cursor(edge_ptr.begin(), edge_ptr.end() - 1);
+        parallel_for(threads, m, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+                if (edges.u[k] != edges.v[k])
+                    bucket[__atomic_fetch_add(&cursor[cc.component[edges.u[k]]], 1, __ATOMIC_RELAXED)] = k; });
+    }
+
+    std::vector<double> weight(spanning, 0.0);
+
+    // Large components one at a time, every thread on each
+    for (std::uint64_t c : large)
+    {
+        const std::uint64_t first = edge_ptr[c], count = edge_ptr[c + 1] - first;
+        BasicMstEdges<Index, Weight> sub;
+        sub.n = static_cast<Index>(cc.size[c]);
+        sub.u.resize(count);
+        sub.v.resize(count);
+        sub.w.resize(count);
+        parallel_for(threads, count, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const std::uint64_t id = bucket[first + k];
+                sub.u[k] = local[edges.u[id]];
+                sub.v[k] = local[edges.v[id]];
+                sub.w[k] = edges.w[id];
+            } });
+        const BasicMstResult<Index> tree = boruvka_mst(sub, threads);
+        weight[c] = tree.weight;
+        out.forest.rounds = std::max(out.forest.rounds, tree.rounds);
+        const Index *base = members.data() + vertex_ptr[c];
+        parallel_for(threads, sub.n, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t x = b; x < e; x++)
+                if (tree.parent[x] != mst_no_parent<Index>)
+                    out.forest.parent[base[x]] = base[tree.parent[x]]; });
+    }
+
+    // Small components largest first, one sequential Prim per task
+    std::vector<PrimScratch<Weight>> scratch(threads);
+    const std::uint64_t capacity = small.empty() ? 0 : cc.size[small.front()];
+    parallel_tasks(threads, small.size(), [&](std::uint64_t task, unsigned t)
+                   {
+        const std::uint64_t c = small[task];
+        const auto size = static_cast<std::uint32_t>(cc.size[c]);
+        const Index *base = members.data() + vertex_ptr[c];
+        PrimScratch<Weight> &s = scratch[t];
+        if (!s.heap)
+            s.heap = std::make_unique<IndexedDaryHeap<Weight>>(static_cast<std::uint32_t>(capacity));
+
+        // Local CSR, both directions of every edge
+        s.ptr.assign(std::uint64_t(size) + 1, 0);
+        for (std::uint64_t k = edge_ptr[c]; k < edge_ptr[c + 1]; k++)
+        {
+            const std::uint64_t id = bucket[k];
+            s.ptr[local[edges.u[id]] + 1]++;
+            s.ptr[local[edges.v[id]] + 1]++;
+        }
+        for (std::uint32_t x = 0; x < size; x++)
+            s.ptr[x + 1] += s.ptr[x];
+        s.adj.resize(s.ptr[size]);
+        s.w.resize(s.ptr[size]);
+        for (std::uint64_t k = edge_ptr[c]; k < edge_ptr[c + 1]; k++)
+        {
+            const std::uint64_t id = bucket[k];
+            const auto x = static_cast<std::uint32_t>(local[edges.u[id]]);
+            const auto y = static_cast<std::uint32_t>(local[edges.v[id]]);
+            s.adj[s.ptr[x]] = y;
+            s.w[s.ptr[x]++] = edges.w[id];
+            s.adj[s.ptr[y]] = x;
+            s.w[s.ptr[y]++] = edges.w[id];
+        }
+        for (std::uint32_t x = size; x > 0; x--)
+            s.ptr[x] = s.ptr[x - 1];
+        s.ptr[0] = 0;
+
+        s.via.resize(size);
+        s.done.assign(size, 0);
+        IndexedDaryHeap<Weight> &heap = *s.heap;
+        double total = 0.0;
+        heap.push_or_decrease(0, Weight{});
+        while (!heap.empty())
+        {
+            auto [key, x] = heap.pop();
+            s.done[x] = 1;
+            if (x != 0)
+            {
+                total += static_cast<double>(key);
+                out.forest.parent[base[x]] = base[s.via[x]];
+            }
+            for (std::uint64_t k = s.ptr[x]; k < s.ptr[x + 1]; k++)
+            {
+                const std::uint32_t y = s.adj[k];
+                if (!s.done[y] && heap.push_or_decrease(y, s.w[k]))
+                    s.via[y] = x;
+            }
+        }
+        weight[c] = total; });
+
+    for (double w : weight)
+        out.forest.weight += w;
+    out.forest.tree_edges = std::uint64_t(n) - ncomp;
+    return out;
+}
+
+#define COMPONENT_MST_INSTANTIATE(Index, Weight) \
+    template BasicComponentForest<Index> component_mst(const BasicMstEdges<Index, Weight> &, unsigned);
+
+COMPONENT_MST_INSTANTIATE(std::uint32_t, std::uint16_t)
+COMPONENT_MST_INSTANTIATE(std::uint32_t, std::uint32_t)
+COMPONENT_MST_INSTANTIATE(std::uint32_t, float)
+COMPONENT_MST_INSTANTIATE(std::uint32_t, double)
+COMPONENT_MST_INSTANTIATE(std::uint64_t, std::uint16_t)
+COMPONENT_MST_INSTANTIATE(std::uint64_t, std::uint32_t)
+COMPONENT_MST_INSTANTIATE(std::uint64_t, float)
+COMPONENT_MST_INSTANTIATE(std::uint64_t, double)
@@ -0,0 +1,46 @@
+#ifndef COMPONENT_MST_HPP
+#define COMPONENT_MST_HPP
+
+#include <cstdint>
+
+#include "boruvka.hpp"
+
+//--------------------------------------------------------------------
+// Minimum spanning forest, component by component.
+//
+// The Prim drivers grow one tree at a time: prim_spla walks the
+// components one after another, and mst_prim in prim_SuiteSparse.c used
+// to stop at the end of the first one. Here the components are labelled
+// first with the parallel FastSV pass of common/components.hpp and their
+// edges are bucketed per component. Components holding more than
+// 1/nthreads of the edges, or 2^18 edges, run one at a time on the
+// parallel Borůvka. The rest run a sequential Prim each (indexed d-ary
+// heap, local CSR), largest first, on a work-stealing pool
+// (parallel_tasks), so the many small components of internet-like
+// inputs keep every thread busy. When the small components hold under
+// 1/8 of the edges, a single Borůvka over the whole list is cheaper
+// than splitting the graph and is used instead.
+//
+// Every tree is rooted at the smallest vertex of its component, as
+// boruvka_mst does. With equal weights the chosen edges may differ
+// between runs, but the forest weight does not.
+//--------------------------------------------------------------------
+
+template <typename Index>
+struct BasicComponentForest
+{
+    BasicMstResult<Index> forest; // rounds: most Borůvka rounds of one component
+    std::uint64_t components = 0;  // isolated vertices included
+    std::uint64_t largest = 0;     // vertices of the largest component
+    std::uint64_t boruvka_components = 0;
+    std::uint64_t prim_components = 0; // components of two or more vertices on the pool
+    std::uint32_t label_rounds = 0;    // FastSV rounds
+};
+
+using ComponentForest = BasicComponentForest<std::uint32_t>;
+
+// Instances for the id and weight types of boruvka_mst
+template <typename Index, typename Weight>
+BasicComponentForest<Index> component_mst(const BasicMstEdges<Index, Weight> &edges, unsigned nthreads = 0);
+
+#endif // COMPONENT_MST_HPP
@@ -0,0 +1,46 @@
+#include "compressed_prim.hpp"
+
+#include <algorithm>
+
+#include "../common/bitset.hpp"
+#include "../common/indexed_heap.hpp"
+
+MstResult prim_compressed(const CompressedGraph &graph)
+{
+    const std::uint32_t n = graph.n();
+    std::uint32_t max_degree = 0;
+    for (std::uint32_t v = 0; v < n; v++)
+        max_degree = std::max(max_degree, graph.degree(v));
+    std::vector<std::uint32_t> nbrs(std::uint64_t(max_degree) + 3);
+    std::vector<double> w(max_degree);
+
+    MstResult result;
+    result.parent.assign(n, MST_NO_PARENT);
+    IndexedDaryHeap<double> heap(n);
+    DenseBitset done(n);
+    for (std::uint32_t root = 0; root < n; root++)
+    {
+        if (done.test(root))
+            continue;
+        heap.push_or_decrease(root, 0.0);
+        while (!heap.empty())
+        {
+            auto [weight, v] = heap.pop();
+            done.set(v);
+            if (result.parent[v] != MST_NO_PARENT)
+            {
+                result.weight += weight;
+                result.tree_edges++;
+            }
+            graph.neighbors(v, nbrs.data());
+            graph.weights(v, w.data());
+            for (std::uint32_t k = 0; k < graph.degree(v); k++)
+            {
+                const std::uint32_t x = nbrs[k];
+                if (!done.test(x) && heap.push_or_decrease(x, w[k]))
+                    result.parent[x] = v;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifndef COMPRESSED_PRIM_HPP
+#define COMPRESSED_PRIM_HPP
+
+#include "../common/compressed_graph.hpp"
+#include "boruvka.hpp"
+
+//--------------------------------------------------------------------
+// Prim's minimum spanning forest straight from the compressed store.
+//
+// One tree per component, grown from its smallest vertex with the
+// indexed d-ary heap of the Prim drivers; the row of every settled
+// vertex is decoded into a scratch buffer instead of being extracted
+// from an uncompressed matrix, so the graph stays compressed throughout.
+// With quantized weights the forest is minimal for the quantized
+// weights and its weight is reported in them.
+//--------------------------------------------------------------------
+
+MstResult prim_compressed(const CompressedGraph &graph);
+
+#endif // COMPRESSED_PRIM_HPP
@@ -0,0 +1,306 @@
+#include "dynamic_mst.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "../common/parallel.hpp"
+
+namespace
+{
+    constexpr std::uint64_t BUILD_BLOCK = 4096; // vertices per scheduling block
+
+    bool by_vertex(const std::pair<std::uint32_t, double> &a, std::uint32_t v)
+    {
+        return a.first < v;
+    }
+}
+
+DynamicMst::DynamicMst(const MstEdges &edges, unsigned nthreads)
+{
+    const unsigned threads = resolve_threads(nthreads);
+    const std::uint32_t n = edges.n;
+
+    // Adjacency: both directions, lightest of parallel entries
+    m_adj.resize(n);
+    for (std::size_t e = 0; e < edges.u.size(); e++)
+    {
+        if (edges.u[e] == edges.v[e])
+            continue;
+        m_adj[edges.u[e]].emplace_back(edges.v[e], edges.w[e]);
+        m_adj[edges.v[e]].emplace_back(edges.u[e], edges.w[e]);
+    }
+    parallel_for_dynamic(threads, n, BUILD_BLOCK, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t v = b; v < e; v++)
+        {
+            Adj &row = m_adj[v];
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end(), [](const auto &x, const auto &y)
+                                  { return x.first == y.first; }),
+                      row.end());
+        } });
+
+    // Initial forest from Borůvka, rooted at the smallest vertex of every tree
+    MstResult initial = boruvka_mst(edges, threads);
+    m_parent = std::move(initial.parent);
+    m_parent_w.assign(n, 0.0);
+    m_tree.resize(n);
+    for (std::uint32_t v = 0; v < n; v++)
+    {
+        std::uint32_t p = m_parent[v];
+        if (p == MST_NO_PARENT)
+            continue;
+        m_parent_w[v] = edge_weight(v, p);
+        m_weight += m_parent_w[v];
+        m_tree[v].push_back(p);
+        m_tree[p].push_back(v);
+        m_tree_edges++;
+    }
+
+    m_depth.assign(n, 0);
+    m_size.assign(n, 1);
+    m_mark.assign(n, 0);
+    m_queue.reserve(n);
+    for (std::uint32_t root = 0; root < n; root++)
+    {
+        if (m_parent[root] != MST_NO_PARENT)
+            continue;
+        m_queue.clear();
+        m_queue.push_back(root);
+        for (std::size_t head = 0; head < m_queue.size(); head++)
+        {
+            std::uint32_t x = m_queue[head];
+            for (std::uint32_t z : m_tree[x])
+                if (m_parent[z] == x)
+                {
+                    m_depth[z] = m_depth[x] + 1;
+                    m_queue.push_back(z);
+                }
+        }
+        m_size[root] = static_cast<std::uint32_t>(m_queue.size());
+    }
+}
+
+double DynamicMst::edge_weight(std::uint32_t u, std::uint32_t v) const
+{
+    const Adj &row = m_adj[u];
+    auto it = std::lower_bound(row.begin(), row.end(), v, by_vertex);
+    return it != row.end() && it->first == v ? it->second : -1.0;
+}
+
+MstEdges DynamicMst::edges() const
+{
+    MstEdges out;
+    out.n = n();
+    for (std::uint32_t u = 0; u < n(); u++)
+        for (const auto &[v, w] : m_adj[u])
+            if (u < v)
+            {
+                out.u.push_back(u);
+                out.v.push_back(v);
+                out.w.push_back(w);
+            }
+    return out;
+}
+
+MstBatchResult DynamicMst::apply(const std::vector<MstUpdate> &batch)
+{
+    MstBatchResult result;
+    for (const MstUpdate &up : batch)
+    {
+        if (up.u >= n() || up.v >= n())
+            throw std::out_of_range("DynamicMst::apply: vertex id out of range");
+        if (up.u != up.v)
+            update(up, result);
+    }
+    return result;
+}
+
+void DynamicMst::update(const MstUpdate &up, MstBatchResult &result)
+{
+    const std::uint32_t u = up.u, v = up.v;
+    const double w = up.w;
+
+    // Store the new weight in both rows
+    double old = -1.0;
+    for (auto [a, b] : {std::pair{u, v}, std::pair{v, u}})
+    {
+        Adj &row = m_adj[a];
+        auto it = std::lower_bound(row.begin(), row.end(), b, by_vertex);
+        if (it != row.end() && it->first == b)
+        {
+            old = it->second;
+            it->second = w;
+        }
+        else
+            row.insert(it, {b, w});
+    }
+    if (old < 0.0)
+        result.inserted++;
+
+    if (m_parent[u] == v || m_parent[v] == u)
+    {
+        std::uint32_t c = m_parent[u] == v ? u : v;
+        m_weight += w - m_parent_w[c];
+        m_parent_w[c] = w;
+        if (w > old)
+            repair_cut(c, result);
+        return;
+    }
+    if (old >= 0.0 && w >= old)
+        return;
+    replace_on_cycle(u, v, w, result);
+}
+
+std::uint32_t DynamicMst::root_of(std::uint32_t v) const
+{
+    while (m_parent[v] != MST_NO_PARENT)
+        v = m_parent[v];
+    return v;
+}
+
+void DynamicMst::tree_unlink(std::uint32_t a, std::uint32_t b)
+{
+    for (auto [x, y] : {std::pair{a, b}, std::pair{b, a}})
+    {
+        auto &row = m_tree[x];
+        auto it = std::find(row.begin(), row.end(), y);
+        *it = row.back();
+        row.pop_back();
+    }
+}
+
+void DynamicMst::hang(std::uint32_t x, std::uint32_t top, std::uint32_t y, double w)
+{
+    // Reverse the parent pointers on the path x .. top
+    std::uint32_t cur = x, new_parent = y;
+    double new_w = w;
+    for (;;)
+    {
+        std::uint32_t old_parent = m_parent[cur];
+        double old_w = m_parent_w[cur];
+        m_parent[cur] = new_parent;
+        m_parent_w[cur] = new_w;
+        if (cur == top)
+            break;
+        new_parent = cur;
+        new_w = old_w;
+        cur = old_parent;
+    }
+    m_tree[x].push_back(y);
+    m_tree[y].push_back(x);
+
+    // Depths below the new attachment point
+    m_depth[x] = m_depth[y] + 1;
+    m_queue.clear();
+    m_queue.push_back(x);
+    for (std::size_t head = 0; head < m_queue.size(); head++)
+    {
+        std::uint32_t z = m_queue[head];
+        for (std::uint32_t c : m_tree[z])
+            if (m_parent[c] == z)
+            {
+                m_depth[c] = m_depth[z] + 1;
+                m_queue.push_back(c);
+            }
+    }
+}
+
+void DynamicMst::link_trees(std::uint32_t u, std::uint32_t v, double w)
+{
+    std::uint32_t ru = root_of(u), rv = root_of(v);
+    if (m_size[ru] > m_size[rv])
+    {
+        std::swap(u, v);
+        std::swap(ru, rv);
+    }
+    hang(u, ru, v, w);
+    m_size[rv] += m_size[ru];
+    m_weight += w;
+    m_tree_edges++;
+}
+
+void DynamicMst::replace_on_cycle(std::uint32_t u, std::uint32_t v, double w, MstBatchResult &result)
+{
+    // Heaviest edge on the tree path, identified by its lower vertex and
+    // the side (u or v) it was met from
+    std::uint32_t x = u, y = v;
+    double heaviest = -std::numeric_limits<double>::infinity();
+    std::uint32_t below = MST_NO_PARENT;
+    bool from_v = false;
+    auto step = [&](std::uint32_t &z, bool side)
+    {
+        if (m_parent_w[z] > heaviest)
+        {
+            heaviest = m_parent_w[z];
+            below = z;
+            from_v = side;
+        }
+        z = m_parent[z];
+    };
+    while (m_depth[x] > m_depth[y])
+        step(x, false);
+    while (m_depth[y] > m_depth[x])
+        step(y, true);
+    while (x != y)
+    {
+        if (m_parent[x] == MST_NO_PARENT)
+        {
+            // Different trees
+            link_trees(u, v, w);
+            result.tree_changes++;
+            return;
+        }
+        step(x, false);
+        step(y, true);
+    }
+    if (heaviest <= w)
+        return;
+
+    const std::uint32_t inside = from_v ? v : u, outside = from_v ? u : v;
+    tree_unlink(below, m_parent[below]);
+    m_weight += w - heaviest;
+    hang(inside, below, outside, w);
+    result.tree_changes++;
+}
+
+void DynamicMst::repair_cut(std::uint32_t c, MstBatchResult &result)
+{
+    // Subtree of c
+    m_queue.clear();
+    m_queue.push_back(c);
+    m_mark[c] = 1;
+    for (std::size_t head = 0; head < m_queue.size(); head++)
+    {
+        std::uint32_t z = m_queue[head];
+        for (std::uint32_t k : m_tree[z])
+            if (m_parent[k] == z)
+            {
+                m_mark[k] = 1;
+                m_queue.push_back(k);
+            }
+    }
+
+    // Lightest edge leaving it; the current parent edge wins ties
+    const std::uint32_t p = m_parent[c];
+    double best = m_parent_w[c];
+    std::uint32_t bx = c, by = p;
+    for (std::uint32_t x : m_queue)
+        for (const auto &[y, wy] : m_adj[x])
+            if (!m_mark[y] && wy < best)
+            {
+                best = wy;
+                bx = x;
+                by = y;
+            }
+    for (std::uint32_t x : m_queue)
+        m_mark[x] = 0;
+    if (bx == c && by == p)
+        return;
+
+    tree_unlink(c, p);
+    m_weight += best - m_parent_w[c];
+    hang(bx, c, by, best);
+    result.tree_changes++;
+}
@@ -0,0 +1,95 @@
+#ifndef DYNAMIC_MST_HPP
+#define DYNAMIC_MST_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "boruvka.hpp"
+
+//--------------------------------------------------------------------
+// Minimum spanning forest maintained under edge insertions and weight
+// changes.
+//
+// The forest is kept as a rooted parent vector with the weight of every
+// parent edge and the depth of every vertex, starting from the Borůvka
+// forest. Updates are repaired locally:
+//  - new edge or lighter non-tree edge (u, v): if u and v are in
+//    different trees the smaller tree is re-rooted at its end and linked;
+//    otherwise the heaviest edge on the tree path u-v is found by
+//    climbing from both ends, and replaced when it is heavier (cycle
+//    rule);
+//  - heavier tree edge: the subtree below it is cut off and the lightest
+//    edge leaving it (the edge itself included) reconnects it (cut rule);
+//  - lighter tree edge, heavier non-tree edge: only the weight changes.
+// Edges are never removed, so every tree keeps spanning its connected
+// component and any edge leaving a cut-off subtree leads back into the
+// same tree. A repair costs the tree path, or the cut-off subtree and
+// its incident edges, instead of the whole graph.
+//--------------------------------------------------------------------
+
+struct MstUpdate
+{
+    std::uint32_t u;
+    std::uint32_t v;
+    double w; // new weight; the edge is inserted when absent
+};
+
+struct MstBatchResult
+{
+    std::uint64_t inserted = 0;     // edges that did not exist
+    std::uint64_t tree_changes = 0; // forest edges replaced or added
+};
+
+class DynamicMst
+{
+public:
+    // Graph of edges with parallel entries merged keeping the lightest and
+    // self loops dropped
+    explicit DynamicMst(const MstEdges &edges, unsigned nthreads = 0);
+
+    // Updates apply in order; self loops are ignored. Throws
+    // std::out_of_range for ids >= n().
+    MstBatchResult apply(const std::vector<MstUpdate> &batch);
+
+    std::uint32_t n() const { return static_cast<std::uint32_t>(m_adj.size()); }
+    double weight() const { return m_weight; }
+    std::uint64_t tree_edges() const { return m_tree_edges; }
+
+    // parent[v] in the maintained forest, MST_NO_PARENT for roots (not
+    // necessarily the smallest vertex of their tree)
+    const std::vector<std::uint32_t> &parent() const { return m_parent; }
+    double parent_weight(std::uint32_t v) const { return m_parent_w[v]; }
+
+    // Current graph, every edge once, for a full recompute
+    MstEdges edges() const;
+
+    // Weight of edge (u, v), or a negative value when it does not exist
+    double edge_weight(std::uint32_t u, std::uint32_t v) const;
+
+private:
+    using Adj = std::vector<std::pair<std::uint32_t, double>>; // ascending by vertex
+
+    void update(const MstUpdate &up, MstBatchResult &result);
+    std::uint32_t root_of(std::uint32_t v) const;
+    // Makes x (inside the detached subtree topped by top) its root and
+    // hangs it under y with weight w
+    void hang(std::uint32_t x, std::uint32_t top, std::uint32_t y, double w);
+    void link_trees(std::uint32_t u, std::uint32_t v, double w);
+    void replace_on_cycle(std::uint32_t u, std::uint32_t v, double w, MstBatchResult &result);
+    void repair_cut(std::uint32_t c, MstBatchResult &result);
+    void tree_unlink(std::uint32_t a, std::uint32_t b);
+
+    std::vector<Adj> m_adj;
+    std::vector<std::vector<std::uint32_t>> m_tree; // forest neighbours
+    std::vector<std::uint32_t> m_parent;
+    std::vector<double> m_parent_w;
+    std::vector<std::uint32_t> m_depth;
+    std::vector<std::uint32_t> m_size; // tree size, valid at roots
+    std::vector<std::uint32_t> m_queue;
+    std::vector<std::uint8_t> m_mark;
+    double m_weight = 0.0;
+    std::uint64_t m_tree_edges = 0;
+};
+
+#endif // DYNAMIC_MST_HPP
@@ -0,0 +1,308 @@
+#include "pregel_boruvka.hpp"
+
+#include <algorithm>
+
+#include "../common/parallel.hpp"
+
+namespace
+{
+    enum class Phase
+    {
+        MinEdge,
+        Hook,
+        Resolve,
+        Answer,
+        Jump,
+        Ask,
+        Reply,
+        Relabel,
+    };
+
+    const char *const PHASE_NAMES[] = {"min-edge", "hook", "resolve", "answer", "jump", "ask", "reply", "relabel"};
+
+    // Adjacency entry of a vertex; label is the neighbour's last known one
+    template <typename Index, typename Weight>
+    struct Arc
+    {
+        Index neighbour;
+        Index label;
+        Weight weight;
+        std::uint64_t edge;
+    };
+
+    template <typename Index, typename Weight>
+    struct BoruvkaVertex
+    {
+        std::uint64_t end = 0; // live arcs are [row[v], end)
+        Index label = 0;       // root of the vertex's component
+        Index pointer = 0;     // roots: the root hooked onto, itself if none
+        Weight weight{};       // lightest edge picked by a root
+        std::uint64_t edge = 0;
+        bool busy = false; // hooked root that does not know its final root yet
+    };
+
+    // One layout for every phase: from is the sender, label the
+    // carried label or pointer
+    template <typename Index, typename Weight>
+    struct BoruvkaMessage
+    {
+        Index from;
+        Index label;
+        Weight weight;
+        std::uint64_t edge;
+        bool done;
+    };
+
+    template <typename Index, typename Weight>
+    class BoruvkaProgram
+    {
+    public:
+        using Value = BoruvkaVertex<Index, Weight>;
+        using Message = BoruvkaMessage<Index, Weight>;
+        using Aggregate = std::uint64_t; // senders of the superstep
+
+        BoruvkaProgram(const std::vector<std::uint64_t> &row, std::vector<Arc<Index, Weight>> &arcs, unsigned threads)
+            : m_row(row), m_arcs(arcs), m_forest(threads)
+        {
+        }
+
+        void compute(PregelContext<BoruvkaProgram> &ctx, Value &value, const Message *messages, std::size_t count)
+        {
+            const auto v = static_cast<Index>(ctx.vertex());
+            Arc<Index, Weight> *first = m_arcs.data() + m_row[v];
+            Arc<Index, Weight> *last = m_arcs.data() + value.end;
+            switch (m_phase)
+            {
+            case Phase::MinEdge:
+            {
+                // Arcs stay sorted by neighbour, compaction keeps the order
+                for (std::size_t k = 0; k < count; k++)
+                {
+                    auto it = std::lower_bound(first, last, messages[k].from, [](const Arc<Index, Weight> &a, Index x)
+                                               { return a.neighbour < x; });
+                    if (it != last && it->neighbour == messages[k].from)
+                        it->label = messages[k].label;
+                }
+                last = std::remove_if(first, last, [&](const Arc<Index, Weight> &a)
+                                      { return a.label == value.label; });
+                value.end = static_cast<std::uint64_t>(last - m_arcs.data());
+                if (first == last)
+                    break;
+                const Arc<Index, Weight> *best = first;
+                for (const Arc<Index, Weight> *a = first + 1; a != last; a++)
+                    if (lighter(a->weight, a->edge, best->weight, best->edge))
+                        best = a;
+                ctx.send(value.label, {v, best->label, best->weight, best->edge, false});
+                ctx.aggregate(1);
+                break;
+            }
+            case Phase::Hook:
+                // Only roots receive, one combined message each
+                if (count == 0)
+                    break;
+                value.pointer = messages[0].label;
+                value.weight = messages[0].weight;
+                value.edge = messages[0].edge;
+                value.busy = true;
+                ctx.send(value.pointer, {v, v, Weight{}, 0, false});
+                break;
+            case Phase::Resolve:
+                if (!value.busy)
+                    break;
+                for (std::size_t k = 0; k < count; k++)
+                {
+                    if (messages[k].from == value.pointer && v < value.pointer)
+                    {
+                        value.pointer = v;
+                        value.busy = false;
+                        break;
+                    }
+                }
+                if (!value.busy)
+                    break;
+                m_forest[ctx.thread()].push_back(value.edge);
+                ctx.send(value.pointer, {v, v, Weight{}, 0, false});
+                ctx.aggregate(1);
+                break;
+            case Phase::Answer:
+                for (std::size_t k = 0; k < count; k++)
+                    ctx.send(messages[k].from, {v, value.pointer, Weight{}, 0, !value.busy});
+                break;
+            case Phase::Jump:
+                if (!value.busy || count == 0)
+                    break;
+                value.pointer = messages[0].label;
+                if (messages[0].done)
+                {
+                    value.busy = false;
+                    break;
+                }
+                ctx.send(value.pointer, {v, v, Weight{}, 0, false});
+                ctx.aggregate(1);
+                break;
+            case Phase::Ask:
+                if (first != last)
+                    ctx.send(value.label, {v, v, Weight{}, 0, false});
+                break;
+            case Phase::Reply:
+                for (std::size_t k = 0; k < count; k++)
+                    ctx.send(messages[k].from, {v, value.pointer, Weight{}, 0, false});
+                break;
+            case Phase::Relabel:
+                if (count == 0 || messages[0].label == value.label)
+                    break;
+                value.label = messages[0].label;
+                for (const Arc<Index, Weight> *a = first; a != last; a++)
+                    ctx.send(a->neighbour, {v, value.label, Weight{}, 0, false});
+                break;
+            }
+            if (first == last && !value.busy)
+                ctx.vote_to_halt();
+        }
+
+        bool combining(std::uint32_t) const { return m_phase == Phase::MinEdge; }
+
+        Message combine(const Message &a, const Message &b) const
+        {
+            return lighter(b.weight, b.edge, a.weight, a.edge) ? b : a;
+        }
+
+        Aggregate aggregate(const Aggregate &a, const Aggregate &b) const { return a + b; }
+
+        bool master(std::uint32_t, const Aggregate &total)
+        {
+            switch (m_phase)
+            {
+            case Phase::MinEdge:
+                if (total == 0)
+                    return false;
+                m_rounds++;
+                m_phase = Phase::Hook;
+                break;
+            case Phase::Hook:
+                m_phase = Phase::Resolve;
+                break;
+            case Phase::Resolve:
+            case Phase::Jump:
+                m_phase = total > 0 ? Phase::Answer : Phase::Ask;
+                break;
+            case Phase::Answer:
+                m_phase = Phase::Jump;
+                break;
+            case Phase::Ask:
+                m_phase = Phase::Reply;
+                break;
+            case Phase::Reply:
+                m_phase = Phase::Relabel;
+                break;
+            case Phase::Relabel:
+                m_phase = Phase::MinEdge;
+                break;
+            }
+            return true;
+        }
+
+        const char *phase() const { return PHASE_NAMES[static_cast<int>(m_phase)]; }
+
+        std::uint32_t rounds() const { return m_rounds; }
+        const std::vector<std::vector<std::uint64_t>> &forest() const { return m_forest; }
+
+    private:
+        static bool lighter(Weight wa, std::uint64_t ea, Weight wb, std::uint64_t eb)
+        {
+            return wa < wb || (!(wb < wa) && ea < eb);
+        }
+
+        const std::vector<std::uint64_t> &m_row;
+        std::vector<Arc<Index, Weight>> &m_arcs;
+        std::vector<std::vector<std::uint64_t>> m_forest; // edge ids per thread
+        Phase m_phase = Phase::MinEdge;
+        std::uint32_t m_rounds = 0;
+    };
+}
+
+template <typename Index, typename Weight>
+BasicPregelMst<Index> pregel_boruvka_mst(const BasicMstEdges<Index, Weight> &edges, const PregelOptions &options)
+{
+    const unsigned threads = resolve_threads(options.nthreads);
+    const Index n = edges.n;
+    const std::uint64_t m = edges.u.size();
+    BasicPregelMst<Index> out;
+    if (n == 0)
+        return out;
+
+    // Both directions of every edge, self loops dropped
+    std::vector<std::uint64_t> row(std::uint64_t(n) + 1, 0);
+    parallel_for(threads, m, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                 {
+        for (std::uint64_t k = b; k < e; k++)
+            if (edges.u[k] != edges.v[k])
+            {
+                __atomic_fetch_add(&row[edges.u[k] + 1], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&row[edges.v[k] + 1], 1, __ATOMIC_RELAXED);
+            } });
+    for (Index x = 0; x < n; x++)
+        row[x + 1] += row[x];
+    std::vector<Arc<Index, Weight>> arcs(row[n]);
+    {
+        std::vector<std::uint64_t> cursor(row.begin(), row.end() - 1);
+        parallel_for(threads, m, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                     {
+            for (std::uint64_t k = b; k < e; k++)
+            {
+                const Index x = edges.u[k], y = edges.v[k];
+                if (x == y)
+                    continue;
+                arcs[__atomic_fetch_add(&cursor[x], 1, __ATOMIC_RELAXED)] = {y, y, edges.w[k], k};
+                arcs[__atomic_fetch_add(&cursor[y], 1, __ATOMIC_RELAXED)] = {x, x, edges.w[k], k};
+            } });
+    }
+
+    BoruvkaProgram<Index, Weight> program(row, arcs, threads);
+    PregelEngine<BoruvkaProgram<Index, Weight>> engine(program, n, options);
+    auto &values = engine.values();
+
+    // Rows sorted by neighbour with parallel edges reduced to the lightest,
+    // which is the only one min-edge can pick
+    parallel_for_dynamic(threads, n, 256, [&](std::uint64_t b, std::uint64_t e, unsigned)
+                         {
+        for (std::uint64_t x = b; x < e; x++)
+        {
+            auto first = arcs.begin() + static_cast<std::ptrdiff_t>(row[x]);
+            auto last = arcs.begin() + static_cast<std::ptrdiff_t>(row[x + 1]);
+            std::sort(first, last, [](const Arc<Index, Weight> &a, const Arc<Index, Weight> &c)
+                      {
+                if (a.neighbour != c.neighbour)
+                    return a.neighbour < c.neighbour;
+                return a.weight < c.weight || (!(c.weight < a.weight) && a.edge < c.edge); });
+            last = std::unique(first, last, [](const Arc<Index, Weight> &a, const Arc<Index, Weight> &c)
+                               { return a.neighbour == c.neighbour; });
+            values[x].end = static_cast<std::uint64_t>(last - arcs.begin());
+            values[x].label = static_cast<Index>(x);
+            values[x].pointer = static_cast<Index>(x);
+        } });
+
+    out.supersteps = engine.run();
+
+    std::vector<std::uint64_t> tree;
+    for (const auto &part : program.forest())
+        tree.insert(tree.end(), part.begin(), part.end());
+    for (std::uint64_t e : tree)
+        out.forest.weight += static_cast<double>(edges.w[e]);
+    out.forest.tree_edges = tree.size();
+    out.forest.rounds = program.rounds();
+    out.forest.parent = orient_forest(edges, tree);
+    return out;
+}
+
+#define PREGEL_BORUVKA_INSTANTIATE(Index, Weight) \
+    template BasicPregelMst<Index> pregel_boruvka_mst(const BasicMstEdges<Index, Weight> &, const PregelOptions &);
+
+PREGEL_BORUVKA_INSTANTIATE(std::uint32_t, std::uint16_t)
+PREGEL_BORUVKA_INSTANTIATE(std::uint32_t, std::uint32_t)
+PREGEL_BORUVKA_INSTANTIATE(std::uint32_t, float)
+PREGEL_BORUVKA_INSTANTIATE(std::uint32_t, double)
+PREGEL_BORUVKA_INSTANTIATE(std::uint64_t, std::uint16_t)
+PREGEL_BORUVKA_INSTANTIATE(std::uint64_t, std::uint32_t)
+PREGEL_BORUVKA_INSTANTIATE(std::uint64_t, float)
+PREGEL_BORUVKA_INSTANTIATE(std::uint64_t, double)
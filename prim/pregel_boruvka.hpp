@@ -0,0 +1,49 @@
+#ifndef PREGEL_BORUVKA_HPP
+#define PREGEL_BORUVKA_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/pregel.hpp"
+#include "boruvka.hpp"
+
+//--------------------------------------------------------------------
+// Borůvka minimum spanning forest as a vertex program on the BSP
+// engine of common/pregel.hpp, the formulation Pregel+ runs, for a
+// comparison with the edge-parallel boruvka_mst and the linear-algebra
+// drivers on one machine and the same loaders.
+//
+// Every vertex keeps its deduplicated adjacency with the component
+// label last heard from each neighbour; a component is named by its
+// root vertex. One Borůvka round takes these supersteps:
+//
+//   min-edge  apply neighbour labels, drop arcs inside the component,
+//             send the lightest remaining arc to the root (min combiner)
+//   hook      a root points at the component across its lightest edge
+//   resolve   of two roots that picked each other the smaller stays a
+//             root; every other hooked root records its edge
+//   answer/jump (repeated)  pointer jumping by question and answer
+//             until every hooked root knows its final root
+//   ask/reply vertices ask their old root for the new label
+//   relabel   vertices whose label changed send it to their neighbours
+//
+// Vertices without arcs outside their component vote to halt and are
+// woken only by the messages addressed to them as roots. Ties are
+// broken by edge id as in boruvka_mst, so both pick the same forest.
+//--------------------------------------------------------------------
+
+template <typename Index>
+struct BasicPregelMst
+{
+    BasicMstResult<Index> forest; // rounds: Borůvka rounds
+    std::vector<PregelSuperstep> supersteps;
+};
+
+using PregelMst = BasicPregelMst<std::uint32_t>;
+
+// Instances for the id and weight types of boruvka_mst
+template <typename Index, typename Weight>
+BasicPregelMst<Index> pregel_boruvka_mst(const BasicMstEdges<Index, Weight> &edges,
+                                         const PregelOptions &options = {});
+
+#endif // PREGEL_BORUVKA_HPP
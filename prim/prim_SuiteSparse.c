@@ -2,9 +2,14 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <math.h>
 #include <time.h>
 #include <GraphBLAS.h>
 
+#include "prim_SuiteSparse.h"
+#include "../common/graph_trace.h"
+#include "../common/mem_accounting.h"
+
 #define CHECK(x)                                                                                      \
     do                                                                                                \
     {                                                                                                 \
@@ -16,134 +21,125 @@
         }                                                                                             \
     } while (0)
 
-typedef struct
-{
-    GrB_Index i;
-    GrB_Index j;
-    double value;
-} MMEdge;
-
-static int mmedge_cmp(const void *a, const void *b)
+static double wall_time(void)
 {
-    const MMEdge *A = (const MMEdge *)a;
-    const MMEdge *B = (const MMEdge *)b;
-    if (A->i < B->i)
-        return -1;
-    if (A->i > B->i)
-        return 1;
-    if (A->j < B->j)
-        return -1;
-    if (A->j > B->j)
-        return 1;
-    return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
 }
 
-GrB_Info load_dimacs_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_edges)
+/* Строит A одним GrB_Matrix_build из первых limit элементов строк [0, rows)
+ * кэша, отбрасывая столбцы вне A. Столбцы и веса берутся прямо из mmap,
+ * копируются только если что-то пришлось отбросить. Повторы сливает dup. */
+static GrB_Info build_from_cache(GrB_Matrix A, const GraphCache *cache, GrB_Index rows, GrB_Index limit,
+                                 GrB_BinaryOp dup, GrB_Index *loaded)
 {
-    FILE *f = fopen(path, "r");
-    if (f == NULL)
-    {
-        fprintf(stderr, "load_dimacs_lim: cannot open file %s\n", path);
-        return GrB_INVALID_VALUE;
-    }
+    GrB_Index ncols;
+    GrB_Info info = GrB_Matrix_ncols(&ncols, A);
+    if (info != GrB_SUCCESS)
+        return info;
 
-    char line[1024];
-    GrB_Index num_nodes = 0, num_edges = 0;
-    GrB_Index edge_counter = 0;
-    GrB_Index max_node_id = 0;
-    GrB_Index capacity = 16;
-    MMEdge *edges = malloc(capacity * sizeof(MMEdge));
-    if (edges == NULL)
+    GrB_Index end = cache->row_ptr[rows];
+    if (end > limit)
+        end = limit;
+
+    GrB_Index keep = 0;
+    for (GrB_Index k = 0; k < end; k++)
+        keep += (cache->col_idx[k] < ncols);
+    bool compact = (keep != end);
+
+    GrB_Index *I = malloc((keep > 0 ? keep : 1) * sizeof(GrB_Index));
+    GrB_Index *J = compact ? malloc((keep > 0 ? keep : 1) * sizeof(GrB_Index)) : NULL;
+    double *X = (compact && cache->weights) ? malloc((keep > 0 ? keep : 1) * sizeof(double)) : NULL;
+    if (I == NULL || (compact && J == NULL) || (compact && cache->weights && X == NULL))
     {
-        fclose(f);
+        free(I);
+        free(J);
+        free(X);
         return GrB_OUT_OF_MEMORY;
     }
 
-    while (fgets(line, sizeof(line), f) != NULL && edge_counter < max_edges)
+    GrB_Index pos = 0;
+    for (GrB_Index u = 0; u < rows; u++)
     {
-        if (line[0] == '\n' || line[0] == 'c')
-            continue;
-
-        if (line[0] == 'p')
+        for (GrB_Index k = cache->row_ptr[u]; k < cache->row_ptr[u + 1] && k < end; k++)
         {
-            char sp[32];
-            if (sscanf(line, "p %s %llu %llu", sp, &num_nodes, &num_edges) != 3)
+            if (cache->col_idx[k] >= ncols)
+                continue;
+            I[pos] = u;
+            if (compact)
             {
-                free(edges);
-                fclose(f);
-                return GrB_INVALID_VALUE;
+                J[pos] = cache->col_idx[k];
+                if (X)
+                    X[pos] = cache->weights[k];
             }
-            fprintf(stderr, "Original graph: %llu nodes, %llu edges\n",
-                    (unsigned long long)num_nodes, (unsigned long long)num_edges);
-            continue;
+            pos++;
         }
+    }
 
-        if (line[0] == 'a' && edge_counter < max_edges)
-        {
-            GrB_Index u, v;
-            double w;
-            if (sscanf(line, "a %llu %llu %lf", &u, &v, &w) != 3)
-            {
-                free(edges);
-                fclose(f);
-                return GrB_INVALID_VALUE;
-            }
-
-            u--;
-            v--;
-
-            max_node_id = (u > max_node_id) ? u : max_node_id;
-            max_node_id = (v > max_node_id) ? v : max_node_id;
+    const GrB_Index *Jb = compact ? J : cache->col_idx;
+    if (cache->weights)
+    {
+        TRACE_CALL("GrB_Matrix_build", info = GrB_Matrix_build_FP64(A, I, Jb, compact ? X : cache->weights, keep, dup));
+    }
+    else
+    {
+        GrB_Scalar one = NULL;
+        info = GrB_Scalar_new(&one, GrB_FP64);
+        if (info == GrB_SUCCESS)
+            info = GrB_Scalar_setElement_FP64(one, 1.0);
+        if (info == GrB_SUCCESS)
+            TRACE_CALL("GxB_Matrix_build_Scalar", info = GxB_Matrix_build_Scalar(A, I, Jb, one, keep));
+        GrB_Scalar_free(&one);
+    }
+    if (info == GrB_SUCCESS)
+        TRACE_CALL("GrB_Matrix_wait", info = GrB_Matrix_wait(A, GrB_MATERIALIZE));
+
+    free(I);
+    free(J);
+    free(X);
+    *loaded = keep;
+    return info;
+}
 
-            if (edge_counter >= capacity)
-            {
-                capacity *= 2;
-                MMEdge *tmp = realloc(edges, capacity * sizeof(MMEdge));
-                if (tmp == NULL)
-                {
-                    free(edges);
-                    fclose(f);
-                    return GrB_OUT_OF_MEMORY;
-                }
-                edges = tmp;
-            }
+GrB_Info build_dimacs_lim(const GraphCache *cache, GrB_Index max_edges, GrB_BinaryOp dup,
+                          GrB_Matrix *out_matrix, GrB_Vector *out_parents)
+{
+    fprintf(stderr, "Original graph: %llu nodes, %llu edges\n",
+            (unsigned long long)cache->header.n, (unsigned long long)cache->header.nnz);
 
-            edges[edge_counter].i = u;
-            edges[edge_counter].j = v;
-            edges[edge_counter].value = w;
-            edge_counter++;
+    /* Берём первые max_edges дуг в порядке (u, v) */
+    GrB_Index edge_counter = (cache->header.nnz < max_edges) ? cache->header.nnz : max_edges;
+    GrB_Index max_node_id = 0;
+    GrB_Index rows_used = 0;
+    while (rows_used < cache->header.n && cache->row_ptr[rows_used] < edge_counter)
+    {
+        GrB_Index end = cache->row_ptr[rows_used + 1];
+        if (end > edge_counter)
+            end = edge_counter;
+        for (GrB_Index k = cache->row_ptr[rows_used]; k < end; k++)
+        {
+            max_node_id = (rows_used > max_node_id) ? rows_used : max_node_id;
+            max_node_id = (cache->col_idx[k] > max_node_id) ? cache->col_idx[k] : max_node_id;
         }
+        rows_used++;
     }
 
-    fclose(f);
-
     GrB_Index matrix_size = max_node_id + 1;
     fprintf(stderr, "Loaded graph: %llu nodes, %llu edges\n",
             (unsigned long long)matrix_size, (unsigned long long)edge_counter);
 
-    /* Сортируем рёбра */
-    if (edge_counter > 1)
-    {
-        qsort(edges, edge_counter, sizeof(MMEdge), mmedge_cmp);
-    }
-
     GrB_Matrix A = NULL;
     GrB_Info info = GrB_Matrix_new(&A, GrB_FP64, matrix_size, matrix_size);
     if (info != GrB_SUCCESS)
-    {
-        free(edges);
         return info;
-    }
 
-    for (GrB_Index k = 0; k < edge_counter; k++)
+    GrB_Index loaded = 0;
+    info = build_from_cache(A, cache, rows_used, edge_counter, dup, &loaded);
+    if (info != GrB_SUCCESS)
     {
-        info = GrB_Matrix_setElement_FP64(A, edges[k].value, edges[k].i, edges[k].j);
-        if (info != GrB_SUCCESS)
-        {
-            GrB_Matrix_free(&A);
-            free(edges);
-            return info;
-        }
+        GrB_Matrix_free(&A);
+        return info;
     }
 
     GrB_Vector parents = NULL;
@@ -151,138 +147,41 @@ GrB_Info load_dimacs_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *o
     if (info != GrB_SUCCESS)
     {
         GrB_Matrix_free(&A);
-        free(edges);
         return info;
     }
 
-    free(edges);
-
     *out_matrix = A;
     *out_parents = parents;
-
     return GrB_SUCCESS;
 }
 
-GrB_Info load_matrix_mm_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_nodes)
+GrB_Info build_matrix_mm_lim(const GraphCache *cache, GrB_Index max_nodes, GrB_BinaryOp dup,
+                             GrB_Matrix *out_matrix, GrB_Vector *out_parents)
 {
-    FILE *f = fopen(path, "r");
-    if (f == NULL)
-    {
-        fprintf(stderr, "load_matrix_mm_lim: cannot open file %s\n", path);
-        return GrB_INVALID_VALUE;
-    }
-
-    char line[1024];
-    bool header_found = false;
-
-    while (fgets(line, sizeof(line), f) != NULL)
-    {
-        if (strncmp(line, "%%MatrixMarket", 14) == 0)
-        {
-            header_found = true;
-            continue;
-        }
-        if (line[0] == '%' || line[0] == '\n' || line[0] == '\r')
-        {
-            continue;
-        }
-        break;
-    }
-
-    if (!header_found)
-    {
-        fprintf(stderr, "load_matrix_mm_lim: not a MatrixMarket file (missing header)\n");
-        fclose(f);
-        return GrB_INVALID_VALUE;
-    }
-
-    GrB_Index nrows = 0, ncols = 0;
-    unsigned long long nnz_ull = 0;
-    if (sscanf(line, "%llu %llu %llu", &nrows, &ncols, &nnz_ull) != 3)
+    if (cache->header.flags & GRAPH_CACHE_DIMACS)
     {
-        fprintf(stderr, "load_matrix_mm_lim: failed to parse dimensions line: %s\n", line);
-        fclose(f);
+        fprintf(stderr, "build_matrix_mm_lim: not a MatrixMarket file (missing header)\n");
         return GrB_INVALID_VALUE;
     }
 
-    GrB_Index nnz = (GrB_Index)nnz_ull;
-    MMEdge *edges = NULL;
-    GrB_Index capacity = (nnz > 0) ? nnz : 16;
-    edges = malloc(capacity * sizeof(MMEdge));
-    if (edges == NULL)
-    {
-        fprintf(stderr, "load_matrix_mm_lim: malloc failed\n");
-        fclose(f);
-        return GrB_OUT_OF_MEMORY;
-    }
-
-    unsigned long long ii = 0, jj = 0;
-    double val = 0.0;
-    GrB_Index count = 0;
-    while (fscanf(f, "%llu %llu %lf", &ii, &jj, &val) == 3)
-    {
-        if (ii == 0 || jj == 0)
-        {
-            continue;
-        }
-
-        GrB_Index ri = (GrB_Index)(ii - 1);
-        GrB_Index cj = (GrB_Index)(jj - 1);
-
-        if (count >= capacity)
-        {
-            GrB_Index newcap = capacity * 2;
-            MMEdge *tmp = realloc(edges, newcap * sizeof(MMEdge));
-            if (tmp == NULL)
-            {
-                free(edges);
-                fclose(f);
-                fprintf(stderr, "load_matrix_mm_lim: realloc failed\n");
-                return GrB_OUT_OF_MEMORY;
-            }
-            edges = tmp;
-            capacity = newcap;
-        }
-
-        edges[count].i = ri;
-        edges[count].j = cj;
-        edges[count].value = val;
-        count++;
-    }
-
-    fclose(f);
-
-    if (count > 1)
-    {
-        qsort(edges, count, sizeof(MMEdge), mmedge_cmp);
-    }
-
-    GrB_Index maxdim = (nrows > ncols) ? nrows : ncols;
+    GrB_Index maxdim = cache->header.n;
     GrB_Index matrix_size = (max_nodes > 0) ? ((max_nodes < maxdim) ? max_nodes : maxdim) : maxdim;
 
     GrB_Matrix A = NULL;
     GrB_Info info = GrB_Matrix_new(&A, GrB_FP64, matrix_size, matrix_size);
     if (info != GrB_SUCCESS)
     {
-        free(edges);
-        fprintf(stderr, "load_matrix_mm_lim: GrB_Matrix_new failed (%d)\n", (int)info);
+        fprintf(stderr, "build_matrix_mm_lim: GrB_Matrix_new failed (%d)\n", (int)info);
         return info;
     }
 
     GrB_Index loaded = 0;
-    for (GrB_Index k = 0; k < count; k++)
+    info = build_from_cache(A, cache, matrix_size, cache->header.nnz, dup, &loaded);
+    if (info != GrB_SUCCESS)
     {
-        if (edges[k].i >= matrix_size || edges[k].j >= matrix_size)
-            continue;
-        info = GrB_Matrix_setElement_FP64(A, edges[k].value, edges[k].i, edges[k].j);
-        if (info != GrB_SUCCESS)
-        {
-            GrB_Matrix_free(&A);
-            free(edges);
-            fprintf(stderr, "load_matrix_mm_lim: GrB_Matrix_setElement_FP64 failed (%d)\n", (int)info);
-            return info;
-        }
-        loaded++;
+        GrB_Matrix_free(&A);
+        fprintf(stderr, "build_matrix_mm_lim: GrB_Matrix_build failed (%d)\n", (int)info);
+        return info;
     }
 
     GrB_Vector parents = NULL;
@@ -290,26 +189,67 @@ GrB_Info load_matrix_mm_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector
     if (info != GrB_SUCCESS)
     {
         GrB_Matrix_free(&A);
-        free(edges);
-        fprintf(stderr, "load_matrix_mm_lim: GrB_Vector_new failed (%d)\n", (int)info);
+        fprintf(stderr, "build_matrix_mm_lim: GrB_Vector_new failed (%d)\n", (int)info);
         return info;
     }
 
-    free(edges);
-
     *out_matrix = A;
     *out_parents = parents;
 
-    fprintf(stderr, "load_matrix_mm_lim: read edges=%llu, loaded=%llu, matrix_size=%llu\n",
-            (unsigned long long)count, (unsigned long long)loaded, (unsigned long long)matrix_size);
-
+    fprintf(stderr, "build_matrix_mm_lim: read edges=%llu, loaded=%llu, matrix_size=%llu\n",
+            (unsigned long long)cache->header.nnz, (unsigned long long)loaded, (unsigned long long)matrix_size);
     return GrB_SUCCESS;
 }
 
+GrB_Info load_dimacs_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_edges,
+                         GrB_BinaryOp dup)
+{
+    double t0 = wall_time();
+    GraphCache cache;
+    if (graph_cache_load(path, &cache) != 0)
+    {
+        fprintf(stderr, "load_dimacs_lim: cannot open file %s\n", path);
+        return GrB_INVALID_VALUE;
+    }
+    double t1 = wall_time();
+
+    GrB_Info info = build_dimacs_lim(&cache, max_edges, dup, out_matrix, out_parents);
+    double t2 = wall_time();
+    graph_cache_close(&cache);
+
+    if (info == GrB_SUCCESS)
+        fprintf(stderr, "load_dimacs_lim: load %.6f s, build %.6f s\n", t1 - t0, t2 - t1);
+    return info;
+}
+
+GrB_Info load_matrix_mm_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_nodes,
+                            GrB_BinaryOp dup)
+{
+    double t0 = wall_time();
+    GraphCache cache;
+    if (graph_cache_load(path, &cache) != 0)
+    {
+        fprintf(stderr, "load_matrix_mm_lim: cannot open file %s\n", path);
+        return GrB_INVALID_VALUE;
+    }
+    double t1 = wall_time();
+
+    GrB_Info info = build_matrix_mm_lim(&cache, max_nodes, dup, out_matrix, out_parents);
+    double t2 = wall_time();
+    graph_cache_close(&cache);
+
+    if (info == GrB_SUCCESS)
+        fprintf(stderr, "load_matrix_mm_lim: load %.6f s, build %.6f s\n", t1 - t0, t2 - t1);
+    return info;
+}
+
+/* Элемент A(i, j) и фронта d: вес ребра, его конец в дереве (index = j)
+ * и сама вершина (vertex = i), чтобы argmin считался одним reduce */
 typedef struct
 {
     GrB_Index index;
     double weight;
+    GrB_Index vertex;
 } MSTType;
 
 void mst_first(void *z, const void *x, const void *y)
@@ -319,20 +259,15 @@ void mst_first(void *z, const void *x, const void *y)
     *result = *first;
 }
 
-void mst_weight(void *z, const void *x)
-{
-    double *result = (double *)z;
-    const MSTType *val = (const MSTType *)x;
-    *result = val->weight;
-}
-
+/* Минимум по весу, при равенстве — по номеру вершины, чтобы результат
+ * не зависел от порядка редукции */
 void mst_min(void *z, const void *x, const void *y)
 {
     MSTType *result = (MSTType *)z;
     const MSTType *lhs = (const MSTType *)x;
     const MSTType *rhs = (const MSTType *)y;
 
-    if (rhs->weight > lhs->weight)
+    if (lhs->weight < rhs->weight || (lhs->weight == rhs->weight && lhs->vertex <= rhs->vertex))
     {
         *result = *lhs;
     }
@@ -341,38 +276,6 @@ void mst_min(void *z, const void *x, const void *y)
         *result = *rhs;
     }
 }
-GrB_Index argmin_vector(GrB_Vector v)
-{
-    GrB_Index nvals;
-    CHECK(GrB_Vector_nvals(&nvals, v));
-
-    if (nvals == 0)
-    {
-        fprintf(stderr, "Empty vector in argmin\n");
-        exit(1);
-    }
-
-    GrB_Index *indices = malloc(nvals * sizeof(GrB_Index));
-    double *values = malloc(nvals * sizeof(double));
-    GrB_Index n = nvals;
-    CHECK(GrB_Vector_extractTuples_FP64(indices, values, &n, v));
-
-    GrB_Index idx_min = indices[0];
-    double val_min = values[0];
-
-    for (GrB_Index i = 1; i < nvals; i++)
-    {
-        if (values[i] < val_min)
-        {
-            val_min = values[i];
-            idx_min = indices[i];
-        }
-    }
-
-    free(indices);
-    free(values);
-    return idx_min;
-}
 
 double mst_prim(GrB_Matrix graph, GrB_Vector mst_parents)
 {
@@ -389,12 +292,13 @@ double mst_prim(GrB_Matrix graph, GrB_Vector mst_parents)
     GrB_Type MSTType_type;
     CHECK(GrB_Type_new(&MSTType_type, sizeof(MSTType)));
 
-    GrB_UnaryOp weight_op;
-    CHECK(GrB_UnaryOp_new(&weight_op, mst_weight, GrB_FP64, MSTType_type));
-
     GrB_BinaryOp MST_min;
     CHECK(GrB_BinaryOp_new(&MST_min, mst_min, MSTType_type, MSTType_type, MSTType_type));
 
+    MSTType identity = {.index = 0, .weight = INFINITY, .vertex = UINT64_MAX};
+    GrB_Monoid MST_min_monoid;
+    CHECK(GrB_Monoid_new_UDT(&MST_min_monoid, MST_min, &identity));
+
     GrB_Matrix A;
     CHECK(GrB_Matrix_new(&A, MSTType_type, rows, cols));
 
@@ -411,7 +315,7 @@ double mst_prim(GrB_Matrix graph, GrB_Vector mst_parents)
         exit(1);
     }
 
-    CHECK(GrB_Matrix_extractTuples_FP64(i, j, vals, &nvals, graph));
+    TRACE_CALL("GrB_Matrix_extractTuples", CHECK(GrB_Matrix_extractTuples_FP64(i, j, vals, &nvals, graph)));
 
     MSTType *new_vals = malloc(nvals * sizeof(MSTType));
     if (!new_vals)
@@ -421,90 +325,102 @@ double mst_prim(GrB_Matrix graph, GrB_Vector mst_parents)
     }
     for (GrB_Index ix = 0; ix < nvals; ix++)
     {
-        new_vals[ix].index = i[ix];
+        new_vals[ix].index = j[ix];
         new_vals[ix].weight = vals[ix];
+        new_vals[ix].vertex = i[ix];
     }
 
     GrB_BinaryOp MST_first;
     CHECK(GrB_BinaryOp_new(&MST_first, mst_first, MSTType_type, MSTType_type, MSTType_type));
-    CHECK(GrB_Matrix_build(A, i, j, (void *)new_vals, nvals, MST_first));
+    TRACE_CALL("GrB_Matrix_build", CHECK(GrB_Matrix_build(A, i, j, (void *)new_vals, nvals, MST_first)));
+
+    free(i);
+    free(j);
+    free(vals);
+    free(new_vals);
 
     double total_weight = 0.0;
 
+    /* Все рабочие объекты создаются до цикла. mask плотный (false/true),
+     * поэтому setElement в цикле меняет значение на месте */
     GrB_Vector mask;
     CHECK(GrB_Vector_new(&mask, GrB_BOOL, rows));
+    CHECK(GrB_Vector_assign_BOOL(mask, NULL, NULL, false, GrB_ALL, rows, NULL));
+
+    GrB_Vector d;
+    CHECK(GrB_Vector_new(&d, MSTType_type, rows));
+
+    GrB_Vector new_edges;
+    CHECK(GrB_Vector_new(&new_edges, MSTType_type, rows));
 
     CHECK(GrB_Vector_clear(mst_parents));
 
     GrB_Index start = 0;
     CHECK(GrB_Vector_setElement_BOOL(mask, true, start));
 
-    GrB_Vector d;
-    CHECK(GrB_Vector_new(&d, MSTType_type, rows));
-
-    GrB_Vector weights;
-    CHECK(GrB_Vector_new(&weights, GrB_FP64, rows));
-
-    CHECK(GrB_Col_extract(d, NULL, NULL, A, GrB_ALL, rows, start, NULL));
+    /* d хранит только непосещённые вершины */
+    TRACE_CALL("GrB_Col_extract", CHECK(GrB_Col_extract(d, mask, NULL, A, GrB_ALL, rows, start, GrB_DESC_RC)));
 
     GrB_Index visited_count = 1;
+    GrB_Index root = start;
     while (visited_count < rows)
     {
-        CHECK(GrB_Vector_clear(weights));
-        CHECK(GrB_Vector_apply(weights, mask, NULL, weight_op, d, GrB_DESC_RC));
-
-        GrB_Index nvals_weights;
-        CHECK(GrB_Vector_nvals(&nvals_weights, weights));
-        if (nvals_weights == 0)
-            break;
-
-        GrB_Index u = argmin_vector(weights);
+        GrB_Index nvals_d;
+        TRACE_CALL("GrB_Vector_nvals", CHECK(GrB_Vector_nvals(&nvals_d, d)));
+        if (nvals_d == 0)
+        {
+            /* Компонента исчерпана: следующее дерево растёт из первой
+             * непосещённой вершины, так что получается остовный лес */
+            bool seen = true;
+            while (seen && ++root < rows)
+                CHECK(GrB_Vector_extractElement_BOOL(&seen, mask, root));
+            if (root >= rows)
+                break;
+            TRACE_CALL("GrB_Vector_setElement", CHECK(GrB_Vector_setElement_BOOL(mask, true, root)));
+            visited_count++;
+            TRACE_CALL("GrB_Col_extract", CHECK(GrB_Col_extract(d, mask, NULL, A, GrB_ALL, rows, root, GrB_DESC_RC)));
+            continue;
+        }
 
         MSTType edge_info;
-        CHECK(GrB_Vector_extractElement_UDT(&edge_info, d, u));
+        TRACE_CALL("GrB_Vector_reduce (argmin)", CHECK(GrB_Vector_reduce_UDT(&edge_info, NULL, MST_min_monoid, d, NULL)));
+        GrB_Index u = edge_info.vertex;
 
         // Добавляем вес в общую сумму
         total_weight += edge_info.weight;
 
-        CHECK(GrB_Vector_setElement_UINT64(mst_parents, edge_info.index, u));
+        TRACE_CALL("GrB_Vector_setElement", CHECK(GrB_Vector_setElement_UINT64(mst_parents, edge_info.index, u)));
 
-        CHECK(GrB_Vector_setElement_BOOL(mask, true, u));
+        TRACE_CALL("GrB_Vector_setElement", CHECK(GrB_Vector_setElement_BOOL(mask, true, u)));
         visited_count++;
 
-        GrB_Vector new_edges;
-        CHECK(GrB_Vector_new(&new_edges, MSTType_type, rows));
-        CHECK(GrB_Col_extract(new_edges, NULL, NULL, A, GrB_ALL, rows, u, NULL));
-
-        CHECK(GrB_eWiseAdd(d, mask, NULL, MST_min, d, new_edges, GrB_DESC_R));
-
-        CHECK(GrB_Vector_free(&new_edges));
+        TRACE_CALL("GrB_Col_extract", CHECK(GrB_Col_extract(new_edges, NULL, NULL, A, GrB_ALL, rows, u, NULL)));
+        TRACE_CALL("GrB_eWiseAdd", CHECK(GrB_eWiseAdd(d, mask, NULL, MST_min, d, new_edges, GrB_DESC_RC)));
     }
 
-    free(i);
-    free(j);
-    free(vals);
-    free(new_vals);
-
     CHECK(GrB_Matrix_free(&A));
     CHECK(GrB_Vector_free(&mask));
     CHECK(GrB_Vector_free(&d));
-    CHECK(GrB_Vector_free(&weights));
+    CHECK(GrB_Vector_free(&new_edges));
+    CHECK(GrB_Monoid_free(&MST_min_monoid));
     CHECK(GrB_Type_free(&MSTType_type));
     CHECK(GrB_BinaryOp_free(&MST_first));
     CHECK(GrB_BinaryOp_free(&MST_min));
-    CHECK(GrB_UnaryOp_free(&weight_op));
 
     return total_weight;
 }
 
+#ifndef GRAPH_BENCH_DRIVER
 int main(int argc, char **argv)
 {
-    CHECK(GrB_init(GrB_NONBLOCKING));
+    CHECK(GxB_init(GrB_NONBLOCKING, graph_mem_malloc, graph_mem_calloc, graph_mem_realloc, graph_mem_free));
     printf("=== Пример алгоритма Прима с использованием GraphBLAS ===\n");
     const GrB_Index n = 3;
     GrB_Matrix graph = NULL;
     GrB_Vector mst_parents = NULL;
 
+    GraphMemPhase mem;
+    graph_mem_phase_begin(&mem);
     if (argc < 2)
     {
         CHECK(GrB_Matrix_new(&graph, GrB_FP64, n, n));
@@ -517,22 +433,34 @@ int main(int argc, char **argv)
     }
     else if (argc > 2 && strcmp(argv[1], "--dimacs") == 0)
     {
-        CHECK(load_dimacs_lim(argv[2], &graph, &mst_parents, 50000));
+        GrB_Index max_edges = (argc > 3) ? strtoull(argv[3], NULL, 10) : 50000;
+        CHECK(load_dimacs_lim(argv[2], &graph, &mst_parents, max_edges, GrB_MIN_FP64));
     }
     else
     {
-        CHECK(load_matrix_mm_lim(argv[1], &graph, &mst_parents, 50000));
+        GrB_Index max_nodes = (argc > 2) ? strtoull(argv[2], NULL, 10) : 50000;
+        CHECK(load_matrix_mm_lim(argv[1], &graph, &mst_parents, max_nodes, GrB_MIN_FP64));
     }
 
+    graph_mem_phase_end(&mem);
+    graph_mem_print(stderr, "memory load+build", &mem);
+
     printf("\n--- Запуск алгоритма Прима ---\n");
+    graph_mem_phase_begin(&mem);
+    double t_start = wall_time();
     double total_weight = mst_prim(graph, mst_parents);
+    double t_end = wall_time();
+    graph_mem_phase_end(&mem);
+    graph_mem_print(stderr, "memory convert+compute", &mem);
 
     printf("\n=== Результаты ===\n");
     printf("Общий вес минимального остовного дерева: %.2f\n", total_weight);
+    printf("Время выполнения: %.6f секунд\n", t_end - t_start);
 
     CHECK(GrB_Matrix_free(&graph));
     CHECK(GrB_Vector_free(&mst_parents));
     CHECK(GrB_finalize());
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
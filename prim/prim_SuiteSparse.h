@@ -0,0 +1,36 @@
+#ifndef PRIM_SUITESPARSE_H
+#define PRIM_SUITESPARSE_H
+
+#include <GraphBLAS.h>
+
+#include "../common/graph_cache.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Build an FP64 adjacency matrix and an empty parent vector from a loaded
+     * cache: the first max_edges arcs (DIMACS) or the leading max_nodes x
+     * max_nodes block (MatrixMarket, 0 = whole graph). Duplicates merge with dup. */
+    GrB_Info build_dimacs_lim(const GraphCache *cache, GrB_Index max_edges, GrB_BinaryOp dup,
+                              GrB_Matrix *out_matrix, GrB_Vector *out_parents);
+    GrB_Info build_matrix_mm_lim(const GraphCache *cache, GrB_Index max_nodes, GrB_BinaryOp dup,
+                                 GrB_Matrix *out_matrix, GrB_Vector *out_parents);
+
+    /* graph_cache_load + build_*_lim, printing the load and build times */
+    GrB_Info load_dimacs_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_edges,
+                             GrB_BinaryOp dup);
+    GrB_Info load_matrix_mm_lim(const char *path, GrB_Matrix *out_matrix, GrB_Vector *out_parents, GrB_Index max_nodes,
+                                GrB_BinaryOp dup);
+
+    /* Prim's minimum spanning forest of graph, one tree per component grown
+     * from its smallest vertex; fills mst_parents (roots stay empty) and
+     * returns the total weight */
+    double mst_prim(GrB_Matrix graph, GrB_Vector mst_parents);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIM_SUITESPARSE_H */
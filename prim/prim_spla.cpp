@@ -1,169 +1,196 @@
-#include <fstream>
-#include <set>
 #include <spla.hpp>
 #include <vector>
 #include <chrono>
 #include <filesystem>
-#include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "prim_spla.hpp"
+#include "../common/spla_build.hpp"
+#include "../common/graph_types.hpp"
+#include "../common/indexed_heap.hpp"
+#include "../common/bitset.hpp"
+#include "../common/graph_trace.h"
 
 static int n = 0;
 static int edges_count = 0;
-static unsigned int weight = 0;
+static double weight = 0;
 static int el_cnt = 0;
+static bool float_weights = false; // a holds FLOAT values, else UINT
 
 static std::vector<unsigned int> buffer1;
 static std::vector<unsigned int> buffer2;
 static spla::ref_ptr<spla::Matrix> a;
 static spla::ref_ptr<spla::Vector> mst;
 
-static const unsigned int INF = 1e9;
-static spla::ref_ptr<spla::Scalar> zero_uint = spla::Scalar::make_uint(0);
-static spla::ref_ptr<spla::Scalar> inf_uint = spla::Scalar::make_uint(INF);
+// SPLA values are 32-bit: integer weights (u16, u32 from graph_types_scan)
+// are staged as unsigned int, the others as float, so double weights are
+// rounded. The largest value of the type marks a missing edge.
+template <typename Weight>
+using SplaWeight = std::conditional_t<std::is_integral_v<Weight>, unsigned int, float>;
 
-struct Edge
+template <typename Weight>
+struct SplaOps;
+
+template <>
+struct SplaOps<unsigned int>
 {
-    int u;
-    int v;
-    int w;
+    static spla::ref_ptr<spla::Type> type() { return spla::UINT; }
+    static spla::ref_ptr<spla::Scalar> scalar(unsigned int x) { return spla::Scalar::make_uint(x); }
+    static void set(const spla::ref_ptr<spla::Vector> &v, unsigned int i, unsigned int x) { v->set_uint(i, x); }
+    static unsigned int value(const spla::ref_ptr<spla::Scalar> &s) { return s->as_uint(); }
+    static spla::ref_ptr<spla::OpUnary> identity() { return spla::IDENTITY_UINT; }
+    static spla::ref_ptr<spla::OpBinary> min() { return spla::MIN_UINT; }
+    static spla::ref_ptr<spla::OpBinary> second() { return spla::SECOND_UINT; }
+    static spla::ref_ptr<spla::OpSelect> nqzero() { return spla::NQZERO_UINT; }
 };
 
-void buildMatrixFromDIMACS_lim(const std::string &filename, int max_edges)
+template <>
+struct SplaOps<float>
+{
+    static spla::ref_ptr<spla::Type> type() { return spla::FLOAT; }
+    static spla::ref_ptr<spla::Scalar> scalar(float x) { return spla::Scalar::make_float(x); }
+    static void set(const spla::ref_ptr<spla::Vector> &v, unsigned int i, float x) { v->set_float(i, x); }
+    static float value(const spla::ref_ptr<spla::Scalar> &s) { return s->as_float(); }
+    static spla::ref_ptr<spla::OpUnary> identity() { return spla::IDENTITY_FLOAT; }
+    static spla::ref_ptr<spla::OpBinary> min() { return spla::MIN_FLOAT; }
+    static spla::ref_ptr<spla::OpBinary> second() { return spla::SECOND_FLOAT; }
+    static spla::ref_ptr<spla::OpSelect> nqzero() { return spla::NQZERO_FLOAT; }
+};
+
+// Calls f with a value of the SPLA weight type chosen for the cache
+template <typename F>
+static void dispatch_weight(const GraphCache &cache, F &&f)
 {
-    std::ifstream fin(filename);
-    if (!fin.is_open())
+    const GraphTypeInfo info = graph_types_scan(cache);
+    if (info.narrowest.index != IndexType::U32)
     {
-        throw std::runtime_error("Не удалось открыть файл: " + filename);
+        throw std::runtime_error("SPLA keys are 32-bit: graph has " + std::to_string(info.vertices) + " vertices");
     }
+    graph_types_dispatch_weight(info.narrowest.weight, [&](auto w)
+                                { f(SplaWeight<decltype(w)>{}); });
+}
 
-    std::string line;
-    int numNodes = 0, numEdges = 0;
-
-    int max_node_id = 0;
+void build_graph_dimacs(const GraphCache &cache, int max_edges)
+{
+    std::cout << "Original graph: " << cache.header.n << " nodes, " << cache.header.nnz << " edges\n";
 
-    std::vector<Edge> edges;
+    n = max_edges;
+    edges_count = max_edges;
+    el_cnt = 0;
 
-    while (std::getline(fin, line) && el_cnt < max_edges)
-    {
-        if (line.empty() || line[0] == 'c')
-            continue;
+    int max_node_id = 0;
+    dispatch_weight(cache, [&](auto w)
+                    {
+        using Weight = decltype(w);
+        float_weights = std::is_same_v<Weight, float>;
+        a = spla::Matrix::make(max_edges, max_edges, SplaOps<Weight>::type());
 
-        std::istringstream iss(line);
-        char type;
-        iss >> type;
+        auto coo = coo_from_cache<Weight>(cache, cache.header.n, max_edges, max_edges, false, true, 1);
+        build_matrix(a, coo);
+        el_cnt += static_cast<int>(coo.rows.size());
 
-        if (type == 'p')
-        {
-            std::string sp;
-            iss >> sp >> numNodes >> numEdges;
-            std::cout << "Original graph: " << numNodes << " nodes, " << numEdges << " edges\n";
-        }
-        else if (type == 'a')
-        {
-            int u, v;
-            int w;
-            iss >> u >> v >> w;
+        for (std::size_t k = 0; k < coo.rows.size(); k++)
+            max_node_id = std::max(max_node_id, static_cast<int>(std::max(coo.rows[k], coo.cols[k]))); });
 
-            u -= 1;
-            v -= 1;
+    std::cout << "Loaded graph: " << max_node_id << " nodes, " << el_cnt << " edges\n";
+}
 
-            max_node_id = std::max(max_node_id, std::max(u, v));
-            edges.push_back({u, v, w});
-            el_cnt += 1;
-        }
-    }
+void build_graph_mm(const GraphCache &cache, int n_loc)
+{
+    n = n_loc;
+    edges_count = n_loc;
+    el_cnt = 0;
 
-    fin.close();
-    n = max_edges;
-    edges_count = max_edges;
+    dispatch_weight(cache, [&](auto w)
+                    {
+        using Weight = decltype(w);
+        float_weights = std::is_same_v<Weight, float>;
+        a = spla::Matrix::make(n_loc, n_loc, SplaOps<Weight>::type());
+        auto coo = coo_from_cache<Weight>(cache, n_loc, n_loc, cache.header.nnz, false, true, 1);
+        build_matrix(a, coo);
+        el_cnt += static_cast<int>(coo.rows.size()); });
 
-    a = spla::Matrix::make(max_edges, max_edges, spla::UINT);
+    std::cout << "loaded elements: " << el_cnt << "\n";
+}
 
-    for (const auto &e : edges)
+void buildMatrixFromDIMACS_lim(const std::string &filename, int max_edges)
+{
+    GraphCache cache;
+    if (graph_cache_load(filename.c_str(), &cache) != 0)
     {
-        a->set_uint(e.u, e.v, e.w);
+        throw std::runtime_error("Не удалось открыть файл: " + filename);
     }
-    std::cout << "Loaded graph: " << max_node_id << " nodes, " << el_cnt << " edges\n";
+    build_graph_dimacs(cache, max_edges);
+    graph_cache_close(&cache);
 }
 
 void load_graph_mm(const std::string &path, int n_loc)
 {
-    std::ifstream fin(path);
-    if (!fin.is_open())
+    GraphCache cache;
+    if (graph_cache_load(path.c_str(), &cache) != 0)
     {
         throw std::runtime_error("Cannot open file: " + path);
     }
+    build_graph_mm(cache, n_loc);
+    graph_cache_close(&cache);
+}
 
-    std::vector<Edge> edges;
-    std::string line;
-
-    while (std::getline(fin, line))
-    {
-        if (line.empty() || line[0] == '%')
-            continue;
-
-        std::istringstream iss(line);
-        Edge e{};
-        if (!(iss >> e.u >> e.v >> e.w))
-            continue;
-        if (e.u > 0 && e.v > 0)
-            e.u--, e.v--;
-
-        edges.push_back(e);
-    }
-
-    fin.close();
-    n = n_loc;
-    edges_count = n_loc;
-    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b)
-              {
-        if (a.u == b.u)
-            return a.v < b.v;
-        return a.u < b.u; });
-
-    a = spla::Matrix::make(n_loc, n_loc, spla::UINT);
-    for (const auto &e : edges)
-    {
-        if (e.u < n_loc && e.v < n_loc)
-        {
-            a->set_uint(e.u, e.v, e.w);
-            el_cnt += 1;
-        }
-    }
-    std::cout << "loaded elements: " << el_cnt << "\n";
+double mst_weight()
+{
+    return weight;
 }
 
-void update(std::set<std::pair<unsigned int, unsigned int>> &s, const spla::ref_ptr<spla::Vector> &v)
+static IndexedDaryHeap<unsigned int>::Stats heap_stats;
+static std::uint64_t relaxations = 0;
+
+template <typename Weight>
+void update(IndexedDaryHeap<Weight> &s, const DenseBitset &visited, const spla::ref_ptr<spla::Vector> &v)
 {
     auto sz = spla::Scalar::make_uint(0);
-    spla::exec_v_count_mf(sz, v);
+    TRACE_CALL("spla::exec_v_count_mf", spla::exec_v_count_mf(sz, v));
     auto keys_view = spla::MemView::make(buffer1.data(), sz->as_uint(), false);
     auto values_view = spla::MemView::make(buffer2.data(), sz->as_uint(), false);
-    v->read(keys_view, values_view);
+    TRACE_CALL("spla::Vector::read", v->read(keys_view, values_view));
     auto keys = (unsigned int *)keys_view->get_buffer();
-    auto values = (unsigned int *)values_view->get_buffer();
-    for (unsigned int i = 0; i < sz->as_uint(); i++)
+    auto values = (Weight *)values_view->get_buffer();
     {
-        s.insert({values[i], keys[i]});
+        TRACE_SCOPE("prim_spla frontier update");
+        for (unsigned int i = 0; i < sz->as_uint(); i++)
+        {
+            if (!visited.test(keys[i]))
+                s.push_or_decrease(keys[i], values[i]);
+        }
     }
+    relaxations += sz->as_uint();
+    TRACE_COUNT("prim_spla relaxations", sz->as_uint());
 }
 
 using clock_ = std::chrono::steady_clock;
 
-void compute_internal()
+template <typename Weight>
+static void compute_typed()
 {
-    mst = spla::Vector::make(n, spla::UINT);
+    using Ops = SplaOps<Weight>;
+    const Weight inf = std::numeric_limits<Weight>::max();
+    auto zero = Ops::scalar(0);
+    auto inf_scalar = Ops::scalar(inf);
+
+    mst = spla::Vector::make(n, Ops::type());
 
-    auto d = spla::Vector::make(n, spla::UINT);
-    auto changed = spla::Vector::make(n, spla::UINT);
-    auto v_row = spla::Vector::make(n, spla::UINT);
-    auto min_v = spla::Scalar::make_uint(INF);
+    auto d = spla::Vector::make(n, Ops::type());
+    auto changed = spla::Vector::make(n, Ops::type());
+    auto v_row = spla::Vector::make(n, Ops::type());
+    auto min_v = Ops::scalar(inf);
 
-    changed->set_fill_value(zero_uint);
-    mst->set_fill_value(inf_uint);
-    d->set_fill_value(inf_uint);
-    v_row->set_fill_value(inf_uint);
+    changed->set_fill_value(zero);
+    mst->set_fill_value(inf_scalar);
+    d->set_fill_value(inf_scalar);
+    v_row->set_fill_value(inf_scalar);
 
     weight = 0;
     if (n <= 1 || edges_count == 0)
@@ -171,65 +198,87 @@ void compute_internal()
         return;
     }
 
-    std::set<std::pair<unsigned int, unsigned int>> s;
-    std::vector<bool> visited(n, false);
+    IndexedDaryHeap<Weight> s(n);
+    DenseBitset visited(n);
+    relaxations = 0;
 
     for (int i = 0; i < n; i++)
     {
-        if (!visited[i])
+        if (!visited.test(i))
         {
             unsigned int v = i;
-            d->set_uint(v, 0);
-            visited[v] = true;
-            spla::exec_m_extract_row(v_row, a, v, spla::IDENTITY_UINT);
-            spla::exec_v_eadd_fdb(d, v_row, changed, spla::MIN_UINT);
-            spla::exec_v_assign_masked(mst, changed, spla::Scalar::make_uint(v), spla::SECOND_UINT,
-                                       spla::NQZERO_UINT);
-
-            update(s, changed);
+            TRACE_CALL("spla::Vector::set", Ops::set(d, v, 0));
+            visited.set(v);
+            TRACE_CALL("spla::exec_m_extract_row", spla::exec_m_extract_row(v_row, a, v, Ops::identity()));
+            TRACE_CALL("spla::exec_v_eadd_fdb", spla::exec_v_eadd_fdb(d, v_row, changed, Ops::min()));
+            TRACE_CALL("spla::exec_v_assign_masked",
+                       spla::exec_v_assign_masked(mst, changed, Ops::scalar(static_cast<Weight>(v)), Ops::second(),
+                                                  Ops::nqzero()));
+
+            TRACE_CALL("prim_spla update", update(s, visited, changed));
             while (!s.empty())
             {
-                unsigned int w = s.begin()->first;
-                v = s.begin()->second;
-                s.erase(s.begin());
-                if (visited[v])
-                    continue;
+                auto [w, next] = s.pop();
+                v = next;
 
                 weight += w;
-                d->set_uint(v, 0);
-                visited[v] = true;
-                spla::exec_m_extract_row(v_row, a, v, spla::IDENTITY_UINT);
-                spla::exec_v_eadd_fdb(d, v_row, changed, spla::MIN_UINT);
-                spla::exec_v_assign_masked(mst, changed, spla::Scalar::make_uint(v),
-                                           spla::SECOND_UINT,
-                                           spla::NQZERO_UINT);
-
-                update(s, changed);
+                TRACE_CALL("spla::Vector::set", Ops::set(d, v, 0));
+                visited.set(v);
+                TRACE_CALL("spla::exec_m_extract_row", spla::exec_m_extract_row(v_row, a, v, Ops::identity()));
+                TRACE_CALL("spla::exec_v_eadd_fdb", spla::exec_v_eadd_fdb(d, v_row, changed, Ops::min()));
+                TRACE_CALL("spla::exec_v_assign_masked",
+                           spla::exec_v_assign_masked(mst, changed, Ops::scalar(static_cast<Weight>(v)),
+                                                      Ops::second(),
+                                                      Ops::nqzero()));
+
+                TRACE_CALL("prim_spla update", update(s, visited, changed));
             }
         }
     }
+    const auto &stats = s.stats();
+    heap_stats = {stats.pushes, stats.decreases, stats.ignored, stats.pops};
 }
 
-std::chrono::seconds compute()
+void compute_internal()
+{
+    if (float_weights)
+        compute_typed<float>();
+    else
+        compute_typed<unsigned int>();
+}
+
+std::chrono::nanoseconds compute()
 {
     auto start = clock_::now();
     compute_internal();
     auto end = clock_::now();
-    return std::chrono::duration_cast<std::chrono::seconds>(end - start);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
 }
 
-int main()
+#ifndef GRAPH_BENCH_DRIVER
+int main(int argc, char **argv)
 {
     try
     {
-        std::filesystem::path graph_path = "/Users/nikitalukonenko/Studying/third_course/experiment/sources/gbtl/datasets/internet_2/internet.mtx";
-        load_graph_mm(graph_path, 50000);
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << argv[0] << " <graph.mtx> [max_vertices]\n";
+            return 1;
+        }
+        std::filesystem::path graph_path = argv[1];
+        int max_vertices = argc > 2 ? std::stoi(argv[2]) : 50000;
+        load_graph_mm(graph_path, max_vertices);
         auto execution_time = compute();
         std::cout << "Algorithm execution time: "
-                  << execution_time.count()
+                  << std::chrono::duration<double>(execution_time).count()
                   << " seconds\n";
 
         std::cout << "MST weight: " << weight << "\n";
+        std::cout << "Frontier: relaxations " << relaxations
+                  << ", inserts " << heap_stats.pushes
+                  << ", decrease-keys " << heap_stats.decreases
+                  << ", ignored " << heap_stats.ignored
+                  << ", pops " << heap_stats.pops << "\n";
     }
     catch (const std::exception &e)
     {
@@ -238,4 +287,5 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,25 @@
+#ifndef PRIM_SPLA_HPP
+#define PRIM_SPLA_HPP
+
+#include <chrono>
+#include <string>
+
+#include "../common/graph_cache.h"
+
+// Prim's MST on SPLA. The graph and the result live in this module's
+// globals; build_* replaces the previous graph. Weights are staged as
+// UINT or FLOAT after graph_types_scan (double weights are rounded to
+// float); graphs with 64-bit vertex ids are rejected.
+
+void build_graph_mm(const GraphCache &cache, int n_loc);
+void build_graph_dimacs(const GraphCache &cache, int max_edges);
+
+void load_graph_mm(const std::string &path, int n_loc);
+void buildMatrixFromDIMACS_lim(const std::string &filename, int max_edges);
+
+void compute_internal();
+std::chrono::nanoseconds compute();
+
+double mst_weight();
+
+#endif // PRIM_SPLA_HPP
@@ -0,0 +1,287 @@
+#include "streaming_mst.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../common/parallel.hpp"
+
+namespace
+{
+    constexpr std::size_t READ_BYTES = 8 << 20;      // text buffer
+    constexpr std::uint64_t MIN_BLOCK_EDGES = 1 << 16; // smaller blocks only add merge passes
+
+    struct Edge
+    {
+        std::uint32_t u;
+        std::uint32_t v;
+        double w;
+    };
+
+    bool lighter(const Edge &a, const Edge &b)
+    {
+        return a.w < b.w;
+    }
+
+    inline const char *skip_blanks(const char *p, const char *end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    // Union by rank with path halving; reset before every merge
+    class DisjointSets
+    {
+    public:
+        explicit DisjointSets(std::uint32_t n) : m_parent(n), m_rank(n) {}
+
+        std::uint64_t bytes() const { return m_parent.size() * (sizeof(std::uint32_t) + sizeof(std::uint8_t)); }
+
+        void reset()
+        {
+            for (std::uint32_t i = 0; i < m_parent.size(); i++)
+                m_parent[i] = i;
+            std::fill(m_rank.begin(), m_rank.end(), 0);
+        }
+
+        bool unite(std::uint32_t a, std::uint32_t b)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return false;
+            if (m_rank[a] < m_rank[b])
+                std::swap(a, b);
+            m_parent[b] = a;
+            if (m_rank[a] == m_rank[b])
+                m_rank[a]++;
+            return true;
+        }
+
+    private:
+        std::uint32_t find(std::uint32_t x)
+        {
+            while (m_parent[x] != x)
+            {
+                m_parent[x] = m_parent[m_parent[x]];
+                x = m_parent[x];
+            }
+            return x;
+        }
+
+        std::vector<std::uint32_t> m_parent;
+        std::vector<std::uint8_t> m_rank;
+    };
+
+    // The block is reserved once at its final capacity, so that a full
+    // block never doubles past the budget
+    class StreamState
+    {
+    public:
+        StreamState(std::uint32_t n, std::uint64_t block_edges, unsigned nthreads)
+            : m_sets(n), m_threads(nthreads)
+        {
+            m_forest.reserve(n);
+            m_next.reserve(n);
+            m_block.reserve(block_edges);
+        }
+
+        // Returns false when the block is full and has to be merged first
+        bool push(const Edge &e)
+        {
+            m_block.push_back(e);
+            return m_block.size() < m_block.capacity();
+        }
+
+        // Kruskal over the forest and the block: the block is sorted as one
+        // run per thread and all runs are consumed in weight order
+        void merge()
+        {
+            const std::uint64_t count = m_block.size();
+            const unsigned runs = static_cast<unsigned>(
+                std::max<std::uint64_t>(1, std::min<std::uint64_t>(m_threads, count / MIN_BLOCK_EDGES)));
+            std::vector<std::pair<const Edge *, const Edge *>> heads(runs + 1);
+            parallel_for(runs, count, [&](std::uint64_t b, std::uint64_t e, unsigned t)
+                         {
+                std::sort(m_block.begin() + b, m_block.begin() + e, lighter);
+                heads[t] = {m_block.data() + b, m_block.data() + e}; });
+            heads[runs] = {m_forest.data(), m_forest.data() + m_forest.size()};
+
+            m_sets.reset();
+            m_next.clear();
+            for (;;)
+            {
+                std::size_t best = heads.size();
+                for (std::size_t r = 0; r < heads.size(); r++)
+                    if (heads[r].first != heads[r].second &&
+                        (best == heads.size() || heads[r].first->w < heads[best].first->w))
+                        best = r;
+                if (best == heads.size())
+                    break;
+                const Edge &e = *heads[best].first++;
+                if (m_sets.unite(e.u, e.v))
+                    m_next.push_back(e);
+            }
+            m_peak_edges = std::max<std::uint64_t>(m_peak_edges, m_forest.size() + m_next.size() + m_block.size());
+            m_forest.swap(m_next);
+            m_block.clear();
+            m_blocks++;
+        }
+
+        bool pending() const { return !m_block.empty(); }
+        const std::vector<Edge> &forest() const { return m_forest; }
+        std::uint64_t blocks() const { return m_blocks; }
+        // Union-find and the most edges held at once (forest, next forest and
+        // block, during a merge)
+        std::uint64_t peak_bytes() const { return m_sets.bytes() + m_peak_edges * sizeof(Edge); }
+
+    private:
+        std::vector<Edge> m_forest; // ascending weight
+        std::vector<Edge> m_next;
+        std::vector<Edge> m_block;
+        DisjointSets m_sets;
+        unsigned m_threads;
+        std::uint64_t m_blocks = 0;
+        std::uint64_t m_peak_edges = 0;
+    };
+
+    struct FileCloser
+    {
+        void operator()(std::FILE *f) const { std::fclose(f); }
+    };
+}
+
+StreamingMstResult streaming_mst(const std::string &path, const StreamingMstOptions &options)
+{
+    std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "rb"));
+    if (!file)
+        throw std::runtime_error("streaming_mst: cannot open " + path);
+
+    StreamingMstResult result;
+    std::vector<char> buffer(READ_BYTES);
+    std::unique_ptr<StreamState> state;
+    std::uint64_t n = 0;
+
+    // The header gives n and the entry count; everything before it is
+    // banner or comments
+    auto start_stream = [&](std::uint64_t vertices, std::uint64_t entries)
+    {
+        n = options.max_vertices > 0 ? std::min(vertices, options.max_vertices) : vertices;
+        if (n > MST_NO_PARENT)
+            throw std::runtime_error("streaming_mst: more than 2^32 - 1 vertices");
+        const std::uint64_t fixed = READ_BYTES + n * (2 * sizeof(Edge) + sizeof(std::uint32_t) + 1);
+        if (options.memory_budget < fixed + MIN_BLOCK_EDGES * sizeof(Edge))
+            throw std::runtime_error("streaming_mst: memory budget of " + std::to_string(options.memory_budget) +
+                                     " bytes does not cover the " + std::to_string(fixed) +
+                                     " bytes of vertex state and a minimal block");
+        result.block_edges = (options.memory_budget - fixed) / sizeof(Edge);
+        // A file smaller than the budget is one block of its own size
+        if (entries > 0)
+            result.block_edges = std::min(result.block_edges, entries);
+        state = std::make_unique<StreamState>(static_cast<std::uint32_t>(n), result.block_edges,
+                                              resolve_threads(options.nthreads));
+    };
+
+    auto parse_line = [&](const char *q, const char *eol)
+    {
+        q = skip_blanks(q, eol);
+        if (q == eol || *q == '\r' || *q == '%' || *q == 'c')
+            return;
+        if (!state)
+        {
+            std::uint64_t rows = 0, cols = 0, entries = 0;
+            if (*q == 'p')
+            {
+                // p <problem> <nodes> <arcs>
+                q = skip_blanks(q + 1, eol);
+                while (q < eol && *q != ' ' && *q != '\t')
+                    q++;
+                auto r = std::from_chars(skip_blanks(q, eol), eol, rows);
+                std::from_chars(skip_blanks(r.ptr, eol), eol, entries);
+            }
+            else
+            {
+                // MatrixMarket size line: rows cols nnz
+                auto r = std::from_chars(q, eol, rows);
+                r = std::from_chars(skip_blanks(r.ptr, eol), eol, cols);
+                std::from_chars(skip_blanks(r.ptr, eol), eol, entries);
+            }
+            start_stream(std::max(rows, cols), entries);
+            return;
+        }
+        if (*q == 'p')
+            return;
+        if (*q == 'a')
+            q = skip_blanks(q + 1, eol);
+
+        std::uint64_t u = 0, v = 0;
+        auto r = std::from_chars(q, eol, u);
+        if (r.ec != std::errc())
+            return;
+        r = std::from_chars(skip_blanks(r.ptr, eol), eol, v);
+        if (r.ec != std::errc())
+            return;
+        double w = 1.0;
+        if (std::from_chars(skip_blanks(r.ptr, eol), eol, w).ec != std::errc())
+            w = 1.0;
+        if (u == 0 || v == 0 || u == v || u > n || v > n)
+            return;
+
+        result.edges_read++;
+        if (!state->push({static_cast<std::uint32_t>(u - 1), static_cast<std::uint32_t>(v - 1), w}))
+            state->merge();
+    };
+
+    // Complete lines are parsed in place, the partial last line moves to
+    // the front of the buffer
+    std::size_t carry = 0;
+    for (;;)
+    {
+        std::size_t got = std::fread(buffer.data() + carry, 1, buffer.size() - carry, file.get());
+        result.bytes_read += got;
+        const char *p = buffer.data();
+        const char *end = p + carry + got;
+        const bool last = got == 0;
+        while (p < end)
+        {
+            auto eol = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            if (!eol)
+            {
+                if (!last)
+                    break;
+                eol = end;
+            }
+            parse_line(p, eol);
+            p = eol < end ? eol + 1 : end;
+        }
+        carry = static_cast<std::size_t>(end - p);
+        if (last)
+            break;
+        if (carry == buffer.size())
+            throw std::runtime_error("streaming_mst: line longer than the read buffer in " + path);
+        std::memmove(buffer.data(), p, carry);
+    }
+    if (std::ferror(file.get()))
+        throw std::runtime_error("streaming_mst: read error in " + path);
+    if (!state)
+        throw std::runtime_error("streaming_mst: no size or \"p\" line in " + path);
+    if (state->pending())
+        state->merge();
+
+    result.blocks = state->blocks();
+    result.peak_bytes = std::min<std::uint64_t>(READ_BYTES, result.bytes_read) + state->peak_bytes();
+    result.forest.n = static_cast<std::uint32_t>(n);
+    for (const Edge &e : state->forest())
+    {
+        result.forest.u.push_back(e.u);
+        result.forest.v.push_back(e.v);
+        result.forest.w.push_back(e.w);
+        result.weight += e.w;
+    }
+    return result;
+}
@@ -0,0 +1,52 @@
+#ifndef STREAMING_MST_HPP
+#define STREAMING_MST_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "boruvka.hpp"
+
+//--------------------------------------------------------------------
+// Semi-streaming minimum spanning forest of an edge file that does not
+// fit in memory.
+//
+// The MatrixMarket / DIMACS text is read sequentially through a fixed
+// buffer and parsed into blocks of edges. Only the current forest (at
+// most n - 1 edges) and a union-find over the vertices stay resident;
+// every full block is sorted by weight (one run per thread) and merged
+// with the forest, which is already in weight order, by Kruskal. By the
+// cycle rule no edge dropped from forest ∪ block can be in the spanning
+// forest of the whole graph, so the forest after the last block is the
+// minimum spanning forest.
+//
+// The block size follows from the memory budget after the O(n) state
+// (two forest arrays, the union-find and the read buffer) is taken off,
+// so the peak stays within the budget for any number of edges. It is
+// capped at the entry count of the header, so a small file does not
+// reserve the whole budget.
+//--------------------------------------------------------------------
+
+struct StreamingMstOptions
+{
+    std::uint64_t memory_budget = std::uint64_t(1) << 30; // bytes for the forest, a block and the read buffer
+    std::uint64_t max_vertices = 0;                      // keep vertices [0, max_vertices), 0 = all
+    unsigned nthreads = 0;                               // block sort threads
+};
+
+struct StreamingMstResult
+{
+    MstEdges forest; // forest edges in ascending weight order
+    double weight = 0.0;
+    std::uint64_t edges_read = 0;  // entries kept after the vertex cap, self loops excluded
+    std::uint64_t bytes_read = 0;
+    std::uint64_t blocks = 0;
+    std::uint64_t block_edges = 0; // block capacity derived from the budget and the header
+    std::uint64_t peak_bytes = 0;  // most bytes in use: read buffer, union-find and edges held during a merge
+};
+
+// Throws std::runtime_error when the file cannot be read, has no size or
+// "p" line, or the budget does not cover the O(n) state plus a minimal
+// block
+StreamingMstResult streaming_mst(const std::string &path, const StreamingMstOptions &options = {});
+
+#endif // STREAMING_MST_HPP